@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+
+# Copyright 2022 ETH Zurich and University of Bologna.
+# Solderpad Hardware License, Version 0.51, see LICENSE for details.
+# SPDX-License-Identifier: SHL-0.51
+
+# This script benchmarks the Halide applications with a matrix of schedules.
+# Each schedule is compiled with HALIDE_DEFINES, simulated with
+# `make benchmark`, and the pipeline section of the traces is tabulated.
+#
+# The load latencies are averaged over all the cores. Latencies above the
+# zero-load latency of the interconnect are caused by bank conflicts.
+
+import os
+import argparse
+import itertools
+import pathlib
+import subprocess
+
+import pandas as pd
+
+MEMPOOL_DIR = pathlib.Path(__file__).resolve().parents[2]
+HALIDE_DIR = MEMPOOL_DIR / 'software/apps/halide'
+HARDWARE_DIR = MEMPOOL_DIR / 'hardware'
+
+# Problem size of each application
+SIZES = {
+    '2d_convolution': {'M': 128, 'N': 128},
+    'gradient': {'WIDTH': 256, 'HEIGHT': 256},
+    'matmul': {'matrix_M': 64, 'matrix_N': 64, 'matrix_P': 64},
+}
+
+# Trace section of the Halide pipeline, every mempool_start_benchmark and
+# mempool_stop_benchmark starts a new section
+SECTIONS = {
+    '2d_convolution': 5,
+    'gradient': 1,
+    'matmul': 3,
+}
+
+VECTORS = [2, 4]
+GRAINS = [1, 2, 4]
+TILES = {
+    '2d_convolution': [(16, 8), (32, 8), (32, 16)],
+    'gradient': [(16, 8), (32, 8), (32, 16)],
+    'matmul': [(8, 8), (16, 8), (16, 16)],
+}
+
+METRICS = ['cycles',
+           'total_ipc',
+           'snitch_avg_load_latency',
+           'stall_lsu',
+           'seq_latency_local',
+           'itl_latency_local',
+           'itl_latency_global']
+
+
+def schedules(app: str):
+    """Return the schedules of an application as (name, defines) tuples"""
+    # Schedule 0 is the default of the application
+    configs = [('default', {'SCHEDULE': 0})]
+    if app == '2d_convolution':
+        configs.append(('breadth_first', {'SCHEDULE': 1}))
+        strips, tiles = 2, 3
+    else:
+        strips, tiles = 1, 2
+    for grain, vector in itertools.product(GRAINS, VECTORS):
+        configs.append(('strips_g%d_v%d' % (grain, vector),
+                        {'SCHEDULE': strips, 'GRAIN': grain,
+                         'VECTOR': vector}))
+    for (tile_x, tile_y), vector in itertools.product(TILES[app], VECTORS):
+        configs.append(('tiles_%dx%d_v%d' % (tile_x, tile_y, vector),
+                        {'SCHEDULE': tiles, 'TILE_X': tile_x,
+                         'TILE_Y': tile_y, 'VECTOR': vector}))
+    return configs
+
+
+def run(cmd: list, dry_run: bool, env: dict = None):
+    print(' '.join(cmd))
+    if not dry_run:
+        subprocess.run(cmd, check=True, env=env)
+
+
+def benchmark(app: str, name: str, defines: dict, result_dir: pathlib.Path,
+              dry_run: bool):
+    defines = {**SIZES[app], **defines}
+    halide_defines = ' '.join('-D%s=%d' % (k, v) for k, v in defines.items())
+    # Rebuild the pipeline and the application
+    run(['make', '-C', str(HALIDE_DIR), 'clean'], dry_run)
+    run(['make', '-C', str(HALIDE_DIR), 'HALIDE_DEFINES=' + halide_defines,
+         app], dry_run)
+    # Simulate and trace
+    env = dict(os.environ, result_dir=str(result_dir / app / name),
+               buildpath='build_halide_%s' % app)
+    run(['make', '-C', str(HARDWARE_DIR), 'benchmark',
+         'app=apps/halide/%s' % app], dry_run, env)
+
+
+def create_dataframe(app: str, directory: pathlib.Path):
+    """Tabulate the pipeline section of all the schedules of an app"""
+    df = pd.DataFrame(columns=METRICS)
+    for name, _ in schedules(app):
+        filename = directory / app / name / 'results.csv'
+        if not filename.exists():
+            continue
+        csvread = pd.read_csv(filename)
+        section = csvread.loc[csvread['section'] == SECTIONS[app]]
+        row = section[METRICS].fillna(0).mean()
+        # The slowest core determines the runtime
+        row['cycles'] = section['cycles'].max()
+        df.loc[name] = row
+    return df
+
+
+def main():
+
+    # Parse arguments
+    parser = argparse.ArgumentParser(
+        description='Benchmark the Halide applications with a matrix of '
+                    'schedules')
+    parser.add_argument(
+        "-a",
+        "--apps",
+        nargs='+',
+        choices=list(SIZES.keys()),
+        default=list(SIZES.keys()),
+        help='Applications to benchmark'
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        type=pathlib.Path,
+        default=HARDWARE_DIR / 'results/halide',
+        required=False,
+        help='Path to the results'
+    )
+    parser.add_argument(
+        "-t",
+        "--table",
+        action='store_true',
+        help='Only tabulate the existing results'
+    )
+    parser.add_argument(
+        "-n",
+        "--dry-run",
+        action='store_true',
+        help='Print the commands without running them'
+    )
+
+    args = parser.parse_args()
+    output = args.output.absolute()
+    for app in args.apps:
+        if not args.table:
+            for name, defines in schedules(app):
+                benchmark(app, name, defines, output, args.dry_run)
+        if args.dry_run:
+            continue
+        df = create_dataframe(app, output)
+        print('\n%s\n' % app)
+        print(df.to_string(float_format='%.3f'))
+        df.to_csv(output / ('%s.csv' % app))
+
+
+if __name__ == "__main__":
+    main()
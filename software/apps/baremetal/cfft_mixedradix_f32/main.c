@@ -0,0 +1,102 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Mempool runtime libraries */
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_cfft_mixedradix_f32.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_mixedradix_cfft_f32p.h"
+
+/*
+======================
+Parameters and defines
+
+SCHEDULED: When defined runs multiple parallel FFTs, else runs a single FFT.
+N_FFTs_ROW: When the FFT is scheduled defines the number of FFTs run
+sequentially by each core.
+N_FFTs_COL: When the FFT is scheduled defines the number of FFTs run in parallel
+by groups of cores.
+NUM_PE: Number of cores used for each column of FFTs (power of two).
+*/
+
+#define N_FFTs_ROW (1)
+#define N_FFTs_COL (1)
+#define NUM_PE (NUM_CORES / N_FFTs_COL)
+
+float l1_pSrc[2 * N_FFTs_ROW * N_FFTs_COL * N_CSAMPLES]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+float l1_pDst[2 * N_FFTs_ROW * N_FFTs_COL * N_CSAMPLES]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+float l1_twiddleCoef_f32[2 * N_TWIDDLES]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+uint32_t l1_Radix[N_STAGES]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint16_t l1_DigitRevIndexTable[N_CSAMPLES]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end;
+  mempool_barrier_init(core_id);
+
+  /* INITIALIZATION */
+
+  if (core_id == 0) {
+    for (uint32_t i = 0; i < N_FFTs_ROW * N_FFTs_COL; i++) {
+      dma_memcpy_blocking(l1_pSrc + i * 2 * N_CSAMPLES, l2_pSrc,
+                          2 * N_CSAMPLES * sizeof(float));
+    }
+    dma_memcpy_blocking(l1_twiddleCoef_f32, l2_twiddleCoef_f32,
+                        2 * N_TWIDDLES * sizeof(float));
+    dma_memcpy_blocking(l1_Radix, l2_Radix, N_STAGES * sizeof(uint32_t));
+    dma_memcpy_blocking(l1_DigitRevIndexTable, l2_DigitRevIndexTable,
+                        N_CSAMPLES * sizeof(uint16_t));
+    printf("01: END INITIALIZATION\n");
+  }
+  mempool_barrier(num_cores);
+
+  /* COMPUTATION */
+
+  time_init = 0;
+  time_end = 0;
+  if (core_id < N_FFTs_COL * NUM_PE) {
+    time_init = mempool_get_timer();
+    mempool_start_benchmark();
+#ifdef SCHEDULED
+    mempool_mixedradix_cfft_f32p_scheduler(
+        l1_pSrc, l1_pDst, N_CSAMPLES, N_FFTs_ROW, N_FFTs_COL,
+        l1_twiddleCoef_f32, l1_Radix, N_STAGES, l1_DigitRevIndexTable, NUM_PE);
+#else
+    mempool_mixedradix_cfft_f32p(l1_pSrc, l1_pDst, N_CSAMPLES,
+                                 l1_twiddleCoef_f32, l1_Radix, N_STAGES,
+                                 l1_DigitRevIndexTable, NUM_PE);
+#endif
+    mempool_stop_benchmark();
+    time_end = mempool_get_timer();
+  }
+  mempool_barrier(num_cores);
+
+  if (core_id == 0) {
+    printf("02: END COMPUTATION\n");
+    printf("\nKernel execution takes %d clock cycles\n", time_end - time_init);
+  }
+
+  mempool_check_f32(l1_pDst, l2_pRes, 2 * N_CSAMPLES, (float)TOLERANCE, 0);
+  mempool_barrier(num_cores);
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright 2021 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_cholesky_blocked_f16.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_cholesky_f16p.h"
+#include "baremetal/mempool_linearsolver_f16p.h"
+
+/*
+======================
+Parameters and defines
+
+PARALLEL: When defined runs the blocked parallel Cholesky decomposition. The
+decomposition runs in place, so that matrices up to 256x256 fit in L1.
+LINSOLVER: When defined also solves L L^H x = y with the decomposition.
+NUM_PE: Number of cores used by the kernels (power of two).
+*/
+
+#define PARALLEL
+#define LINSOLVER
+#define NUM_PE (NUM_CORES)
+
+__fp16 l1_L[2 * matrix_N * matrix_N]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+__fp16 l1_y[2 * matrix_N]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_x[2 * matrix_N]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end;
+  mempool_barrier_init(core_id); // Initialize barrier and synchronize
+
+  /* Initialize matrices */
+  if (core_id == 0) {
+    dma_memcpy_blocking(l1_L, l2_GIn, 2 * matrix_N * matrix_N * sizeof(__fp16));
+    dma_memcpy_blocking(l1_y, l2_y, 2 * matrix_N * sizeof(__fp16));
+  }
+  // Wait at barrier until everyone is ready
+  mempool_barrier(num_cores);
+
+#ifdef PARALLEL
+  /* Benchmark */
+  time_init = 0;
+  time_end = 0;
+  if (core_id < NUM_PE) {
+    time_init = mempool_get_timer();
+    mempool_start_benchmark();
+    mempool_cholesky_f16vecp(l1_L, l1_L, matrix_N, NUM_PE);
+#ifdef LINSOLVER
+    mempool_Ltrisol_f16p(l1_L, l1_y, l1_x, matrix_N, 0, NUM_PE);
+    mempool_Ltrisol_f16p(l1_L, l1_x, l1_x, matrix_N, 1, NUM_PE);
+#endif
+    mempool_stop_benchmark();
+    time_end = mempool_get_timer();
+  }
+  mempool_barrier(num_cores);
+
+  // A complex Cholesky decomposition takes about 4n^3/3 real operations, each
+  // complex triangular solve about 4n^2
+  if (core_id == 0) {
+    uint32_t clock_cycles = (time_end - time_init);
+    uint32_t ops = (4 * matrix_N * matrix_N * matrix_N) / 3;
+#ifdef LINSOLVER
+    ops += 2 * 4 * matrix_N * matrix_N;
+#endif
+    printf("\nKernel execution takes %d clock cycles\n", clock_cycles);
+    printf("%d OPs, %d OPs per 1000 cycles\n", ops,
+           (ops / clock_cycles) * 1000 + ((ops % clock_cycles) * 1000) /
+                                             clock_cycles);
+  }
+#endif
+
+  mempool_check_f16(l1_L, l2_LOut, 2 * matrix_N * matrix_N, 0.05f, 0);
+#ifdef LINSOLVER
+  mempool_check_f16(l1_x, l2_x, 2 * matrix_N, 0.05f, 0);
+#endif
+  mempool_barrier(num_cores);
+  return 0;
+}
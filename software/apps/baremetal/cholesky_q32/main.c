@@ -94,10 +94,21 @@ int main() {
 #if defined(PARALLEL)
   // TEST #3 PARALLEL CHOLESKY DECOMPOSITION
   // No trivial parallelization of linearsolver kernels
+  uint32_t time_init = mempool_get_timer();
   mempool_start_benchmark();
   mempool_cholesky_q32p(l1_A, l1_L, matrix_N);
   mempool_stop_benchmark();
+  uint32_t time_end = mempool_get_timer();
   mempool_barrier(num_cores);
+  // A real Cholesky decomposition takes about n^3/3 operations
+  if (core_id == 0) {
+    uint32_t clock_cycles = (time_end - time_init);
+    uint32_t ops = (matrix_N * matrix_N * matrix_N) / 3;
+    printf("\nKernel execution takes %d clock cycles\n", clock_cycles);
+    printf("%d OPs, %d OPs per 1000 cycles\n", ops,
+           (ops / clock_cycles) * 1000 + ((ops % clock_cycles) * 1000) /
+                                             clock_cycles);
+  }
 #endif
 
 #if defined(SCHEDULING)
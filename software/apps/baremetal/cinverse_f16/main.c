@@ -0,0 +1,123 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <math.h>
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_cinverse_f16.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_cinverse_f16p.h"
+
+/*
+======================
+Parameters and defines
+
+Batched inversion of N_ITR Hermitian matrices G of N_TX x N_TX, and batched
+solution of G * X = B with N_RHS right-hand sides. Each core solves the
+problems folded in its local banks.
+
+INVERSE: When defined benchmark the batched inverse.
+SOLVE: When defined benchmark the batched multi-RHS solution.
+*/
+
+#define INVERSE
+#define SOLVE
+
+#define N_WIDTH (N_TX + N_RHS)
+#define N_ROW_INV ((N_ITR + CFOLD_F16_NCOL(N_TX) - 1) / CFOLD_F16_NCOL(N_TX))
+#define N_ROW_SOL                                                              \
+  ((N_ITR + CFOLD_F16_NCOL(N_WIDTH) - 1) / CFOLD_F16_NCOL(N_WIDTH))
+
+#if (N_TX % BANKING_FACTOR) || (N_WIDTH % BANKING_FACTOR)
+#error "The folded problems must fill the banks of whole cores"
+#endif
+
+__fp16 l1_G[N_ROW_INV * 2 * N_TX * NUM_BANKS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1_prio")));
+__fp16 l1_L[N_ROW_INV * 2 * N_TX * NUM_BANKS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1_prio")));
+__fp16 l1_Ginv[N_ROW_INV * 2 * N_TX * NUM_BANKS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1_prio")));
+__fp16 l1_A[N_ROW_SOL * 2 * N_TX * NUM_BANKS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1_prio")));
+__fp16 l1_LX[N_ROW_SOL * 2 * N_TX * NUM_BANKS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1_prio")));
+
+// Unfolded results
+__fp16 l1_Out[2 * N_TX * (N_TX > N_RHS ? N_TX : N_RHS) * N_ITR]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+// Copy n rows of w complex elements between the folded and unfolded layouts
+static void cfold_copy(__fp16 *pDst, __fp16 *pSrc, const uint32_t n,
+                       const uint32_t w, const uint32_t ldDst,
+                       const uint32_t ldSrc) {
+  for (uint32_t i = 0; i < n; i++) {
+    for (uint32_t j = 0; j < 2 * w; j++) {
+      pDst[2 * i * ldDst + j] = pSrc[2 * i * ldSrc + j];
+    }
+  }
+}
+
+// Driver program
+int main() {
+
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t itr;
+  mempool_barrier_init(core_id); // Initialize barrier and synchronize
+
+  /* Initialize the folded matrices */
+  for (itr = core_id; itr < N_ITR; itr += num_cores) {
+    __fp16 *PtrG = l2_G + itr * (2 * N_TX * N_TX);
+    __fp16 *PtrB = l2_B + itr * (2 * N_TX * N_RHS);
+    __fp16 *PtrA = l1_A + CFOLD_F16(itr, N_TX, N_WIDTH);
+    cfold_copy(l1_G + CFOLD_F16(itr, N_TX, N_TX), PtrG, N_TX, N_TX, NUM_BANKS,
+               N_TX);
+    cfold_copy(PtrA, PtrG, N_TX, N_TX, NUM_BANKS, N_TX);
+    cfold_copy(PtrA + 2 * N_TX, PtrB, N_TX, N_RHS, NUM_BANKS, N_RHS);
+  }
+  mempool_barrier(num_cores);
+
+#ifdef INVERSE
+  mempool_start_benchmark();
+  mempool_cinverse_f16p(l1_G, l1_L, l1_Ginv, N_TX, N_ITR, core_id, num_cores);
+  mempool_barrier(num_cores);
+  mempool_stop_benchmark();
+
+  for (itr = core_id; itr < N_ITR; itr += num_cores) {
+    cfold_copy(l1_Out + itr * (2 * N_TX * N_TX),
+               l1_Ginv + CFOLD_F16(itr, N_TX, N_TX), N_TX, N_TX, N_TX,
+               NUM_BANKS);
+  }
+  mempool_barrier(num_cores);
+  mempool_check_f16(l1_Out, l2_Ginv, 2 * N_TX * N_TX * N_ITR, 0.01f, 0);
+  mempool_barrier(num_cores);
+#endif
+
+#ifdef SOLVE
+  mempool_start_benchmark();
+  mempool_csolve_f16p(l1_A, l1_LX, N_TX, N_RHS, N_ITR, core_id, num_cores);
+  mempool_barrier(num_cores);
+  mempool_stop_benchmark();
+
+  for (itr = core_id; itr < N_ITR; itr += num_cores) {
+    cfold_copy(l1_Out + itr * (2 * N_TX * N_RHS),
+               l1_LX + CFOLD_F16(itr, N_TX, N_WIDTH) + 2 * N_TX, N_TX, N_RHS,
+               N_RHS, NUM_BANKS);
+  }
+  mempool_barrier(num_cores);
+  mempool_check_f16(l1_Out, l2_X, 2 * N_TX * N_RHS * N_ITR, 0.01f, 0);
+  mempool_barrier(num_cores);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Mempool runtime libraries */
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_conv2d_fft_f32.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_conv2d_fft_f32p.h"
+#include "baremetal/mempool_conv2d_i32p.h"
+
+/*
+======================
+Parameters and defines
+
+DIRECT: When defined also runs the direct convolution conv2d_parallel, for
+the central 3x3, 5x5, ..., K_SIZE x K_SIZE filters of l2_KerInt, to find the
+filter size above which the frequency-domain convolution is faster.
+NUM_PE: Number of cores used by the kernels (power of two).
+*/
+
+#define DIRECT
+#define NUM_PE (NUM_CORES)
+#define N_PIXELS (IMG_ROWS * IMG_COLS)
+
+float l1_Img[2 * N_PIXELS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+float l1_Ker[2 * N_PIXELS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+float l1_Tmp[2 * N_PIXELS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+float l1_twiddleCoef_row[2 * N_TWIDDLES_ROW]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+float l1_twiddleCoef_col[2 * N_TWIDDLES_COL]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_Radix_row[N_STAGES_ROW]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_Radix_col[N_STAGES_COL]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint16_t l1_DigitRevIndexTable_row[IMG_COLS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint16_t l1_DigitRevIndexTable_col[IMG_ROWS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+#ifdef DIRECT
+int32_t l1_ImgInt[N_PIXELS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+int32_t l1_OutInt[N_PIXELS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_KerInt[K_SIZE * K_SIZE]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_KerSub[K_SIZE * K_SIZE]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+#endif
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end;
+  mempool_barrier_init(core_id);
+
+  /* INITIALIZATION */
+
+  if (core_id == 0) {
+    dma_memcpy_blocking(l1_Img, l2_Img, 2 * N_PIXELS * sizeof(float));
+    dma_memcpy_blocking(l1_Ker, l2_Ker, 2 * N_PIXELS * sizeof(float));
+    dma_memcpy_blocking(l1_twiddleCoef_row, l2_twiddleCoef_row,
+                        2 * N_TWIDDLES_ROW * sizeof(float));
+    dma_memcpy_blocking(l1_twiddleCoef_col, l2_twiddleCoef_col,
+                        2 * N_TWIDDLES_COL * sizeof(float));
+    dma_memcpy_blocking(l1_Radix_row, l2_Radix_row,
+                        N_STAGES_ROW * sizeof(uint32_t));
+    dma_memcpy_blocking(l1_Radix_col, l2_Radix_col,
+                        N_STAGES_COL * sizeof(uint32_t));
+    dma_memcpy_blocking(l1_DigitRevIndexTable_row, l2_DigitRevIndexTable_row,
+                        IMG_COLS * sizeof(uint16_t));
+    dma_memcpy_blocking(l1_DigitRevIndexTable_col, l2_DigitRevIndexTable_col,
+                        IMG_ROWS * sizeof(uint16_t));
+#ifdef DIRECT
+    dma_memcpy_blocking(l1_ImgInt, l2_ImgInt, N_PIXELS * sizeof(int32_t));
+    dma_memcpy_blocking(l1_KerInt, l2_KerInt,
+                        K_SIZE * K_SIZE * sizeof(int32_t));
+#endif
+    printf("01: END INITIALIZATION\n");
+  }
+  mempool_barrier(num_cores);
+
+  /* COMPUTATION */
+
+#ifdef DIRECT
+  for (uint32_t k = 3; k <= K_SIZE; k += 2) {
+    // The central k x k filter, and an output with the border of zeros of
+    // the golden result
+    if (core_id == 0) {
+      uint32_t offset = (K_SIZE - k) / 2;
+      for (uint32_t m = 0; m < k; m++) {
+        for (uint32_t n = 0; n < k; n++) {
+          l1_KerSub[m * k + n] = l1_KerInt[(m + offset) * K_SIZE + n + offset];
+        }
+      }
+      memset(l1_OutInt, 0, N_PIXELS * sizeof(int32_t));
+    }
+    mempool_barrier(num_cores);
+    time_init = 0;
+    time_end = 0;
+    if (core_id < NUM_PE) {
+      time_init = mempool_get_timer();
+      mempool_start_benchmark();
+      conv2d_parallel(l1_ImgInt, IMG_COLS, IMG_ROWS, l1_KerSub, k, k,
+                      l1_OutInt, core_id, NUM_PE);
+      mempool_log_partial_barrier(2, core_id, NUM_PE);
+      mempool_stop_benchmark();
+      time_end = mempool_get_timer();
+    }
+    mempool_barrier(num_cores);
+    if (core_id == 0) {
+      printf("Direct %dx%d convolution takes %d clock cycles\n", k, k,
+             time_end - time_init);
+    }
+    mempool_check_i32(l1_OutInt, &l2_OutInt[(k - 3) / 2 * N_PIXELS], N_PIXELS,
+                      0, 0);
+    mempool_barrier(num_cores);
+  }
+#endif
+
+  time_init = 0;
+  time_end = 0;
+  if (core_id < NUM_PE) {
+    time_init = mempool_get_timer();
+    mempool_start_benchmark();
+    mempool_conv2d_fft_f32p(
+        l1_Img, l1_Ker, l1_Tmp, IMG_ROWS, IMG_COLS, l1_twiddleCoef_row,
+        l1_Radix_row, N_STAGES_ROW, l1_DigitRevIndexTable_row,
+        l1_twiddleCoef_col, l1_Radix_col, N_STAGES_COL,
+        l1_DigitRevIndexTable_col, NUM_PE);
+    mempool_stop_benchmark();
+    time_end = mempool_get_timer();
+  }
+  mempool_barrier(num_cores);
+
+  if (core_id == 0) {
+    printf("FFT convolution takes %d clock cycles\n", time_end - time_init);
+    printf("02: END COMPUTATION\n");
+  }
+
+  mempool_check_f32(l1_Img, l2_Out, 2 * N_PIXELS, (float)TOLERANCE, 0);
+  mempool_barrier(num_cores);
+  return 0;
+}
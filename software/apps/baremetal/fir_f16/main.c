@@ -0,0 +1,108 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_fir_f16.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_fir_f16p.h"
+
+/*
+======================
+Parameters and defines
+
+NUM_PE: Number of cores used by the kernels.
+MIN_TAPS: The filters with MIN_TAPS, 2 * MIN_TAPS, ... N_TAPS taps are
+benchmarked, the results of N_TAPS taps are checked.
+*/
+
+#define NUM_PE (NUM_CORES)
+#define MIN_TAPS (32)
+#define COEFF_WORDS                                                            \
+  (FIR_COEFF_WORDS(N_TAPS, INTERP) > FIR_COEFF_WORDS(N_TAPS, 1)                \
+       ? FIR_COEFF_WORDS(N_TAPS, INTERP)                                       \
+       : FIR_COEFF_WORDS(N_TAPS, 1))
+
+// Input preceded by the history and followed by zeros
+__fp16 l1_X[N_TAPS + N_SAMPLES + FIR_TAIL]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_H[N_TAPS] __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+int32_t l1_Coeffs[COEFF_WORDS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+__fp16 l1_Y[N_SAMPLES * INTERP]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+static void benchmark(const char *name, uint32_t L, uint32_t D, __fp16 *pExp) {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end, clock_cycles;
+  uint32_t nOut = (N_SAMPLES * L) / D;
+
+  for (uint32_t nTaps = MIN_TAPS; nTaps <= N_TAPS; nTaps *= 2) {
+    if (core_id < NUM_PE) {
+      mempool_fir_polyphase_init((uint16_t *)l1_H, nTaps, L,
+                                 (uint32_t *)l1_Coeffs, NUM_PE);
+    }
+    mempool_barrier(num_cores);
+    time_init = 0;
+    time_end = 0;
+    if (core_id < NUM_PE) {
+      time_init = mempool_get_timer();
+      mempool_start_benchmark();
+      mempool_fir_f16p(l1_X + N_TAPS, l1_Coeffs, l1_Y, nOut, nTaps, L, D,
+                       NUM_PE);
+      mempool_stop_benchmark();
+      time_end = mempool_get_timer();
+    }
+    mempool_barrier(num_cores);
+    if (core_id == 0) {
+      clock_cycles = time_end - time_init;
+      printf("%s, %d taps: %d cycles, %d outputs per 1000 cycles\n", name,
+             nTaps, clock_cycles,
+             (nOut / clock_cycles) * 1000 +
+                 ((nOut % clock_cycles) * 1000) / clock_cycles);
+    }
+  }
+  mempool_check_f16(l1_Y, pExp, nOut, (float)TOLERANCE, 0);
+  mempool_barrier(num_cores);
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  mempool_barrier_init(core_id);
+
+  /* INITIALIZATION */
+
+  if (core_id == 0) {
+    dma_memcpy_blocking(l1_X + N_TAPS, l2_X, N_SAMPLES * sizeof(__fp16));
+    dma_memcpy_blocking(l1_H, l2_H, N_TAPS * sizeof(__fp16));
+    for (uint32_t i = 0; i < N_TAPS; i++) {
+      l1_X[i] = 0;
+    }
+    for (uint32_t i = 0; i < FIR_TAIL; i++) {
+      l1_X[N_TAPS + N_SAMPLES + i] = 0;
+    }
+    printf("01: END INITIALIZATION\n");
+  }
+  mempool_barrier(num_cores);
+
+  /* COMPUTATION */
+
+  benchmark("FIR", 1, 1, l2_Y);
+  benchmark("Decimator", 1, DECIM, l2_YDecim);
+  benchmark("Interpolator", INTERP, 1, l2_YInterp);
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_histogram_i16.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_histogram_i16p.h"
+
+/*
+======================
+Parameters and defines
+
+Histogram and equalization of a 16b image in L2, built by tiling l2_Patch.
+The image is streamed through two L1 buffers of CHUNK_WORDS words. The
+histogram is accumulated per tile, merged and turned into the equalization
+LUT, and a second pass equalizes the image in place.
+
+CHUNK_WORDS: Words of an L1 buffer, multiple of NUM_BANKS.
+NUM_BINS: Number of bins, power of two, the pixels are binned by their
+most significant bits.
+*/
+
+#define CHUNK_WORDS (16 * NUM_BANKS)
+#define N_WORDS (IMG_WIDTH * IMG_HEIGHT / 2)
+#define N_CHUNKS (N_WORDS / CHUNK_WORDS)
+#define PATCH_WORDS (N_PATCH / 2)
+// Pixel bits dropped to index the bins
+#define SHIFT (16 - __builtin_ctz(NUM_BINS))
+
+#if (N_WORDS % CHUNK_WORDS) || ((IMG_WIDTH * IMG_HEIGHT) % N_PATCH)
+#error "The image must be a multiple of the chunks and of the patch"
+#endif
+
+uint32_t l2_Img[N_WORDS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l2")));
+
+uint32_t l1_Buf[2][CHUNK_WORDS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+uint32_t l1_Bins[HIST_WORDS(NUM_BINS)]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+uint32_t l1_Lut[HIST_WORDS(NUM_BINS)]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+uint32_t l1_Cdf[NUM_BINS + 1]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_Out[NUM_BINS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+uint32_t volatile dma_barrier __attribute__((section(".l1")));
+uint32_t volatile errors __attribute__((section(".l1")));
+
+// The last core to finish a chunk waits for the next one and starts the
+// transfers of the buffer just processed
+static void histogram_next_chunk(uint32_t chunk, uint32_t store,
+                                 uint32_t num_cores) {
+  if ((num_cores - 1) ==
+      __atomic_fetch_add(&dma_barrier, 1, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&dma_barrier, 0, __ATOMIC_RELAXED);
+    __sync_synchronize();
+    dma_wait();
+    if (store) {
+      dma_memcpy_blocking(l2_Img + chunk * CHUNK_WORDS, l1_Buf[chunk % 2],
+                          CHUNK_WORDS * sizeof(int32_t));
+    }
+    if (chunk + 2 < N_CHUNKS) {
+      dma_memcpy_nonblocking(l1_Buf[chunk % 2],
+                             l2_Img + (chunk + 2) * CHUNK_WORDS,
+                             CHUNK_WORDS * sizeof(int32_t));
+    }
+    wake_up_all();
+  }
+  mempool_wfi();
+}
+
+static void histogram_first_chunks(uint32_t core_id, uint32_t num_cores) {
+  if (core_id == 0) {
+    dma_memcpy_blocking(l1_Buf[0], l2_Img, CHUNK_WORDS * sizeof(int32_t));
+    if (N_CHUNKS > 1) {
+      dma_memcpy_nonblocking(l1_Buf[1], l2_Img + CHUNK_WORDS,
+                             CHUNK_WORDS * sizeof(int32_t));
+    }
+  }
+  mempool_barrier(num_cores);
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t *patch = (uint32_t *)l2_Patch;
+  uint32_t i, chunk, word, err;
+  mempool_barrier_init(core_id);
+
+  /* Build the image */
+  for (i = core_id; i < N_WORDS; i += num_cores) {
+    l2_Img[i] = patch[i % PATCH_WORDS];
+  }
+  if (core_id == 0) {
+    dma_barrier = 0;
+    errors = 0;
+  }
+  mempool_histogram_init(l1_Bins, NUM_BINS, num_cores);
+
+  /* Histogram */
+  mempool_start_benchmark();
+  histogram_first_chunks(core_id, num_cores);
+  for (chunk = 0; chunk < N_CHUNKS; chunk++) {
+    mempool_histogram_i16p(l1_Buf[chunk % 2], CHUNK_WORDS, l1_Bins, SHIFT,
+                           num_cores);
+    histogram_next_chunk(chunk, 0, num_cores);
+  }
+  mempool_histogram_merge(l1_Bins, NUM_BINS, num_cores);
+  mempool_stop_benchmark();
+
+  /* Equalization */
+  mempool_start_benchmark();
+  mempool_histogram_lut(l1_Bins, l1_Cdf, l1_Lut, NUM_BINS,
+                        IMG_WIDTH * IMG_HEIGHT, 65535, num_cores);
+  histogram_first_chunks(core_id, num_cores);
+  for (chunk = 0; chunk < N_CHUNKS; chunk++) {
+    mempool_histogram_equalize_i16p(l1_Buf[chunk % 2], l1_Buf[chunk % 2],
+                                    CHUNK_WORDS, l1_Lut, SHIFT, num_cores);
+    histogram_next_chunk(chunk, 1, num_cores);
+  }
+  mempool_stop_benchmark();
+
+  /* Check */
+  for (i = core_id; i < NUM_BINS; i += num_cores) {
+    l1_Out[i] = l1_Bins[HIST_IDX(i)];
+  }
+  mempool_barrier(num_cores);
+  mempool_check_i32((int32_t *)l1_Out, (int32_t *)l2_Hist, NUM_BINS, 0, 0);
+  mempool_barrier(num_cores);
+  for (i = core_id; i < NUM_BINS; i += num_cores) {
+    l1_Out[i] = l1_Lut[HIST_IDX(i)];
+  }
+  mempool_barrier(num_cores);
+  mempool_check_i32((int32_t *)l1_Out, (int32_t *)l2_Lut, NUM_BINS, 0, 0);
+  mempool_barrier(num_cores);
+  err = 0;
+  for (i = core_id; i < N_WORDS; i += num_cores) {
+    word = patch[i % PATCH_WORDS];
+    word = l2_Lut[(word & 0xFFFF) >> SHIFT] |
+           (l2_Lut[word >> (16 + SHIFT)] << 16);
+    err += (l2_Img[i] != word);
+  }
+  __atomic_fetch_add(&errors, err, __ATOMIC_RELAXED);
+  mempool_barrier(num_cores);
+  if (core_id == 0) {
+    printf("%d ERRORS out of %d EQUALIZED WORDS\n", errors, N_WORDS);
+  }
+  mempool_barrier(num_cores);
+  return 0;
+}
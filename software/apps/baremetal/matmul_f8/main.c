@@ -0,0 +1,71 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "builtins_v2.h"
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_matmul_f8.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_matmul_f8.h"
+
+/*
+======================
+Parameters and defines
+
+The fp8 (e5m2) product is accumulated in f16 and checked against the f32
+golden model. The result is then converted back to fp8 and checked against the
+rounded golden model.
+*/
+
+__fp8 matrix_a[matrix_M * matrix_N]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+__fp8 matrix_b[matrix_N * matrix_P]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+__fp16 matrix_c[matrix_M * matrix_P]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+__fp8 matrix_c8[matrix_M * matrix_P]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  // Initialize barrier and synchronize
+  mempool_barrier_init(core_id);
+
+  // Initialize Matrices
+  if (core_id == 0) {
+    dma_memcpy_blocking(matrix_a, l2_A, (matrix_M * matrix_N) * sizeof(int8_t));
+    dma_memcpy_blocking(matrix_b, l2_B, (matrix_N * matrix_P) * sizeof(int8_t));
+  }
+  mempool_barrier(num_cores);
+
+  // Execute function to test.
+  mempool_start_benchmark();
+  matmul_4x4_parallel_f8vec(matrix_a, matrix_b, matrix_c, matrix_M, matrix_N,
+                            matrix_P, core_id, num_cores);
+  mempool_barrier(num_cores);
+  mempool_stop_benchmark();
+  mempool_check_f16(matrix_c, l2_C, matrix_M * matrix_P, 0.1f, 0);
+  mempool_barrier(num_cores);
+
+  // Convert the result to fp8
+  mempool_start_benchmark();
+  mempool_cvt_f16_to_f8(matrix_c, matrix_c8, matrix_M * matrix_P, core_id,
+                        num_cores);
+  mempool_barrier(num_cores);
+  mempool_stop_benchmark();
+  mempool_check_f8(matrix_c8, l2_C8, matrix_M * matrix_P, 0.5f, 0);
+  mempool_barrier(num_cores);
+  return 0;
+}
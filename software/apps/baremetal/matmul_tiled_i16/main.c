@@ -0,0 +1,69 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_matmul_tiled_i16.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_matmul_tiled.h"
+
+/*
+======================
+Parameters and defines
+
+The matrices stay in L2 and are streamed to L1 in tiles of MATMUL_TILE_M x
+MATMUL_TILE_K and MATMUL_TILE_K x MATMUL_TILE_P, the sustained MACs per cycle
+are printed. The operands fill most of L2, so only the check_rows rows of the
+result listed in l2_C_rows are checked.
+*/
+
+int32_t l2_Res[matrix_M * matrix_P]
+    __attribute__((aligned(sizeof(int32_t)), section(".l2")));
+
+uint8_t l1_Work[MATMUL_TILED_L1_BYTES(sizeof(int16_t), sizeof(int32_t))]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+uint32_t volatile tile_barrier __attribute__((section(".l1")));
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end;
+  // Initialize barrier and synchronize
+  mempool_barrier_init(core_id);
+  if (core_id == 0) {
+    tile_barrier = 0;
+  }
+  mempool_barrier(num_cores);
+
+  // Execute function to test.
+  time_init = mempool_get_timer();
+  mempool_start_benchmark();
+  mempool_matmul_tiled(MATMUL_I16, l2_A, l2_B, l2_Res, matrix_M, matrix_N,
+                       matrix_P, l1_Work, &tile_barrier, core_id, num_cores);
+  mempool_stop_benchmark();
+  time_end = mempool_get_timer();
+
+  if (core_id == 0) {
+    uint32_t macs = matrix_M * matrix_N * matrix_P;
+    uint32_t cycles = time_end - time_init;
+    printf("%d MACs in %d cycles, %d.%02d MACs/cycle\n", macs, cycles,
+           macs / cycles, (100 * (macs % cycles)) / cycles);
+  }
+  for (uint32_t i = 0; i < check_rows; i++) {
+    mempool_check_i32(&l2_Res[l2_C_rows[i] * matrix_P], &l2_C[i * matrix_P],
+                      matrix_P, 0, 0);
+  }
+  mempool_barrier(num_cores);
+  return 0;
+}
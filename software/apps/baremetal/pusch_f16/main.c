@@ -0,0 +1,310 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Mempool runtime libraries */
+#include "builtins_v2.h"
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_pusch_f16.h"
+
+/*
+======================
+Parameters and defines
+
+The PUSCH receiver is a pipeline of three stages, each run by a group of cores:
+OFDM demodulation (FFT), channel estimation (CHEST) and MIMO-MMSE detection.
+The slots stream through the stages, which hand them over in L1 double
+buffers. The leader of each stage publishes the slots it completed in a flag
+and waits on the flags of its neighbours, the other cores of the stage wait in
+the stage barrier.
+
+N_CORES_FFT: Number of cores of the FFT stage, from core 0.
+N_CORES_CHEST: Number of cores of the CHEST stage, after the FFT stage.
+N_CORES_MIMO: Number of cores of the MIMO stage, after the CHEST stage.
+Each stage has a power of two cores and starts at a multiple of its size.
+POLL: Cycles a stage leader waits between two reads of a flag.
+*/
+
+#ifndef N_CORES_FFT
+#define N_CORES_FFT (NUM_CORES / 4)
+#endif
+#ifndef N_CORES_CHEST
+#define N_CORES_CHEST (NUM_CORES / 4)
+#endif
+#ifndef N_CORES_MIMO
+#define N_CORES_MIMO (NUM_CORES / 2)
+#endif
+#define POLL (16)
+
+#if (N_SLOTS < 2)
+#error The throughput is measured over at least two slots
+#endif
+
+#define CHEST_START (N_CORES_FFT)
+#define MIMO_START (N_CORES_FFT + N_CORES_CHEST)
+#if (MIMO_START + N_CORES_MIMO > NUM_CORES)
+#error The stages need more than NUM_CORES cores
+#endif
+#if ((CHEST_START % N_CORES_CHEST) != 0) || ((MIMO_START % N_CORES_MIMO) != 0)
+#error Each stage must start at a multiple of its number of cores
+#endif
+
+// CFFT Parameters
+#define FOLDED_TWIDDLES
+#define BITREVERSETABLE
+#define CORES_USED ((N_SC / 4) / BANKING_FACTOR)
+#define N_FFTs_COL (N_CORES_FFT / CORES_USED)
+#define N_FFTs_ROW ((2 * N_RX) / N_FFTs_COL)
+#if (N_FFTs_COL == 0) || ((2 * N_RX) % N_FFTs_COL != 0)
+#error The FFT stage must run N_FFTs_COL FFTs in parallel, dividing 2 * N_RX
+#endif
+#if (N_FFTs_COL * N_SC > 4 * NUM_BANKS)
+#error Parallelization not supporting N_FFTs_COL > [4 * NUM_BANKS / N_SC]
+#endif
+#if ((LOG2 / 2) % 2 != 0)
+#error The FFT returns the output in its input only for an even number of stages
+#endif
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_cholesky_f16s.h"
+#include "baremetal/mempool_linearsolver_f16s.h"
+#include "baremetal/mempool_mimo_mmse_f16s.h"
+#include "baremetal/mempool_radix4_cfft_butterfly_f16.h"
+#include "baremetal/mempool_radix4_cfft_f16p.h"
+
+// Included last, as it enables __CDOTP also for the kernels that follow it
+#include "baremetal/mempool_chest_f16.h"
+
+// Time-domain symbols of a slot, the pilot symbol on the first N_RX antennas
+// and the data symbol on the others. The FFT returns its output in place.
+__fp16 l1_Symb[2][N_FFTs_ROW * 8 * NUM_BANKS]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_FFT_Tmp[N_FFTs_ROW * 8 * NUM_BANKS]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_twiddleCoef_f16[6 * NUM_BANKS]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_twiddleCoef_f16_src[6 * NUM_BANKS]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_twiddleCoef_f16_dst[6 * NUM_BANKS]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+uint16_t l1_BitRevIndexTable[BITREVINDEXTABLE_LENGTH]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+
+// Inputs of the channel estimation, and outputs handed to the MIMO stage
+__fp16 l1_PilotTX[2 * N_TX * N_SC]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_PilotRX[2 * N_RX * N_SC]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_H[2][2 * N_RX * N_TX * N_SC]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+__fp16 l1_y[2][2 * N_RX * N_SC]
+    __attribute__((aligned(4 * NUM_BANKS), section(".l1_prio")));
+
+// Auxiliary vectors of each MIMO core and detected symbols of all the slots
+__fp16 l1_S[2 * N_TX] __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_G[N_CORES_MIMO][2 * N_TX * N_TX]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_L[N_CORES_MIMO][2 * N_TX * N_TX]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_y2[N_CORES_MIMO][2 * N_TX]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_y3[N_CORES_MIMO][2 * N_TX]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+__fp16 l1_x[2 * N_TX * N_SC * N_SLOTS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+// Slots completed by each stage. chest_read counts the FFT buffers released
+// by the CHEST stage, which copies them before the estimation.
+uint32_t volatile fft_done __attribute__((section(".l1")));
+uint32_t volatile chest_read __attribute__((section(".l1")));
+uint32_t volatile chest_done __attribute__((section(".l1")));
+uint32_t volatile mimo_done __attribute__((section(".l1")));
+// Completion time of each slot
+uint32_t slot_end[N_SLOTS] __attribute__((section(".l1")));
+
+// Wait until a flag counts more than count slots
+static inline void pusch_wait(uint32_t volatile *flag, uint32_t count) {
+  while (*flag <= count) {
+    mempool_wait(POLL);
+  }
+}
+
+/* OFDM DEMODULATION */
+void pusch_fft(uint32_t core_id) {
+  uint32_t i, row, slot;
+  __fp16 *pSymb;
+
+  for (slot = 0; slot < N_SLOTS; slot++) {
+    pSymb = l1_Symb[slot % 2];
+    if (core_id == 0) {
+      // Wait for the CHEST stage to release the buffer
+      if (slot >= 2) {
+        pusch_wait(&chest_read, slot - 2);
+      }
+      // Each row holds N_FFTs_COL antennas
+      for (row = 0; row < N_FFTs_ROW; row++) {
+        dma_memcpy_blocking(
+            pSymb + row * (8 * NUM_BANKS),
+            l2_Symb + (slot * 2 * N_RX + row * N_FFTs_COL) * (2 * N_SC),
+            N_FFTs_COL * N_SC * sizeof(int32_t));
+      }
+    }
+    // The FFT overwrites the twiddles of the first stage with those of the
+    // next stages, each core restores the ones it reads
+    for (i = (core_id % CORES_USED) * 4; i < (core_id % CORES_USED) * 4 + 4;
+         i++) {
+      for (row = 0; row < 3; row++) {
+        *(v2h *)&l1_twiddleCoef_f16_src[2 * (i + row * NUM_BANKS)] =
+            *(v2h *)&l1_twiddleCoef_f16[2 * (i + row * NUM_BANKS)];
+      }
+    }
+    mempool_log_partial_barrier(2, core_id, N_CORES_FFT);
+    mempool_radix4_cfft_f16p_scheduler(
+        pSymb, l1_FFT_Tmp, N_SC, N_FFTs_ROW, N_FFTs_COL, l1_twiddleCoef_f16_src,
+        l1_twiddleCoef_f16_dst, l1_BitRevIndexTable, BITREVINDEXTABLE_LENGTH, 1,
+        CORES_USED);
+    mempool_log_partial_barrier(2, core_id, N_CORES_FFT);
+    if (core_id == 0) {
+      __atomic_store_n(&fft_done, slot + 1, __ATOMIC_SEQ_CST);
+    }
+  }
+  return;
+}
+
+/* CHANNEL ESTIMATION */
+void pusch_chest(uint32_t core_id) {
+  uint32_t pe_id = core_id - CHEST_START;
+  uint32_t i, ant, sc, slot;
+  __fp16 *pSymb;
+  __fp16 *pDst;
+
+  for (slot = 0; slot < N_SLOTS; slot++) {
+    pSymb = l1_Symb[slot % 2];
+    if (pe_id == 0) {
+      // Wait for the FFT of the slot, and for the MIMO stage to release the
+      // outputs
+      pusch_wait(&fft_done, slot);
+      if (slot >= 2) {
+        pusch_wait(&mimo_done, slot - 2);
+      }
+    }
+    mempool_log_partial_barrier(2, core_id, N_CORES_CHEST);
+    // Gather the antennas of each subcarrier
+    for (i = pe_id; i < 2 * N_RX * N_SC; i += N_CORES_CHEST) {
+      ant = i / N_SC;
+      sc = i % N_SC;
+      pDst = ant < N_RX ? &l1_PilotRX[2 * (sc * N_RX + ant)]
+                        : &l1_y[slot % 2][2 * (sc * N_RX + ant - N_RX)];
+      *(v2h *)pDst = *(v2h *)&pSymb[(ant / N_FFTs_COL) * (8 * NUM_BANKS) +
+                                    2 * ((ant % N_FFTs_COL) * N_SC + sc)];
+    }
+    mempool_log_partial_barrier(2, core_id, N_CORES_CHEST);
+    if (pe_id == 0) {
+      __atomic_store_n(&chest_read, slot + 1, __ATOMIC_SEQ_CST);
+    }
+    mempool_chest_f16p_unrolled4_local(l1_H[slot % 2], l1_PilotRX, l1_PilotTX,
+                                       N_RX, N_TX, N_SC, pe_id, N_CORES_CHEST);
+    if (pe_id == 0) {
+      __atomic_store_n(&chest_done, slot + 1, __ATOMIC_SEQ_CST);
+    }
+  }
+  return;
+}
+
+/* MIMO DETECTION */
+void pusch_mimo(uint32_t core_id) {
+  uint32_t pe_id = core_id - MIMO_START;
+  uint32_t sc, slot;
+  __fp16 *PtrG = l1_G[pe_id];
+  __fp16 *PtrL = l1_L[pe_id];
+  __fp16 *Ptry2 = l1_y2[pe_id];
+  __fp16 *Ptry3 = l1_y3[pe_id];
+
+  for (slot = 0; slot < N_SLOTS; slot++) {
+    if (pe_id == 0) {
+      pusch_wait(&chest_done, slot);
+    }
+    mempool_log_partial_barrier(2, core_id, N_CORES_MIMO);
+    // Parallel subcarrier loop
+    for (sc = pe_id; sc < N_SC; sc += N_CORES_MIMO) {
+      __fp16 *PtrH = l1_H[slot % 2] + sc * (2 * N_TX * N_RX);
+      __fp16 *Ptry = l1_y[slot % 2] + sc * (2 * N_RX);
+      __fp16 *Ptrx = l1_x + (slot * N_SC + sc) * (2 * N_TX);
+      mempool_hermitian_f16vecs(PtrH, PtrG, l1_S, N_RX, N_TX, 0, 0);
+      mempool_MVP_conjtransp_f16vecs(PtrH, Ptry, Ptry2, N_RX, N_TX);
+      mempool_cholesky_f16vecs(PtrG, PtrL, N_TX, 0);
+      mempool_Ltrisol_f16s(PtrL, Ptry2, Ptry3, N_TX, 0, 0);
+      mempool_Ltrisol_f16s(PtrL, Ptry3, Ptrx, N_TX, 1, 0);
+    }
+    mempool_log_partial_barrier(2, core_id, N_CORES_MIMO);
+    if (pe_id == 0) {
+      slot_end[slot] = mempool_get_timer();
+      __atomic_store_n(&mimo_done, slot + 1, __ATOMIC_SEQ_CST);
+    }
+  }
+  return;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* MAIN */
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init;
+  mempool_barrier_init(core_id);
+
+  /* INITIALIZATION */
+  if (core_id == 0) {
+    fft_done = 0;
+    chest_read = 0;
+    chest_done = 0;
+    mimo_done = 0;
+    dma_memcpy_blocking(l1_BitRevIndexTable, l2_BitRevIndexTable,
+                        BITREVINDEXTABLE_LENGTH * sizeof(int16_t));
+    dma_memcpy_blocking(l1_PilotTX, l2_PilotTX, N_TX * N_SC * sizeof(int32_t));
+    dma_memcpy_blocking(l1_S, l2_S, N_TX * sizeof(int32_t));
+  }
+  // Fold the twiddles of the first stage, all the FFTs read the same ones
+  for (uint32_t i = core_id; i < (N_SC >> 2); i += num_cores) {
+    *(v2h *)&l1_twiddleCoef_f16[2 * i] = *(v2h *)&l2_twiddleCoef_f16[2 * i];
+    *(v2h *)&l1_twiddleCoef_f16[2 * (i + 1 * NUM_BANKS)] =
+        *(v2h *)&l2_twiddleCoef_f16[2 * (i * 2U)];
+    *(v2h *)&l1_twiddleCoef_f16[2 * (i + 2 * NUM_BANKS)] =
+        *(v2h *)&l2_twiddleCoef_f16[2 * (i * 3U)];
+  }
+  mempool_barrier(num_cores);
+
+  /* PIPELINE */
+  mempool_start_benchmark();
+  time_init = mempool_get_timer();
+  if (core_id < CHEST_START) {
+    pusch_fft(core_id);
+  } else if (core_id < MIMO_START) {
+    pusch_chest(core_id);
+  } else if (core_id < MIMO_START + N_CORES_MIMO) {
+    pusch_mimo(core_id);
+  }
+  mempool_barrier(num_cores);
+  mempool_stop_benchmark();
+
+  if (core_id == 0) {
+    printf("First slot latency: %d\n", slot_end[0] - time_init);
+    printf("Cycles per slot: %d\n",
+           (slot_end[N_SLOTS - 1] - slot_end[0]) / (N_SLOTS - 1));
+  }
+  mempool_check_f16(l1_x, l2_x, 2 * N_TX * N_SC * N_SLOTS, (float)TOLERANCE, 0);
+  mempool_barrier(num_cores);
+  return 0;
+}
@@ -0,0 +1,161 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_sort_i32.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_sort_i32p.h"
+
+/*
+======================
+Parameters and defines
+
+KEY_VALUE: When defined sorts key/value pairs, the values are the positions
+of the keys in the input. Else sorts the keys only.
+BITONIC: When defined also runs the bitonic sort on BITONIC_KEYS keys.
+MIN_KEYS: The radix sort runs on MIN_KEYS, 2 MIN_KEYS, ..., N_KEYS keys, with
+the histograms in the interleaved memory and in the local banks of the cores.
+NUM_PE: Number of cores used by the kernels (power of two).
+With KEY_VALUE undefined and NUM_PE = 1024, TeraPool sorts up to 256K keys.
+*/
+
+#define KEY_VALUE
+#define BITONIC
+#define MIN_KEYS (4096)
+#define BITONIC_KEYS (1024)
+#define NUM_PE (NUM_CORES)
+
+uint32_t l1_Keys[N_KEYS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+uint32_t l1_KeysTmp[N_KEYS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+#ifdef KEY_VALUE
+uint32_t l1_Vals[N_KEYS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+uint32_t l1_ValsTmp[N_KEYS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1_prio")));
+#else
+uint32_t *l1_Vals = NULL;
+uint32_t *l1_ValsTmp = NULL;
+#endif
+uint32_t l1_Hist[RADIXSORT_NBINS * NUM_CORES]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+uint32_t l1_Total[RADIXSORT_NBINS]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+
+// Load the first n keys, the values are their positions
+static void init_keys(uint32_t n, uint32_t core_id, uint32_t num_cores) {
+  if (core_id == 0) {
+    dma_memcpy_blocking(l1_Keys, l2_Keys, n * sizeof(uint32_t));
+  }
+#ifdef KEY_VALUE
+  for (uint32_t i = core_id; i < n; i += num_cores) {
+    l1_Vals[i] = i;
+  }
+#endif
+  mempool_barrier(num_cores);
+}
+
+// Count the unsorted keys and the values not matching their key
+static void check_sorted(uint32_t n, uint32_t core_id) {
+  if (core_id == 0) {
+    uint32_t errors = 0;
+    for (uint32_t i = 1; i < n; i++) {
+      errors += (l1_Keys[i - 1] > l1_Keys[i]) ? 1 : 0;
+    }
+#ifdef KEY_VALUE
+    for (uint32_t i = 0; i < n; i++) {
+      errors += (l2_Keys[l1_Vals[i]] != l1_Keys[i]) ? 1 : 0;
+    }
+#endif
+    printf("%d ERRORS out of %d KEYS\n", errors, n);
+  }
+}
+
+static void print_performance(uint32_t n, uint32_t clock_cycles) {
+  printf("%d keys, %d clock cycles, %d keys per 1000 cycles\n", n,
+         clock_cycles,
+         (n / clock_cycles) * 1000 + ((n % clock_cycles) * 1000) /
+                                         clock_cycles);
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end;
+  mempool_barrier_init(core_id);
+
+  /* RADIX SORT */
+
+  for (uint32_t local = 0; local < 2; local++) {
+    if (core_id == 0) {
+      printf(local ? "\nRadix sort, local histograms\n"
+                   : "\nRadix sort, interleaved histograms\n");
+    }
+    for (uint32_t n = (MIN_KEYS < N_KEYS) ? MIN_KEYS : N_KEYS; n <= N_KEYS;
+         n <<= 1) {
+      init_keys(n, core_id, num_cores);
+      time_init = 0;
+      time_end = 0;
+      if (core_id < NUM_PE) {
+        time_init = mempool_get_timer();
+        mempool_start_benchmark();
+        mempool_radixsort_i32p(l1_Keys, l1_Vals, l1_KeysTmp, l1_ValsTmp,
+                               l1_Hist, l1_Total, n, local, NUM_PE);
+        mempool_stop_benchmark();
+        time_end = mempool_get_timer();
+      }
+      mempool_barrier(num_cores);
+      if (core_id == 0) {
+        print_performance(n, time_end - time_init);
+      }
+      check_sorted(n, core_id);
+      mempool_barrier(num_cores);
+    }
+  }
+  mempool_check_i32((int32_t *)l1_Keys, (int32_t *)l2_SortedKeys, N_KEYS, 0,
+                    0);
+#ifdef KEY_VALUE
+  mempool_check_i32((int32_t *)l1_Vals, (int32_t *)l2_SortedIdx, N_KEYS, 0,
+                    0);
+#endif
+  mempool_barrier(num_cores);
+
+  /* BITONIC SORT */
+
+#ifdef BITONIC
+  if (core_id == 0) {
+    printf("\nBitonic sort\n");
+  }
+  init_keys(BITONIC_KEYS, core_id, num_cores);
+  time_init = 0;
+  time_end = 0;
+  if (core_id < NUM_PE) {
+    time_init = mempool_get_timer();
+    mempool_start_benchmark();
+    mempool_bitonicsort_i32p(l1_Keys, l1_Vals, BITONIC_KEYS, NUM_PE);
+    mempool_stop_benchmark();
+    time_end = mempool_get_timer();
+  }
+  mempool_barrier(num_cores);
+  if (core_id == 0) {
+    print_performance(BITONIC_KEYS, time_end - time_init);
+  }
+  check_sorted(BITONIC_KEYS, core_id);
+  mempool_barrier(num_cores);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dma.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+
+#include "data_spmv_i32.h"
+
+#include "baremetal/mempool_checks.h"
+#include "baremetal/mempool_spmv_i32p.h"
+
+/*
+======================
+Parameters and defines
+
+CSR: When defined runs the SpMV on the CSR matrix.
+ELL: When defined runs the SpMV on the ELLPACK matrix.
+REPLICATE_X: x is replicated in the banks of each group when its copies take
+at most 1/16 of L1, else a single copy is shared.
+NUM_PE: Number of cores used by the kernels (power of two).
+*/
+
+#define CSR
+#define ELL
+#define NUM_PE (NUM_CORES)
+#define REPLICATE_X                                                            \
+  (NUM_GROUPS * N_COLS * sizeof(int32_t) <= (NUM_BANKS * L1_BANK_SIZE) / 16)
+#define X_WORDS (N_COLS)
+#define X_REP_WORDS                                                            \
+  (((X_WORDS + SPMV_GROUP_BANKS - 1) / SPMV_GROUP_BANKS) * NUM_BANKS)
+
+int32_t l1_Val[NNZ]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+uint32_t l1_ColIdx[NNZ]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_RowPtr[N_ROWS + 1]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+uint32_t l1_RowSplit[NUM_PE + 1]
+    __attribute__((aligned(sizeof(int32_t)), section(".l1")));
+int32_t l1_EllVal[ELL_WIDTH * N_ROWS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+uint32_t l1_EllColIdx[ELL_WIDTH * N_ROWS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+int32_t l1_X[REPLICATE_X ? X_REP_WORDS : X_WORDS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+int32_t l1_Y[N_ROWS]
+    __attribute__((aligned(NUM_BANKS * sizeof(int32_t)), section(".l1")));
+
+static void print_performance(uint32_t clock_cycles) {
+  printf("\nKernel execution takes %d clock cycles\n", clock_cycles);
+  printf("%d nonzeros per 1000 cycles\n",
+         (NNZ / clock_cycles) * 1000 + ((NNZ % clock_cycles) * 1000) /
+                                           clock_cycles);
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  uint32_t time_init, time_end;
+  mempool_barrier_init(core_id);
+
+  /* INITIALIZATION */
+
+  if (core_id == 0) {
+    dma_memcpy_blocking(l1_Val, l2_Val, NNZ * sizeof(int32_t));
+    dma_memcpy_blocking(l1_ColIdx, l2_ColIdx, NNZ * sizeof(uint32_t));
+    dma_memcpy_blocking(l1_RowPtr, l2_RowPtr, (N_ROWS + 1) * sizeof(uint32_t));
+    dma_memcpy_blocking(l1_EllVal, l2_EllVal,
+                        ELL_WIDTH * N_ROWS * sizeof(int32_t));
+    dma_memcpy_blocking(l1_EllColIdx, l2_EllColIdx,
+                        ELL_WIDTH * N_ROWS * sizeof(uint32_t));
+    if (!REPLICATE_X) {
+      dma_memcpy_blocking(l1_X, l2_X, N_COLS * sizeof(int32_t));
+    }
+    printf("01: END INITIALIZATION\n");
+  }
+  mempool_barrier(num_cores);
+  if (core_id < NUM_PE) {
+    if (REPLICATE_X) {
+      mempool_spmv_replicate((uint32_t *)l2_X, (uint32_t *)l1_X, X_WORDS,
+                             NUM_PE);
+    }
+    mempool_spmv_partition(l1_RowPtr, N_ROWS, l1_RowSplit, NUM_PE);
+  }
+  mempool_barrier(num_cores);
+
+  /* COMPUTATION */
+
+#ifdef CSR
+  time_init = 0;
+  time_end = 0;
+  if (core_id < NUM_PE) {
+    time_init = mempool_get_timer();
+    mempool_start_benchmark();
+    mempool_csr_spmv_i32p(l1_Val, l1_ColIdx, l1_RowPtr, l1_RowSplit, l1_X,
+                          REPLICATE_X, l1_Y, NUM_PE);
+    mempool_stop_benchmark();
+    time_end = mempool_get_timer();
+  }
+  mempool_barrier(num_cores);
+  if (core_id == 0) {
+    printf("CSR SpMV\n");
+    print_performance(time_end - time_init);
+  }
+  mempool_check_i32(l1_Y, l2_Y, N_ROWS, 0, 0);
+  mempool_barrier(num_cores);
+#endif
+
+#ifdef ELL
+  // Clear the result of CSR, so that it cannot pass the check of ELL
+  for (uint32_t i = core_id; i < N_ROWS; i += num_cores) {
+    l1_Y[i] = 0;
+  }
+  mempool_barrier(num_cores);
+  time_init = 0;
+  time_end = 0;
+  if (core_id < NUM_PE) {
+    time_init = mempool_get_timer();
+    mempool_start_benchmark();
+    mempool_ell_spmv_i32p(l1_EllVal, l1_EllColIdx, N_ROWS, ELL_WIDTH, l1_X,
+                          REPLICATE_X, l1_Y, NUM_PE);
+    mempool_stop_benchmark();
+    time_end = mempool_get_timer();
+  }
+  mempool_barrier(num_cores);
+  if (core_id == 0) {
+    printf("ELLPACK SpMV\n");
+    print_performance(time_end - time_init);
+  }
+  mempool_check_i32(l1_Y, l2_Y, N_ROWS, 0, 0);
+  mempool_barrier(num_cores);
+#endif
+
+  return 0;
+}
@@ -9,6 +9,31 @@
 using namespace std;
 using namespace Halide;
 
+// Schedule and size of the test image, see the Makefile
+#ifndef SCHEDULE
+#define SCHEDULE 0
+#endif
+#ifndef M
+#define M 16
+#endif
+#ifndef N
+#define N 16
+#endif
+// Tile size, vector width and output rows per parallel task. The widths 2
+// and 4 match the lanes of the Xpulpimg SIMD instructions (v2s/v4s).
+#ifndef TILE_X
+#define TILE_X 16
+#endif
+#ifndef TILE_Y
+#define TILE_Y 8
+#endif
+#ifndef VECTOR
+#define VECTOR 4
+#endif
+#ifndef GRAIN
+#define GRAIN 1
+#endif
+
 int main(int argc, char **argv) {
   // Global consts
   uint32_t const KERNEL[3] = {1, 2, 1};
@@ -56,24 +81,58 @@ int main(int argc, char **argv) {
 
   convolution_x.update().unroll(r);
   convolution_y.update().unroll(r);
+
+#if SCHEDULE == 0
+  // Parallel rows, with the intermediates of each row in the tile
+  convolution.parallel(y);
+  // Compute the rows needed by each output row in the parallel loop, the
+  // intermediates are allocated by halide_malloc in the memory of the tile
+  convolution_y.compute_at(convolution, y).store_in(MemoryType::Heap);
+  convolution_x.compute_at(convolution, y).store_in(MemoryType::Heap);
+#elif SCHEDULE == 1
+  // Breadth first, each stage is computed in parallel over the whole image
   convolution.parallel(y);
+  convolution_y.compute_root().parallel(y);
+  convolution_y.update().parallel(y);
+  convolution_x.compute_root().parallel(y);
+  convolution_x.update().parallel(y);
+#elif SCHEDULE == 2
+  // Strips of GRAIN rows per task
+  Var yo("yo"), yi("yi");
+  convolution.split(y, yo, yi, GRAIN).parallel(yo).vectorize(x, VECTOR);
+  convolution_y.compute_at(convolution, yo).store_in(MemoryType::Heap);
+  convolution_y.vectorize(x, VECTOR).update().vectorize(x, VECTOR);
+  convolution_x.compute_at(convolution, yo).store_in(MemoryType::Heap);
+  convolution_x.vectorize(x, VECTOR).update().vectorize(x, VECTOR);
+#elif SCHEDULE == 3
+  // Tiles of TILE_X x TILE_Y outputs per task
+  Var xo("xo"), yo("yo"), xi("xi"), yi("yi"), t("t");
+  convolution.tile(x, y, xo, yo, xi, yi, TILE_X, TILE_Y)
+      .fuse(xo, yo, t)
+      .parallel(t)
+      .vectorize(xi, VECTOR);
+  convolution_y.compute_at(convolution, t).store_in(MemoryType::Heap);
+  convolution_y.vectorize(x, VECTOR).update().vectorize(x, VECTOR);
+  convolution_x.compute_at(convolution, t).store_in(MemoryType::Heap);
+  convolution_x.vectorize(x, VECTOR).update().vectorize(x, VECTOR);
+#else
+#error "Unknown schedule"
+#endif
 
   // Quickly test the pipeline
-  const uint32_t WIDTH = 16;
-  const uint32_t HEIGHT = 16;
-  Buffer<uint32_t> test_input(32, 32);
-  for (int y = 0; y < 32; y++) {
-    for (int x = 0; x < 32; x++) {
+  Buffer<uint32_t> test_input(M, N);
+  for (int y = 0; y < N; y++) {
+    for (int x = 0; x < M; x++) {
       test_input(x, y) = x + y & 0xff;
     }
   }
 
   Halide::ParamMap params;
   params.set(in, test_input);
-  params.set(width, (int32_t)32);
-  params.set(height, (int32_t)32);
+  params.set(width, (int32_t)M);
+  params.set(height, (int32_t)N);
   Halide::Buffer<uint32_t> output = convolution.realize(
-      {30, 30}, Halide::get_jit_target_from_environment(), params);
+      {M - 2, N - 2}, Halide::get_jit_target_from_environment(), params);
 
   for (int j = 0; j < test_input.height(); j++) {
     for (int i = 0; i < test_input.width(); i++) {
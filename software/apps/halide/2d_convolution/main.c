@@ -11,8 +11,13 @@
 #include <stdint.h>
 #include <string.h>
 
+// Image size, can be overridden by the Makefile
+#ifndef N
 #define N 16
+#endif
+#ifndef M
 #define M 16
+#endif
 #define KERNEL_N 3
 #define PADDING (KERNEL_N / 2)
 // #define VERBOSE
@@ -113,24 +118,33 @@ int halide_convolution(uint32_t core_id, uint32_t num_cores) {
 
   mempool_barrier(num_cores);
 
+  // Core 0 calls the Halide pipeline and dispatches its parallel loops to the
+  // other cores
+  int error = 0;
   mempool_start_benchmark();
-  // Call the Halide pipeline
-  int error = halide_pipeline((halide_buffer_t *)&halide_buffer_in, M, N,
-                              (halide_buffer_t *)&halide_buffer_out);
+  if (core_id == 0) {
+    error = halide_pipeline((halide_buffer_t *)&halide_buffer_in, M, N,
+                            (halide_buffer_t *)&halide_buffer_out);
+    halide_mempool_release();
+  } else {
+    halide_mempool_worker(core_id);
+  }
   mempool_stop_benchmark();
 
   mempool_barrier(num_cores);
 #ifdef VERBOSE
   // Print the result
-  printf("Convolution finished with exit code %d\n", error);
-  for (int y = 0; y < buffer_dim[1].extent - 2; ++y) {
-    for (int x = 0; x < buffer_dim[0].extent - 2; ++x) {
-      uint32_t val =
-          ((uint32_t *)halide_buffer_out
-               .host)[x * buffer_dim[0].stride + y * buffer_dim[1].stride];
-      printf("%3d ", val);
+  if (core_id == 0) {
+    printf("Convolution finished with exit code %d\n", error);
+    for (int y = 0; y < buffer_dim[1].extent - 2; ++y) {
+      for (int x = 0; x < buffer_dim[0].extent - 2; ++x) {
+        uint32_t val =
+            ((uint32_t *)halide_buffer_out
+                 .host)[x * buffer_dim[0].stride + y * buffer_dim[1].stride];
+        printf("%3d ", val);
+      }
+      printf("\n");
     }
-    printf("\n");
   }
 #endif
 
@@ -142,6 +156,8 @@ int main() {
   uint32_t num_cores = mempool_get_core_count();
   // Initialize barrier and synchronize
   mempool_barrier_init(core_id);
+  // Initialize the allocators used by the Halide runtime
+  halide_mempool_init(core_id);
 
   if (core_id == 0) {
 #ifdef VERBOSE
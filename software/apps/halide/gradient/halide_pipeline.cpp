@@ -5,6 +5,31 @@
 #include "Halide.h"
 #include <stdio.h>
 
+// Schedule and size of the test image, see the Makefile
+#ifndef SCHEDULE
+#define SCHEDULE 0
+#endif
+#ifndef WIDTH
+#define WIDTH 15
+#endif
+#ifndef HEIGHT
+#define HEIGHT 21
+#endif
+// Tile size, vector width and rows per parallel task. The widths 2 and 4
+// match the lanes of the Xpulpimg SIMD instructions (v2s/v4s).
+#ifndef TILE_X
+#define TILE_X 16
+#endif
+#ifndef TILE_Y
+#define TILE_Y 8
+#endif
+#ifndef VECTOR
+#define VECTOR 4
+#endif
+#ifndef GRAIN
+#define GRAIN 1
+#endif
+
 int main(int argc, char **argv) {
   // Input arguments
   Halide::Param<uint32_t> center_x;
@@ -22,12 +47,30 @@ int main(int argc, char **argv) {
   // Cast the result to uint_8
   gradient(x, y) = Halide::cast<uint8_t>(offset);
 
+#if SCHEDULE == 0
+  // Distribute the rows over the cores
+  gradient.parallel(y);
+#elif SCHEDULE == 1
+  // Strips of GRAIN rows per task
+  Halide::Var yo, yi;
+  gradient.split(y, yo, yi, GRAIN).parallel(yo).vectorize(x, VECTOR);
+#elif SCHEDULE == 2
+  // Tiles of TILE_X x TILE_Y pixels per task
+  Halide::Var xo, yo, xi, yi, t;
+  gradient.tile(x, y, xo, yo, xi, yi, TILE_X, TILE_Y)
+      .fuse(xo, yo, t)
+      .parallel(t)
+      .vectorize(xi, VECTOR);
+#else
+#error "Unknown schedule"
+#endif
+
   // Quickly test the pipeline
   Halide::ParamMap params;
   params.set(center_x, (uint32_t)7);
   params.set(center_y, (uint32_t)7);
   Halide::Buffer<uint8_t> output = gradient.realize(
-      {15, 21}, Halide::get_jit_target_from_environment(), params);
+      {WIDTH, HEIGHT}, Halide::get_jit_target_from_environment(), params);
 
   for (int j = 0; j < output.height(); j++) {
     for (int i = 0; i < output.width(); i++) {
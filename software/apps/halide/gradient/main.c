@@ -18,17 +18,35 @@
 #include <stdint.h>
 #include <string.h>
 
+// Image size, can be overridden by the Makefile
+#ifndef WIDTH
+#define WIDTH 15
+#endif
+#ifndef HEIGHT
+#define HEIGHT 21
+#endif
+
+uint8_t buffer[WIDTH * HEIGHT] __attribute__((section(".l1")));
+
 int main() {
-  if (mempool_get_core_id() == 0) {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+  // Initialize barrier and synchronize
+  mempool_barrier_init(core_id);
+  // Initialize the allocators used by the Halide runtime
+  halide_mempool_init(core_id);
+  mempool_barrier(num_cores);
+
+  if (core_id == 0) {
     // Specify a two-dimensional buffer
     halide_dimension_t buffer_dim[2];
     // Fill both dimensions' parameters
     buffer_dim[0].min = 0;
-    buffer_dim[0].extent = 15;
+    buffer_dim[0].extent = WIDTH;
     buffer_dim[0].stride = 1;
     buffer_dim[0].flags = 0;
     buffer_dim[1].min = 0;
-    buffer_dim[1].extent = 21;
+    buffer_dim[1].extent = HEIGHT;
     buffer_dim[1].stride = buffer_dim[0].extent;
     buffer_dim[1].flags = 0;
 
@@ -38,9 +56,6 @@ int main() {
     buffer_type.bits = 8;
     buffer_type.lanes = 1;
 
-    // Allocate the buffer and the structure to hold the buffer
-    uint8_t buffer[buffer_dim[0].extent * buffer_dim[1].extent];
-
     // Assign all parameters to the buffer structure
     halide_buffer_t output;
     output.device = 0;
@@ -58,10 +73,15 @@ int main() {
 
     // Call the Halide pipeline
     printf("Start calculation around x=%d, y=%d\n", center_x, center_y);
+    // The parallel loops are dispatched to the other cores
+    mempool_start_benchmark();
     int error = gradient(center_x, center_y, &output);
+    halide_mempool_release();
+    mempool_stop_benchmark();
 
     // Print the result
     printf("Gradient finished with exit code %d\n", error);
+#if WIDTH * HEIGHT <= 1024
     for (int y = 0; y < buffer_dim[1].extent; ++y) {
       for (int x = 0; x < buffer_dim[0].extent; ++x) {
         uint8_t val =
@@ -70,10 +90,15 @@ int main() {
       }
       printf("\n");
     }
-
-    wake_up((uint32_t)-1);
+#endif
+  } else {
+    mempool_start_benchmark();
+    halide_mempool_worker(core_id);
+    mempool_stop_benchmark();
   }
-  mempool_wfi();
+
+  // wait until all cores have finished
+  mempool_barrier(num_cores);
 
   return 0;
 }
@@ -7,6 +7,34 @@
 
 using namespace Halide;
 
+// Schedule and size of the test matrices, see the Makefile
+#ifndef SCHEDULE
+#define SCHEDULE 0
+#endif
+#ifndef matrix_M
+#define matrix_M 16
+#endif
+#ifndef matrix_N
+#define matrix_N 16
+#endif
+#ifndef matrix_P
+#define matrix_P 16
+#endif
+// Tile size, vector width and rows per parallel task. The widths 2 and 4
+// match the lanes of the Xpulpimg SIMD instructions (v2s/v4s).
+#ifndef TILE_X
+#define TILE_X 8
+#endif
+#ifndef TILE_Y
+#define TILE_Y 8
+#endif
+#ifndef VECTOR
+#define VECTOR 4
+#endif
+#ifndef GRAIN
+#define GRAIN 1
+#endif
+
 int main(int argc, char **argv) {
   Halide::Param<uint32_t> mat_size;
 
@@ -22,11 +50,33 @@ int main(int argc, char **argv) {
   RDom k(0, A.width());
   RVar ki;
 
-  matmul(x, y) = sum(A(k, y) * B(x, k));
+  Func prod("prod");
+  prod(x, y) += A(k, y) * B(x, k);
+  matmul(x, y) = prod(x, y);
 
-  Var xy;
+  Var xy, t;
 
+#if SCHEDULE == 0
+  // One output element per task
   matmul.fuse(x, y, xy).parallel(xy);
+  prod.compute_at(matmul, xy);
+#elif SCHEDULE == 1
+  // Strips of GRAIN rows per task, accumulated in the tile
+  matmul.split(y, yo, yi, GRAIN).parallel(yo).vectorize(x, VECTOR);
+  prod.compute_at(matmul, yo).store_in(MemoryType::Heap);
+  prod.vectorize(x, VECTOR).update().vectorize(x, VECTOR);
+#elif SCHEDULE == 2
+  // Tiles of TILE_X x TILE_Y outputs per task, accumulated in the tile with
+  // the reduction outermost
+  matmul.tile(x, y, xo, yo, xi, yi, TILE_X, TILE_Y)
+      .fuse(xo, yo, t)
+      .parallel(t)
+      .vectorize(xi, VECTOR);
+  prod.compute_at(matmul, t).store_in(MemoryType::Heap);
+  prod.vectorize(x, VECTOR).update().reorder(x, y, k).vectorize(x, VECTOR);
+#else
+#error "Unknown schedule"
+#endif
 
   /*
     matmul .unroll(x) .unroll(y);
@@ -58,9 +108,9 @@ int main(int argc, char **argv) {
   */
 
   // Quickly test the pipeline
-  const uint32_t M = 16;
-  const uint32_t N = 16;
-  const uint32_t P = 16;
+  const uint32_t M = matrix_M;
+  const uint32_t N = matrix_N;
+  const uint32_t P = matrix_P;
   Buffer<int32_t> matrix_a(M, N);
   Buffer<int32_t> matrix_b(N, P);
   for (int i = 0; i < M; i++) {
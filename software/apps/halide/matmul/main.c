@@ -13,9 +13,16 @@
 
 // Define Matrix dimensions:
 // C = AB with A=[MxN], B=[NxP], C=[MxP]
+// The dimensions can be overridden by the Makefile
+#ifndef matrix_M
 #define matrix_M 16
+#endif
+#ifndef matrix_N
 #define matrix_N 16
+#endif
+#ifndef matrix_P
 #define matrix_P 16
+#endif
 // #define VERBOSE
 
 int32_t matrix_a[matrix_M * matrix_N] __attribute__((section(".l1")));
@@ -156,11 +163,18 @@ int halide_matmul(uint32_t core_id, uint32_t num_cores) {
 
   mempool_barrier(num_cores);
 
+  // Core 0 calls the Halide pipeline and dispatches its parallel loops to the
+  // other cores
+  int error = 0;
   mempool_start_benchmark();
-  // Call the Halide pipeline
-  int error = halide_pipeline((halide_buffer_t *)&halide_buffer_matrix_a,
-                              (halide_buffer_t *)&halide_buffer_matrix_b,
-                              (halide_buffer_t *)&halide_buffer_matrix_c);
+  if (core_id == 0) {
+    error = halide_pipeline((halide_buffer_t *)&halide_buffer_matrix_a,
+                            (halide_buffer_t *)&halide_buffer_matrix_b,
+                            (halide_buffer_t *)&halide_buffer_matrix_c);
+    halide_mempool_release();
+  } else {
+    halide_mempool_worker(core_id);
+  }
   mempool_stop_benchmark();
 
   mempool_barrier(num_cores);
@@ -188,6 +202,8 @@ int main() {
   uint32_t num_cores = mempool_get_core_count();
   // Initialize barrier and synchronize
   mempool_barrier_init(core_id);
+  // Initialize the allocators used by the Halide runtime
+  halide_mempool_init(core_id);
 
   if (core_id == 0) {
     error = 0;
@@ -0,0 +1,126 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+#include "systolic/conv2d.h"
+
+// Dimensions of image and kernel
+#define DIM_M 34
+#define DIM_N 34
+#define DIM_K 3
+
+systolic_conv2d_t conv;
+
+systolic_pe_fn_t pe_fn[SYSTOLIC_NUM_ROLES] = {
+    systolic_conv2d_pe, systolic_conv2d_pe, systolic_conv2d_pe,
+    systolic_conv2d_pe};
+
+void generate_gradient_matrix(int32_t **matrix, uint32_t num_rows,
+                              uint32_t num_cols) {
+  int32_t *new_matrix =
+      (int32_t *)simple_malloc(num_rows * num_cols * sizeof(int32_t));
+  for (uint32_t y = 0; y < num_rows; ++y) {
+    for (uint32_t x = 0; x < num_cols; ++x) {
+      new_matrix[y * num_cols + x] = (int32_t)(y + x);
+    }
+  }
+  *matrix = new_matrix;
+}
+
+uint32_t verify_conv2d(systolic_conv2d_t const *conv) {
+  uint32_t const k = conv->kernel_size;
+  uint32_t const num_rows_O = conv->num_rows - k + 1;
+  uint32_t const num_cols_O = conv->num_cols - k + 1;
+  uint32_t errors = 0;
+  for (uint32_t y = 0; y < num_rows_O; ++y) {
+    for (uint32_t x = 0; x < num_cols_O; ++x) {
+      int32_t sum = 0;
+      for (uint32_t i = 0; i < k; ++i) {
+        for (uint32_t j = 0; j < k; ++j) {
+          sum += conv->weights[i * k + j] *
+                 conv->image[(y + i) * conv->num_cols + x + j];
+        }
+      }
+      if (conv->output[y * num_cols_O + x] != sum) {
+        ++errors;
+      }
+    }
+  }
+  return errors;
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+
+  // Initialize synchronization variables
+  mempool_barrier_init(core_id);
+
+  // Initialization
+  mempool_init(core_id);
+
+  // Setup
+  if (core_id == 0) {
+    printf("> Initialize\n");
+
+    // Initialize systolic array
+    systolic_conv2d_init(DIM_K);
+
+    // Create image, kernel and output
+    int32_t *image;
+    int32_t *weights;
+    generate_gradient_matrix(&image, DIM_M, DIM_N);
+    generate_gradient_matrix(&weights, DIM_K, DIM_K);
+    conv.image = image;
+    conv.weights = weights;
+    conv.output = (int32_t *)simple_malloc((DIM_M - DIM_K + 1) *
+                                           (DIM_N - DIM_K + 1) *
+                                           sizeof(int32_t));
+    conv.num_rows = DIM_M;
+    conv.num_cols = DIM_N;
+    conv.kernel_size = DIM_K;
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  if (core_id == 0) {
+    // Start benchmark
+    printf("> Start\n");
+    mempool_start_benchmark();
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  systolic_run(pe_fn, &conv);
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  // Print out benchmark
+  if (core_id == 0) {
+    // Stop benchmark
+    mempool_stop_benchmark();
+    printf("> End\n");
+
+    printf("Errors: %d\n", verify_conv2d(&conv));
+
+    // Print out benchmark results
+    // systolic_benchmark_print();
+  }
+
+  // wait until all cores have finished
+  mempool_barrier(num_cores);
+  return 0;
+}
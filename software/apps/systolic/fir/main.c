@@ -0,0 +1,118 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+#include "systolic/fir.h"
+
+// Number of samples, taps and PEs (NUM_TAPS must be a multiple of NUM_PE)
+#define NUM_SAMPLES 512
+#ifndef NUM_TAPS
+#define NUM_TAPS 512
+#endif
+#define NUM_PE NUM_CORES
+
+#if NUM_TAPS < NUM_PE || NUM_TAPS > NUM_PE * SYSTOLIC_FIR_MAX_TAPS
+#error NUM_TAPS / NUM_PE must be between 1 and SYSTOLIC_FIR_MAX_TAPS
+#elif NUM_TAPS % NUM_PE != 0
+#error NUM_TAPS must be a multiple of NUM_PE
+#endif
+
+systolic_fir_t fir;
+
+systolic_pe_fn_t pe_fn[SYSTOLIC_NUM_ROLES] = {systolic_fir_pe, systolic_fir_pe,
+                                              NULL, NULL};
+
+void generate_vector(int32_t **vector, uint32_t length, int32_t scale) {
+  int32_t *new_vector = (int32_t *)simple_malloc(length * sizeof(int32_t));
+  for (uint32_t i = 0; i < length; ++i) {
+    new_vector[i] = (int32_t)((i * scale) % 17) - 8;
+  }
+  *vector = new_vector;
+}
+
+uint32_t verify_fir(systolic_fir_t const *fir) {
+  uint32_t errors = 0;
+  for (uint32_t n = 0; n < fir->num_samples; ++n) {
+    int32_t sum = 0;
+    for (uint32_t l = 0; l < fir->num_taps && l <= n; ++l) {
+      sum += fir->taps[l] * fir->input[n - l];
+    }
+    if (fir->output[n] != sum) {
+      ++errors;
+    }
+  }
+  return errors;
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+
+  // Initialize synchronization variables
+  mempool_barrier_init(core_id);
+
+  // Initialization
+  mempool_init(core_id);
+
+  // Setup
+  if (core_id == 0) {
+    printf("> Initialize\n");
+
+    // Initialize systolic array
+    systolic_fir_init(NUM_PE);
+
+    // Create input, taps and output
+    int32_t *input;
+    int32_t *taps;
+    generate_vector(&input, NUM_SAMPLES, 7);
+    generate_vector(&taps, NUM_TAPS, 3);
+    fir.input = input;
+    fir.taps = taps;
+    fir.output = (int32_t *)simple_malloc(NUM_SAMPLES * sizeof(int32_t));
+    fir.num_samples = NUM_SAMPLES;
+    fir.num_taps = NUM_TAPS;
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  if (core_id == 0) {
+    // Start benchmark
+    printf("> Start\n");
+    mempool_start_benchmark();
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  systolic_run(pe_fn, &fir);
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  // Print out benchmark
+  if (core_id == 0) {
+    // Stop benchmark
+    mempool_stop_benchmark();
+    printf("> End\n");
+
+    printf("Errors: %d\n", verify_fir(&fir));
+
+    // Print out benchmark results
+    // systolic_benchmark_print();
+  }
+
+  // wait until all cores have finished
+  mempool_barrier(num_cores);
+  return 0;
+}
@@ -26,6 +26,8 @@ int32_t *matrix_B;
 
 uint32_t rep_count;
 
+mempool_timer_t cycles;
+
 systolic_matrix_t *syst_matrix_A;
 systolic_matrix_t *syst_matrix_B;
 systolic_matrix_t *syst_matrix_C;
@@ -125,6 +127,7 @@ int main() {
     // Start benchmark
     printf("> Start\n");
     mempool_start_benchmark();
+    cycles = mempool_get_timer();
   }
 
   // Wait for all cores
@@ -161,7 +164,10 @@ int main() {
   if (core_id == 0) {
     // Stop benchmark
     mempool_stop_benchmark();
+    cycles = mempool_get_timer() - cycles;
     printf("> End\n");
+    printf("Cycles: %d, MACs per 1000 cycles: %d\n", cycles,
+           (DIM_M * DIM_N * DIM_P * 1000) / cycles);
 
     // Print out systolic matrix C
     // printf("> Print Systolic Matrix C\n");
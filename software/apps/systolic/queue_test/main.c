@@ -16,10 +16,17 @@
 
 #define QUEUE_ENTRIES 8
 
+// Throughput test: number of words and burst length of push_n/pop_n
+#define NUM_TRANSFERS 1024
+#define QUEUE_BURST 4
+
 queue_t *queue = 0;
 
 uint32_t producer_cnt;
 uint32_t consumer_cnt;
+uint32_t single_cycles;
+uint32_t burst_cycles;
+uint32_t errors;
 
 int main() {
   uint32_t core_id = mempool_get_core_id();
@@ -74,10 +81,51 @@ int main() {
   // Wait for all cores
   mempool_barrier(num_cores);
 
+  // Throughput of single and burst transfers
+  if (core_id == 0) {
+    int32_t data[QUEUE_BURST];
+    for (uint32_t i = 0; i < NUM_TRANSFERS; ++i) {
+      data[0] = (int32_t)i;
+      blocking_queue_push(queue, data);
+    }
+    for (uint32_t i = 0; i < NUM_TRANSFERS; i += QUEUE_BURST) {
+      for (uint32_t j = 0; j < QUEUE_BURST; ++j) {
+        data[j] = (int32_t)(i + j);
+      }
+      blocking_queue_push_n(queue, data, QUEUE_BURST);
+    }
+  }
+  if (core_id == 1) {
+    int32_t read_data[QUEUE_BURST];
+    uint32_t err = 0;
+    mempool_timer_t start = mempool_get_timer();
+    for (uint32_t i = 0; i < NUM_TRANSFERS; ++i) {
+      blocking_queue_pop(queue, read_data);
+      err += (read_data[0] != (int32_t)i);
+    }
+    mempool_timer_t mid = mempool_get_timer();
+    for (uint32_t i = 0; i < NUM_TRANSFERS; i += QUEUE_BURST) {
+      blocking_queue_pop_n(queue, read_data, QUEUE_BURST);
+      for (uint32_t j = 0; j < QUEUE_BURST; ++j) {
+        err += (read_data[j] != (int32_t)(i + j));
+      }
+    }
+    mempool_timer_t end = mempool_get_timer();
+    single_cycles = mid - start;
+    burst_cycles = end - mid;
+    errors = err;
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
   // Destroy queue and print out counters
   if (core_id == 0) {
     queue_destroy(queue);
     printf("Stalls: %d/%d\n", producer_cnt, consumer_cnt);
+    printf("Cycles for %d words: single %d, burst of %d %d\n", NUM_TRANSFERS,
+           single_cycles, QUEUE_BURST, burst_cycles);
+    printf("Errors: %d\n", errors);
   }
 
   // wait until all cores have finished
@@ -0,0 +1,141 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+#include <stdint.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "encoding.h"
+#include "printf.h"
+#include "runtime.h"
+#include "synchronization.h"
+#include "systolic/smith_waterman.h"
+
+// Length of the sequences and number of PEs
+#define LEN_A 512
+#define LEN_B 256
+#define NUM_PE NUM_CORES
+
+systolic_sw_t sw;
+
+systolic_pe_fn_t pe_fn[SYSTOLIC_NUM_ROLES] = {systolic_sw_pe, systolic_sw_pe,
+                                              NULL, NULL};
+
+// Pseudo-random sequence of nucleotides (0 to 3)
+void generate_sequence(int32_t **sequence, uint32_t length, uint32_t seed) {
+  int32_t *new_sequence = (int32_t *)simple_malloc(length * sizeof(int32_t));
+  for (uint32_t i = 0; i < length; ++i) {
+    seed = seed * 1103515245 + 12345;
+    new_sequence[i] = (int32_t)((seed >> 16) & 0x3);
+  }
+  *sequence = new_sequence;
+}
+
+int32_t reference_sw(systolic_sw_t const *sw) {
+  // Single row of the score matrix
+  int32_t *row = (int32_t *)simple_malloc((sw->len_b + 1) * sizeof(int32_t));
+  int32_t max_score = 0;
+  for (uint32_t j = 0; j <= sw->len_b; ++j) {
+    row[j] = 0;
+  }
+  for (uint32_t i = 1; i <= sw->len_a; ++i) {
+    int32_t diag = 0;
+    for (uint32_t j = 1; j <= sw->len_b; ++j) {
+      int32_t score = diag;
+      if (sw->seq_a[i - 1] == sw->seq_b[j - 1]) {
+        score += SYSTOLIC_SW_MATCH;
+      } else {
+        score += SYSTOLIC_SW_MISMATCH;
+      }
+      if (row[j] - SYSTOLIC_SW_GAP > score) {
+        score = row[j] - SYSTOLIC_SW_GAP;
+      }
+      if (row[j - 1] - SYSTOLIC_SW_GAP > score) {
+        score = row[j - 1] - SYSTOLIC_SW_GAP;
+      }
+      if (score < 0) {
+        score = 0;
+      }
+      if (score > max_score) {
+        max_score = score;
+      }
+      diag = row[j];
+      row[j] = score;
+    }
+  }
+  simple_free(row);
+  return max_score;
+}
+
+int main() {
+  uint32_t core_id = mempool_get_core_id();
+  uint32_t num_cores = mempool_get_core_count();
+
+  // Initialize synchronization variables
+  mempool_barrier_init(core_id);
+
+  // Initialization
+  mempool_init(core_id);
+
+  // Setup
+  if (core_id == 0) {
+    printf("> Initialize\n");
+
+    // Create sequences
+    int32_t *seq_a;
+    int32_t *seq_b;
+    generate_sequence(&seq_a, LEN_A, 1);
+    generate_sequence(&seq_b, LEN_B, 2);
+    sw.seq_a = seq_a;
+    sw.seq_b = seq_b;
+    sw.len_a = LEN_A;
+    sw.len_b = LEN_B;
+    sw.max_score = (int32_t *)simple_malloc(NUM_PE * sizeof(int32_t));
+
+    // Initialize systolic array
+    systolic_sw_init(&sw, NUM_PE);
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  if (core_id == 0) {
+    // Start benchmark
+    printf("> Start\n");
+    mempool_start_benchmark();
+  }
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  systolic_run(pe_fn, &sw);
+
+  // Wait for all cores
+  mempool_barrier(num_cores);
+
+  // Print out benchmark
+  if (core_id == 0) {
+    // Stop benchmark
+    mempool_stop_benchmark();
+    printf("> End\n");
+
+    int32_t score = 0;
+    for (uint32_t p = 0; p < NUM_PE; ++p) {
+      if (sw.max_score[p] > score) {
+        score = sw.max_score[p];
+      }
+    }
+    int32_t ref_score = reference_sw(&sw);
+    printf("Score: %d, reference: %d\n", score, ref_score);
+
+    // Print out benchmark results
+    // systolic_benchmark_print();
+  }
+
+  // wait until all cores have finished
+  mempool_barrier(num_cores);
+  return 0;
+}
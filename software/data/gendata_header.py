@@ -79,7 +79,7 @@ def print_array(arr, typ, name):
             count += 1
             if count % 4 == 0:
                 output_string += '\n'
-        output_string = output_string[:-3]
+        output_string = output_string.rstrip(', \n')
         output_string += "};\n\n"
     else:
         output_string += attr
@@ -168,30 +168,50 @@ if __name__ == '__main__':
         "axpy_i32": {"func": datalib.generate_iaxpy},
         "axpy_f16": {"func": datalib.generate_faxpy},
         "axpy_f32": {"func": datalib.generate_faxpy},
+        "cfft_mixedradix_f32": {"func": datalib.generate_fcfft_mixedradix},
         "cfft_radix2_q16": {"func": datalib.generate_cfft_q16},
         "cfft_radix4_f16": {"func": datalib.generate_fcfft},
         "cfft_radix4_q16": {"func": datalib.generate_cfft_q16},
         "chest_f16": {"func": datalib.generate_fchest},
         "chest_q16": {"func": datalib.generate_qchest},
+        "cholesky_blocked_f16": {"func": datalib.generate_fccholesky_blocked},
         "cholesky_f16": {"func": datalib.generate_fccholesky},
+        "cholesky_f32": {"func": datalib.generate_fccholesky},
         "cholesky_q16": {"func": datalib.generate_qccholesky},
         "cholesky_q32": {"func": datalib.generate_qcholesky},
+        "cinverse_f16": {"func": datalib.generate_fcinverse},
+        "cinverse_f32": {"func": datalib.generate_fcinverse},
         "cmatmul_f16": {"func": datalib.generate_fcmatmul},
         "cmatmul_q16": {"func": datalib.generate_qcmatmul},
+        "conv2d_fft_f32": {"func": datalib.generate_fconv2d_fft},
         "dotp_f16": {"func": datalib.generate_fdotp},
         "dotp_f32": {"func": datalib.generate_fdotp},
         "dotp_i32": {"func": datalib.generate_idotp},
+        "fir_f16": {"func": datalib.generate_fir},
+        "fir_q16": {"func": datalib.generate_fir},
+        "histogram_i16": {"func": datalib.generate_histogram},
+        "histogram_i8": {"func": datalib.generate_histogram},
         "matmul_f16": {"func": datalib.generate_fmatmul},
-        "matmul_f8": {"func": datalib.generate_fmatmul},
+        "matmul_f8": {"func": datalib.generate_fmatmul_f8},
         "matmul_f32": {"func": datalib.generate_fmatmul},
         "matmul_i32": {"func": datalib.generate_imatmul},
         "matmul_i16": {"func": datalib.generate_imatmul},
         "matmul_i8": {"func": datalib.generate_imatmul},
+        "matmul_tiled_f16": {"func": datalib.generate_matmul_tiled},
+        "matmul_tiled_f32": {"func": datalib.generate_matmul_tiled},
+        "matmul_tiled_i16": {"func": datalib.generate_matmul_tiled},
+        "matmul_tiled_i32": {"func": datalib.generate_matmul_tiled},
+        "matmul_tiled_i8": {"func": datalib.generate_matmul_tiled},
         "mimo_mmse_q16": {"func": datalib.generate_qmmse},
         "mimo_mmse_f16": {"func": datalib.generate_fmmse},
         "mimo_mmse_f32": {"func": datalib.generate_fmmse},
         "mimo_mmse_f8": {"func": datalib.generate_fmmse},
         "ofdm_f16": {"func": datalib.generate_fofdm},
+        "pusch_f16": {"func": datalib.generate_fpusch},
+        "sort_i32": {"func": datalib.generate_sort},
+        "spmv_f16": {"func": datalib.generate_spmv},
+        "spmv_f32": {"func": datalib.generate_spmv},
+        "spmv_i32": {"func": datalib.generate_spmv},
         "fence": {"func": datalib.generate_iarray},
         "memcpy": {"func": datalib.generate_iarray},
     }
@@ -121,6 +121,123 @@ def generate_fcfft(my_type=np.float32, defines={}):
     return [src, dst, twiddles, bitrever], defines
 
 
+def mixedradix_factors(N):
+    # Radix-5 and radix-3 stages first, then as many radix-8 as possible
+    radices = []
+    for r in [5, 3, 8, 4, 2]:
+        while N % r == 0:
+            radices.append(r)
+            N //= r
+    if N != 1:
+        raise Exception("ERROR: Length is not a product of 2, 3 and 5!!!")
+    return radices
+
+
+def mixedradix_tables(N, radices, my_type=np.float32):
+    # Twiddles of the decimation in frequency stages: at the stage of radix r
+    # and length L the butterfly j has the twiddles W_N^(p * j * N / L)
+    twiddles = []
+    L = N
+    for r in radices:
+        m = L // r
+        for j in range(m):
+            for p in range(1, r):
+                w = np.exp(-2.j * np.pi * p * j * (N // L) / N)
+                twiddles += [w.real, w.imag]
+        L = m
+    twiddles = np.array(twiddles).astype(my_type)
+    # Digit reversal, element i of the last stage goes to digitrev[i]
+    digitrev = np.zeros(N, dtype=np.int32)
+    for i in range(N):
+        k, weight, L, rem = 0, 1, N, i
+        for r in radices:
+            L //= r
+            k += (rem // L) * weight
+            rem = rem % L
+            weight *= r
+        digitrev[i] = k
+    return twiddles, digitrev
+
+
+def generate_fcfft_mixedradix(my_type=np.float32, defines={}):
+
+    N_CSAMPLES = defines['N_CSAMPLES']
+    src = np.random.normal(0, 1, N_CSAMPLES) + \
+        1.j * np.random.normal(0, 1, N_CSAMPLES)
+    dst = np.fft.fft(src)
+    src = np.column_stack((src.real, src.imag)).astype(my_type).flatten()
+    dst = np.column_stack((dst.real, dst.imag)).astype(my_type).flatten()
+
+    radices = mixedradix_factors(N_CSAMPLES)
+    twiddles, digitrev = mixedradix_tables(N_CSAMPLES, radices, my_type)
+
+    defines['N_STAGES'] = len(radices)
+    defines['N_TWIDDLES'] = len(twiddles) // 2
+    defines['TOLERANCE'] = 0.001 * np.max(np.abs(dst))
+
+    return [src, dst, twiddles, np.array(radices), digitrev], defines
+
+
+def generate_fconv2d_fft(my_type=np.float32, defines={}):
+
+    nRows = defines['IMG_ROWS']
+    nCols = defines['IMG_COLS']
+    K = defines['K_SIZE']
+    B = K // 2
+
+    img = np.random.randint(0, 256, (nRows, nCols))
+    ker = np.random.randint(1, 4, (K, K))
+
+    # Circular correlation, as conv2d_parallel on the inner pixels before it
+    # divides by the sum of the weights
+    def correlate(k):
+        b = k.shape[0] // 2
+        res = np.zeros((nRows, nCols), dtype=np.int64)
+        for m in range(-b, k.shape[0] - b):
+            for n in range(-b, k.shape[1] - b):
+                shifted = np.roll(img, (-m, -n), axis=(0, 1))
+                res += k[m + b, n + b] * shifted
+        return res
+
+    out = correlate(ker).astype(np.float64)
+    # Direct convolutions with the central k x k filters, k = 3, 5, ..., K,
+    # on the inner pixels, zero elsewhere
+    out_int = []
+    for k in range(3, K + 1, 2):
+        b = k // 2
+        sub = ker[B - b:B + b + 1, B - b:B + b + 1]
+        res = np.zeros((nRows, nCols), dtype=np.int64)
+        inner = correlate(sub) // np.sum(sub)
+        res[b:nRows - b, b:nCols - b] = inner[b:nRows - b, b:nCols - b]
+        out_int.append(res.flatten())
+    # Filter flipped and wrapped, so that the FFT convolution is a correlation
+    ker_pad = np.zeros((nRows, nCols))
+    for m in range(-B, K - B):
+        for n in range(-B, K - B):
+            ker_pad[(-m) % nRows, (-n) % nCols] = ker[m + B, n + B]
+
+    def cplx(x):
+        x = x.flatten()
+        x = np.column_stack((x, np.zeros(x.size)))
+        return x.astype(my_type).flatten()
+
+    radices_row = mixedradix_factors(nCols)
+    radices_col = mixedradix_factors(nRows)
+    twiddles_row, digitrev_row = mixedradix_tables(nCols, radices_row, my_type)
+    twiddles_col, digitrev_col = mixedradix_tables(nRows, radices_col, my_type)
+
+    defines['N_STAGES_ROW'] = len(radices_row)
+    defines['N_TWIDDLES_ROW'] = len(twiddles_row) // 2
+    defines['N_STAGES_COL'] = len(radices_col)
+    defines['N_TWIDDLES_COL'] = len(twiddles_col) // 2
+    defines['TOLERANCE'] = 0.001 * np.max(np.abs(out))
+
+    return [cplx(img), cplx(ker_pad), cplx(out),
+            twiddles_row, np.array(radices_row), digitrev_row,
+            twiddles_col, np.array(radices_col), digitrev_col,
+            img.flatten(), ker.flatten(), np.concatenate(out_int)], defines
+
+
 def generate_fchest(my_type=np.float32, defines={}, division=False):
 
     nb_tx = defines['N_TX']
@@ -174,6 +291,8 @@ def generate_fccholesky(my_type=np.float32, defines={}):
 
     vector_G = []
     vector_L = []
+    vector_y = []
+    vector_x = []
     for k in range(n_samples):
         # Create hermitian matrix
         H = np.random.rand(n_matrix, n_matrix) + 1.j * \
@@ -183,18 +302,96 @@ def generate_fccholesky(my_type=np.float32, defines={}):
         G = np.matmul(H, np.asmatrix(H).H)
         # Cholesky decomposition
         L = np.linalg.cholesky(G)
+        # Linear system solution
+        y = np.random.rand(n_matrix) + 1.j * np.random.rand(n_matrix)
+        x = solve_triangular(L, y, lower=True)
+        x = solve_triangular(np.asmatrix(L).H, x)
         # Reshape
         G = np.reshape(np.asarray(G), (n_matrix * n_matrix), order='C')
         L = np.reshape(np.asarray(L), (n_matrix * n_matrix), order='C')
         G = np.column_stack((G.real, G.imag)).astype(my_type).flatten()
         L = np.column_stack((L.real, L.imag)).astype(my_type).flatten()
+        y = np.column_stack((y.real, y.imag)).astype(my_type).flatten()
+        x = np.column_stack((x.real, x.imag)).astype(my_type).flatten()
         # Output vectors
         vector_G.append(G)
         vector_L.append(L)
+        vector_y.append(y)
+        vector_x.append(x)
 
     vector_G = np.concatenate(vector_G, axis=0)
     vector_L = np.concatenate(vector_L, axis=0)
-    return [vector_G, vector_L], defines
+    vector_y = np.concatenate(vector_y, axis=0)
+    vector_x = np.concatenate(vector_x, axis=0)
+    return [vector_G, vector_L, vector_y, vector_x], defines
+
+
+def generate_fccholesky_blocked(my_type=np.float16, defines={}):
+
+    n_matrix = defines['matrix_N']
+    # G = H H^H with a zero-mean H of 4 n columns, its eigenvalues are within
+    # [0.25, 2.25], so that the decomposition and the solve keep the accuracy
+    # of 16b floats also for large matrices
+    n_cols = 4 * n_matrix
+    H = (np.random.rand(n_matrix, n_cols) - 0.5) + 1.j * \
+        (np.random.rand(n_matrix, n_cols) - 0.5)
+    H = H * np.sqrt(6 / n_cols)
+    G = np.matmul(H, np.asmatrix(H).H)
+    L = np.linalg.cholesky(G)
+    y = np.random.rand(n_matrix) + 1.j * np.random.rand(n_matrix)
+    x = solve_triangular(L, y, lower=True)
+    x = solve_triangular(np.asmatrix(L).H, x)
+
+    G = np.reshape(np.asarray(G), (n_matrix * n_matrix), order='C')
+    L = np.reshape(np.asarray(L), (n_matrix * n_matrix), order='C')
+    G = np.column_stack((G.real, G.imag)).astype(my_type).flatten()
+    L = np.column_stack((L.real, L.imag)).astype(my_type).flatten()
+    y = np.column_stack((y.real, y.imag)).astype(my_type).flatten()
+    x = np.column_stack((x.real, x.imag)).astype(my_type).flatten()
+    return [G, L, y, x], defines
+
+
+def generate_fcinverse(my_type=np.float32, defines={}):
+
+    n_tx = defines['N_TX']
+    n_rhs = defines['N_RHS']
+    n_itr = defines['N_ITR']
+
+    vector_G = []
+    vector_B = []
+    vector_Ginv = []
+    vector_X = []
+    for k in range(n_itr):
+        # Regularized Gram matrix of the channel of a precoder
+        H = np.random.rand(n_tx, n_tx) + 1.j * np.random.rand(n_tx, n_tx)
+        G = np.matmul(H, np.asmatrix(H).H) + n_tx * np.eye(n_tx)
+        B = np.random.rand(n_tx, n_rhs) + 1.j * np.random.rand(n_tx, n_rhs)
+        # Inverse and multi-RHS solution through the Cholesky factor
+        L = np.linalg.cholesky(G)
+        Linv = solve_triangular(L, np.eye(n_tx), lower=True)
+        Ginv = np.matmul(np.asmatrix(Linv).H, Linv)
+        X = solve_triangular(L, B, lower=True)
+        X = solve_triangular(np.asmatrix(L).H, X)
+        # Reshape
+        G = np.reshape(np.asarray(G), (n_tx * n_tx), order='C')
+        B = np.reshape(np.asarray(B), (n_tx * n_rhs), order='C')
+        Ginv = np.reshape(np.asarray(Ginv), (n_tx * n_tx), order='C')
+        X = np.reshape(np.asarray(X), (n_tx * n_rhs), order='C')
+        G = np.column_stack((G.real, G.imag)).astype(my_type).flatten()
+        B = np.column_stack((B.real, B.imag)).astype(my_type).flatten()
+        Ginv = np.column_stack((Ginv.real, Ginv.imag)).astype(my_type).flatten()
+        X = np.column_stack((X.real, X.imag)).astype(my_type).flatten()
+        # Output vectors
+        vector_G.append(G)
+        vector_B.append(B)
+        vector_Ginv.append(Ginv)
+        vector_X.append(X)
+
+    vector_G = np.concatenate(vector_G, axis=0)
+    vector_B = np.concatenate(vector_B, axis=0)
+    vector_Ginv = np.concatenate(vector_Ginv, axis=0)
+    vector_X = np.concatenate(vector_X, axis=0)
+    return [vector_G, vector_B, vector_Ginv, vector_X], defines
 
 
 def generate_fcmatmul(my_type=np.float32, defines={}):
@@ -237,6 +434,33 @@ def generate_fmatmul(my_type=np.float32, defines={}):
     return [A, B, C], defines
 
 
+def generate_fmatmul_f8(my_type=np.float16, defines={}):
+
+    # Create matrix
+    matrix_M = defines['matrix_M']
+    matrix_N = defines['matrix_N']
+    matrix_P = defines['matrix_P']
+    A = (np.random.rand(matrix_M, matrix_N) - 0.5).astype(np.float16)
+    B = (np.random.rand(matrix_N, matrix_P) - 0.5).astype(np.float16)
+
+    # Round the inputs to e5m2, the 8 MSBs of the f16 (round to nearest even)
+    def to_e5m2(X):
+        h = X.view(np.uint16).astype(np.uint32)
+        h = (h + 0x7F + ((h >> 8) & 1)) & 0xFF00
+        return h.astype(np.uint16).view(np.float16)
+
+    A = to_e5m2(A)
+    B = to_e5m2(B)
+    C = np.matmul(A.astype(np.float32), B.astype(np.float32))
+
+    A = np.reshape(A, (matrix_M * matrix_N), order='C').astype(my_type)
+    B = np.reshape(B, (matrix_N * matrix_P), order='C').astype(my_type)
+    C = np.reshape(C, (matrix_M * matrix_P), order='C').astype(my_type)
+
+    # The result is also checked rounded to e5m2
+    return [A, B, C, C], defines
+
+
 def generate_fmmse(my_type=np.float16, defines={}):
 
     N_tx = defines['N_TX']
@@ -314,6 +538,81 @@ def generate_fofdm(my_type=np.float32, defines={}):
     return [pFFT_src, pBF_coef, pBF_dst, twiddles, bitrever], defines
 
 
+def generate_fpusch(my_type=np.float16, defines={}):
+
+    N_sc = defines['N_SC']
+    N_rx = defines['N_RX']
+    N_tx = defines['N_TX']
+    N_slots = defines['N_SLOTS']
+
+    def quantize(z):
+        return z.real.astype(my_type) + 1j * z.imag.astype(my_type)
+
+    # Unit pilots, the receiver stores their reciprocal
+    pilot_tx = np.exp(1j * 2 * np.pi * np.random.rand(N_sc, N_tx))
+    # The header stores the inputs with 4 decimals
+    pilot_tx = quantize(np.round(np.reciprocal(pilot_tx), 4))
+    # Noise variance of the MMSE detector
+    sigma = 1.0
+
+    vSymb = []
+    vx = []
+    for slot in range(N_slots):
+        # Channel and QPSK data of each subcarrier
+        H = np.random.randn(N_sc, N_rx, N_tx) + \
+            1j * np.random.randn(N_sc, N_rx, N_tx)
+        H = H / np.sqrt(2 * N_rx)
+        s = np.random.choice([-1, 1], (N_sc, N_tx)) + \
+            1j * np.random.choice([-1, 1], (N_sc, N_tx))
+        s = s / np.sqrt(2)
+        pilot_rx = np.einsum('krt,kt->kr', H, np.reciprocal(pilot_tx))
+        data_rx = np.einsum('krt,kt->kr', H, s)
+        # Time-domain symbols of each antenna, the pilot symbol comes first
+        symb = np.concatenate((pilot_rx.T, data_rx.T), axis=0)
+        symb = quantize(np.round(np.fft.ifft(symb, axis=1), 4))
+
+        # OFDM demodulation and LS channel estimation
+        freq = quantize(np.fft.fft(symb, axis=1))
+        Hest = quantize(freq[:N_rx].T[:, :, np.newaxis] *
+                        pilot_tx[:, np.newaxis, :])
+        y = freq[N_rx:].T
+
+        # The FFT and the channel estimation store (imag, real) pairs, that
+        # the MIMO detector reads as (real, imag), i.e. as 1j * conj(z)
+        Hest = 1j * np.conj(Hest)
+        y = 1j * np.conj(y)
+        x = np.zeros((N_sc, N_tx), dtype=complex)
+        for k in range(N_sc):
+            H_h = np.asmatrix(Hest[k]).H
+            G = np.matmul(H_h, Hest[k]) + sigma * np.eye(N_tx)
+            L = np.linalg.cholesky(G)
+            y1 = np.asarray(np.dot(H_h, y[k])).flatten()
+            y2 = solve_triangular(L, y1, lower=True)
+            x[k] = solve_triangular(np.asmatrix(L).H, y2)
+
+        symb = symb.flatten()
+        vSymb.append(np.column_stack((symb.imag, symb.real)).flatten())
+        x = x.flatten()
+        vx.append(np.column_stack((x.real, x.imag)).flatten())
+
+    vSymb = np.concatenate(vSymb).astype(my_type)
+    vx = np.concatenate(vx).astype(my_type)
+    pilot_tx = pilot_tx.flatten()
+    pilot_tx = np.column_stack((pilot_tx.imag, pilot_tx.real))
+    pilot_tx = pilot_tx.flatten().astype(my_type)
+    vS = np.column_stack((sigma * np.ones(N_tx), np.zeros(N_tx)))
+    vS = vS.flatten().astype(my_type)
+    twiddles = ftwiddleCoef(N_sc, my_type)
+    bitrever = qmath.bitreversal(N_sc, 2)
+
+    defines['LOG2'] = int(math.log2(N_sc))
+    defines['N_TWIDDLES'] = 3 * N_sc // 4
+    defines['BITREVINDEXTABLE_LENGTH'] = len(bitrever)
+    defines['TOLERANCE'] = 0.05 * np.max(np.abs(vx))
+
+    return [vSymb, pilot_tx, vS, twiddles, bitrever, vx], defines
+
+
 ##############################################################################
 
 
@@ -370,8 +669,9 @@ def generate_imatmul(my_type=np.int32, defines={}):
     matrix_P = defines['matrix_P']
     MAX = select_maxval(my_type)
     A = irandom(MAX=MAX, size=(matrix_M, matrix_N), my_type=my_type)
-    B = irandom(MAX=MAX, size=(matrix_M, matrix_N), my_type=my_type)
-    C = np.matmul(A, B)
+    B = irandom(MAX=MAX, size=(matrix_N, matrix_P), my_type=my_type)
+    # The kernels accumulate in 32 bits
+    C = np.matmul(A.astype(np.int32), B.astype(np.int32))
 
     A = np.reshape(A, (matrix_M * matrix_N), order='C').astype(my_type)
     B = np.reshape(B, (matrix_N * matrix_P), order='C').astype(my_type)
@@ -380,9 +680,168 @@ def generate_imatmul(my_type=np.int32, defines={}):
     return [A, B, C], defines
 
 
+def generate_matmul_tiled(my_type=np.int32, defines={}):
+
+    # The operands of the tiled matmul fill most of L2, there is no space for
+    # the full golden result. Only check_rows rows of C, evenly spaced from
+    # the first to the last, are kept.
+    if np.issubdtype(my_type, np.integer):
+        [A, B, C], defines = generate_imatmul(my_type=my_type, defines=defines)
+    else:
+        [A, B, C], defines = generate_fmatmul(my_type=my_type, defines=defines)
+    matrix_M = defines['matrix_M']
+    matrix_P = defines['matrix_P']
+    rows = np.linspace(0, matrix_M - 1, defines['check_rows']).astype(np.int32)
+    C = np.reshape(C, (matrix_M, matrix_P), order='C')[rows].flatten()
+
+    return [A, B, C, rows], defines
+
+
+def generate_spmv(my_type=np.int32, defines={}):
+
+    N_ROWS = defines['N_ROWS']
+    N_COLS = defines['N_COLS']
+    NNZ_ROW = defines['NNZ_ROW']
+
+    # Sparsity as in discretized PDEs: the diagonal, a band around it, and
+    # some long range couplings. Row lengths are log-normal, so that
+    # partitioning by rows gives unbalanced work.
+    row_len = np.random.lognormal(np.log(NNZ_ROW), 0.6, N_ROWS)
+    row_len = np.clip(np.round(row_len), 1, 4 * NNZ_ROW).astype(int)
+    band = max(4, N_COLS // 32)
+    rowptr, colidx = [0], []
+    for r in range(N_ROWS):
+        cols = {r % N_COLS}
+        while len(cols) < min(row_len[r], N_COLS):
+            if np.random.rand() < 0.8:
+                c = int(r + np.round(np.random.normal(0, band)))
+            else:
+                c = np.random.randint(0, N_COLS)
+            if 0 <= c < N_COLS:
+                cols.add(c)
+        colidx += sorted(cols)
+        rowptr.append(len(colidx))
+    rowptr = np.array(rowptr)
+    colidx = np.array(colidx)
+    NNZ = len(colidx)
+
+    if np.issubdtype(my_type, np.integer):
+        val = np.random.randint(-64, 64, NNZ).astype(my_type)
+        x = np.random.randint(-64, 64, N_COLS).astype(my_type)
+    else:
+        val = (np.random.rand(NNZ) - 0.5).astype(my_type)
+        x = (np.random.rand(N_COLS) - 0.5).astype(my_type)
+    y = np.zeros(N_ROWS, dtype=np.float64)
+    for r in range(N_ROWS):
+        idx = range(rowptr[r], rowptr[r + 1])
+        y[r] = np.sum(val[idx].astype(np.float64) * x[colidx[idx]])
+    y = y.astype(my_type)
+
+    # ELLPACK, column-major. Padding entries point to the diagonal, so that
+    # they do not all access the same bank of x.
+    ELL_WIDTH = int(np.max(np.diff(rowptr)))
+    ell_val = np.zeros((ELL_WIDTH, N_ROWS), dtype=my_type)
+    ell_col = np.zeros((ELL_WIDTH, N_ROWS), dtype=int)
+    for r in range(N_ROWS):
+        n = rowptr[r + 1] - rowptr[r]
+        ell_val[:n, r] = val[rowptr[r]:rowptr[r + 1]]
+        ell_col[:n, r] = colidx[rowptr[r]:rowptr[r + 1]]
+        ell_col[n:, r] = r % N_COLS
+
+    defines['NNZ'] = NNZ
+    defines['ELL_WIDTH'] = ELL_WIDTH
+    if not np.issubdtype(my_type, np.integer):
+        defines['TOLERANCE'] = 0.01 * float(np.max(np.abs(y)))
+
+    return [val, colidx, rowptr, ell_val.flatten(), ell_col.flatten(), x,
+            y], defines
+
+
+def generate_sort(my_type=np.int32, defines={}):
+
+    N_KEYS = defines['N_KEYS']
+    keys = np.random.randint(0, 2**32, N_KEYS, dtype=np.uint64)
+    # Stable sort, the values are the original positions of the keys
+    idx = np.argsort(keys, kind='stable')
+
+    return [keys, keys[idx], idx], defines
+
+
+def resample(h, x, L, D):
+    """Polyphase resampler by L / D, y[n] = sum_j h[j * L + p] x[m - j],
+    with m = (n * D) // L and p = (n * D) % L"""
+    nTapsPhase = len(h) // L
+    xpad = np.concatenate((np.zeros(nTapsPhase - 1, dtype=x.dtype), x))
+    y = []
+    for n in range((len(x) * L) // D):
+        m, p = divmod(n * D, L)
+        # xpad[m + nTapsPhase - 1 - j] is x[m - j]
+        y.append(np.dot(h[p::L][::-1], xpad[m:m + nTapsPhase]))
+    return np.array(y)
+
+
+def generate_fir(my_type=np.int16, defines={}):
+
+    N_SAMPLES = defines['N_SAMPLES']
+    N_TAPS = defines['N_TAPS']
+    DECIM = defines['DECIM']
+    INTERP = defines['INTERP']
+
+    # Low-pass filter with the cutoff at the band of the resampler, and a
+    # signal with two tones and noise
+    h = signal.firwin(N_TAPS, 1 / max(DECIM, INTERP))
+    t = np.arange(N_SAMPLES)
+    x = 0.25 * np.sin(0.01 * np.pi * t) + 0.15 * np.sin(0.6 * np.pi * t) + \
+        0.05 * (np.random.rand(N_SAMPLES) - 0.5)
+
+    y = []
+    if np.issubdtype(my_type, np.integer):
+        # Q15, accumulation in 32b
+        h = np.round(h * 2**15).astype(my_type)
+        x = np.round(x * 2**15).astype(my_type)
+        for L, D in ((1, 1), (1, DECIM), (INTERP, 1)):
+            acc = resample(h.astype(np.int64), x.astype(np.int64), L, D)
+            y.append(np.clip(acc >> 15, -2**15, 2**15 - 1).astype(my_type))
+    else:
+        h = h.astype(my_type)
+        x = x.astype(my_type)
+        for L, D in ((1, 1), (1, DECIM), (INTERP, 1)):
+            acc = resample(h.astype(np.float64), x.astype(np.float64), L, D)
+            y.append(acc.astype(my_type))
+        defines['TOLERANCE'] = 0.01
+
+    return [x, h, *y], defines
+
 ##############################################################################
 
 
+def generate_histogram(my_type=np.int8, defines={}):
+
+    n_pixels = defines['IMG_WIDTH'] * defines['IMG_HEIGHT']
+    n_patch = defines['N_PATCH']
+    n_bins = defines['NUM_BINS']
+    depth = 8 * np.dtype(my_type).itemsize
+    max_val = 2**depth - 1
+    shift = depth - int(math.log2(n_bins))
+    pixel_type = np.uint8 if depth == 8 else np.uint16
+
+    # Low-contrast patch, tiled over the image
+    patch = np.random.normal(0.4 * max_val, 0.08 * max_val, n_patch)
+    patch = np.clip(np.round(patch), 0, max_val).astype(pixel_type)
+    hist = np.bincount(patch >> shift, minlength=n_bins).astype(np.int64)
+    hist = hist * (n_pixels // n_patch)
+    # Equalization LUT
+    cdf = np.cumsum(hist)
+    cdf_min = cdf[cdf > 0][0]
+    den = n_pixels - cdf_min
+    if den == 0:
+        lut = (np.arange(n_bins) * max_val) // (n_bins - 1)
+    else:
+        lut = ((cdf - cdf_min) * max_val + den // 2) // den
+        lut[cdf < cdf_min] = 0
+    return [patch, hist.astype(np.uint32), lut.astype(np.uint32)], defines
+
+
 def generate_qcmatmul(defines={}, fixed_point=15, my_type=np.int32):
     MAX = 2**(fixed_point - 1)
     # Create matrix
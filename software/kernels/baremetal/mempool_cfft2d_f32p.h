@@ -0,0 +1,104 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel row-column 2D FFT on 32b floating point data, kept in L1.
+- The FFTs of the rows run in place, with the stages of the mixed-radix FFT.
+- The digit reversal of the rows is merged with the transposition of the
+matrix, so that the FFTs of the columns also run on contiguous data.
+- The FFTs of the columns run in place on the transposed matrix.
+- The digit reversal of the columns transposes the matrix back, or leaves the
+result transposed when transposeOut is set. A 2D FFT on a transposed matrix,
+with transposed output, returns the result in the original layout: inverse
+transforms on transposed spectra thus need no extra transposition.
+Re and Im parts are interleaved.
+*/
+
+#pragma once
+#include "baremetal/mempool_mixedradix_cfft_f32p.h"
+
+/**
+  @brief         Digit reversal of nFFTs mixed-radix FFTs, stored in the rows
+  of pSrc. When transpose is set the FFTs are stored in the columns of pDst.
+  The cores start from different rows, so that the transposed stores of
+  different cores do not access the same bank.
+  @param[in]     pSrc points to input buffer of 32b data
+  @param[out]    pDst points to output buffer of 32b data
+  @param[in]     fftLen length of the FFTs
+  @param[in]     nFFTs number of FFTs
+  @param[in]     pDigitRevTable points to the digit reversal table
+  @param[in]     transpose store the FFTs in the columns of pDst
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_digitrev_transpose_f32p(float *pSrc, float *pDst,
+                                     const uint32_t fftLen,
+                                     const uint32_t nFFTs,
+                                     const uint16_t *pDigitRevTable,
+                                     const uint32_t transpose,
+                                     const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t idx, j, row, k, idx_dst;
+  float re, im;
+
+  for (idx = core_id; idx < fftLen; idx += nPE) {
+    j = pDigitRevTable[idx];
+    row = core_id % nFFTs;
+    for (k = 0; k < nFFTs; k++) {
+      re = pSrc[2U * (row * fftLen + idx)];
+      im = pSrc[2U * (row * fftLen + idx) + 1U];
+      idx_dst = transpose ? (j * nFFTs + row) : (row * fftLen + j);
+      pDst[2U * idx_dst] = re;
+      pDst[2U * idx_dst + 1U] = im;
+      row = (row + 1U == nFFTs) ? 0 : row + 1U;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
+
+/**
+  @brief         Parallel 2D FFT.
+  @param[in]     pSrc points to the input matrix, holds the result
+  @param[in]     pTmp points to a buffer of the same size of pSrc
+  @param[in]     nRows number of rows of the matrix
+  @param[in]     nCols number of columns of the matrix
+  @param[in]     pCoefRow points to the twiddles of the FFTs of the rows
+  @param[in]     pRadixRow points to the radices of the FFTs of the rows
+  @param[in]     nStagesRow number of stages of the FFTs of the rows
+  @param[in]     pDigitRevRow points to the digit reversal table of the rows
+  @param[in]     pCoefCol points to the twiddles of the FFTs of the columns
+  @param[in]     pRadixCol points to the radices of the FFTs of the columns
+  @param[in]     nStagesCol number of stages of the FFTs of the columns
+  @param[in]     pDigitRevCol points to the digit reversal table of the columns
+  @param[in]     transposeOut store the result as a nCols x nRows matrix
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_cfft2d_f32p(float *pSrc, float *pTmp, const uint32_t nRows,
+                         const uint32_t nCols, const float *pCoefRow,
+                         const uint32_t *pRadixRow, const uint32_t nStagesRow,
+                         const uint16_t *pDigitRevRow, const float *pCoefCol,
+                         const uint32_t *pRadixCol, const uint32_t nStagesCol,
+                         const uint16_t *pDigitRevCol,
+                         const uint32_t transposeOut, const uint32_t nPE) {
+
+  /* FFT OF THE ROWS */
+  mempool_mixedradix_cfft_f32p_stages(pSrc, nCols, nRows, 1, pCoefRow,
+                                      pRadixRow, nStagesRow, nPE);
+  mempool_digitrev_transpose_f32p(pSrc, pTmp, nCols, nRows, pDigitRevRow, 1,
+                                  nPE);
+
+  /* FFT OF THE COLUMNS */
+  mempool_mixedradix_cfft_f32p_stages(pTmp, nRows, nCols, 1, pCoefCol,
+                                      pRadixCol, nStagesCol, nPE);
+  mempool_digitrev_transpose_f32p(pTmp, pSrc, nRows, nCols, pDigitRevCol,
+                                  !transposeOut, nPE);
+  return;
+}
@@ -4,6 +4,8 @@
 
 // Author: Marco Bertuletti, ETH Zurich
 
+#include "builtins_v2.h"
+
 /**
   @brief         Check for q32 kernels.
   @param[in]     pRes points to the result
@@ -169,4 +171,45 @@ void mempool_check_f16(__fp16 *__restrict__ pRes, __fp16 *__restrict__ pExp,
   }
   return;
 }
+
+/**
+  @brief         Check for f8 kernels.
+  @param[in]     pRes points to the result
+  @param[in]     pExp points to the expected result
+  @param[in]     NEL  number of elements to check
+  @param[in]     TOL  floating point tolerance
+  @return        none
+*/
+void mempool_check_f8(__fp8 *__restrict__ pRes, __fp8 *__restrict__ pExp,
+                      uint32_t NEL, float TOL, bool verbose) {
+  uint32_t core_id = mempool_get_core_id();
+
+  if (core_id == 0) {
+    uint32_t ERRORS = 0;
+    for (uint32_t i = 0; i < NEL; i++) {
+      __fp8 exp = pExp[i];
+      __fp8 res = pRes[i];
+      __fp16 exp_f16, res_f16;
+      float diff;
+      asm volatile("fcvt.h.b %[exp_f16], %[exp];"
+                   "fcvt.h.b %[res_f16], %[res];"
+                   "fsub.h %[diff], %[res_f16], %[exp_f16];"
+                   "fcvt.s.h %[diff], %[diff];"
+                   : [diff] "+&r"(diff), [exp_f16] "=&r"(exp_f16),
+                     [res_f16] "=&r"(res_f16)
+                   : [res] "r"(res), [exp] "r"(exp)
+                   :);
+
+      uint32_t error = ((diff > TOL) || (diff < (-TOL))) ? 1 : 0;
+      uint32_t print = error || verbose;
+      ERRORS += error;
+      if (print) {
+        printf("CHECK(%d): EXP = %02X - RESP = %02X\n", i, (uint8_t)exp,
+               (uint8_t)res);
+      }
+    }
+    printf("%d ERRORS out of %d CHECKS\n", ERRORS, NEL);
+  }
+  return;
+}
 #endif
@@ -382,6 +382,21 @@ void mempool_chest_f16p_unrolled4(__fp16 *pH, __fp16 *pPilotRX,
   return;
 }
 
+/**
+  @brief         Block-type channel estimation. Each core loads the words
+  core_id * BANKING_FACTOR + k * BANKING_FACTOR * nPE of the received pilots,
+  which are in its local banks when nPE is NUM_CORES. The nPE cores run as a
+  group aligned to nPE and synchronize only among themselves.
+  @param[in]     pH  points to output channel
+  @param[in]     pPilotRX points to received symbol
+  @param[in]     pPilotTX points to sent pilot
+  @param[in]     nTX Number of transmitters
+  @param[in]     nRX Number of receivers
+  @param[in]     nSc Number of Subcarriers
+  @param[in]     core_id ID of the PE
+  @param[in]     nPE Number of PEs
+  @return        none
+*/
 void mempool_chest_f16p_unrolled4_local(__fp16 *volatile pH,
                                         __fp16 *volatile pPilotRX,
                                         __fp16 *volatile pPilotTX, uint32_t nRX,
@@ -396,8 +411,7 @@ void mempool_chest_f16p_unrolled4_local(__fp16 *volatile pH,
   uint32_t itr, i, j;
 
   // Cores Loop over the received pilots vector
-  for (itr = core_id * 4; itr < (nSc * nRX);
-       itr += (BANKING_FACTOR * NUM_CORES)) {
+  for (itr = core_id * 4; itr < (nSc * nRX); itr += (BANKING_FACTOR * nPE)) {
     // Received pilots are aligned to cores
     uint32_t sc_RX = itr / nRX;
     pPilotTX_itr = pPilotTX + sc_RX * (2 * nTX);
@@ -437,6 +451,6 @@ void mempool_chest_f16p_unrolled4_local(__fp16 *volatile pH,
       *((uint32_t *)&pH_itr[2 * ((i + 3) * nTX + j + 3)]) = sum3;
     }
   }
-  mempool_barrier(nPE);
+  mempool_log_partial_barrier(2, mempool_get_core_id(), nPE);
   return;
 }
@@ -0,0 +1,214 @@
+// Copyright 2021 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Blocked right-looking Cholesky decomposition of a complex Hermitian matrix,
+same scheme as mempool_cholesky_f32p. Products are accumulated in f32 with
+vfdotpex.s.h and converted back to f16 when the matrix is updated.
+The order of the matrix must be a multiple of CHOLESKY_BLOCK and the number of
+cores a power of two.
+*/
+
+#pragma once
+#include "builtins_v2.h"
+
+#ifndef CHOLESKY_BLOCK
+#define CHOLESKY_BLOCK (4)
+#endif
+#if CHOLESKY_BLOCK != 4
+#error "ERROR: the trailing update is unrolled for CHOLESKY_BLOCK == 4."
+#endif
+
+/**
+  @brief         Row of the panel of a blocked Cholesky decomposition.
+  @param[in]     pL points to the partially updated matrix
+  @param[in]     n dimension of the input data
+  @param[in]     i row index
+  @param[in]     kb first column of the panel
+  @param[in]     je last column to compute (excluded)
+  @return        none
+*/
+static inline void mempool_cholesky_f16vecp_row(__fp16 *pL, const uint32_t n,
+                                                const uint32_t i,
+                                                const uint32_t kb,
+                                                const uint32_t je) {
+
+  const uint32_t neg_mask = 0x00008000;
+  const uint32_t shuffle_mask = 0x00020003;
+  float as, bs, ap, bp, diag;
+  v2h ab, cd, ndc, asbs;
+  uint32_t j, k;
+
+  for (j = kb; j < je; j++) {
+    as = 0.0f;
+    bs = 0.0f;
+    for (k = kb; k < j; k++) {
+      ab = (*(v2h *)&pL[2U * (i * n + k)]);
+      cd = (*(v2h *)&pL[2U * (j * n + k)]);
+      asm volatile(
+          // s = s + (ac + bd) + j(bc - ad)
+          "vfdotpex.s.h  %[as],  %[ab], %[cd];"
+          "pv.shuffle2.h %[ndc], %[cd], %[shuffle_mask];"
+          "xor           %[ndc], %[neg_mask], %[ndc];"
+          "vfdotpex.s.h  %[bs],  %[ab], %[ndc];"
+          : [as] "+&r"(as), [bs] "+&r"(bs), [ndc] "+r"(ndc)
+          : [ab] "r"(ab), [cd] "r"(cd), [neg_mask] "r"(neg_mask),
+            [shuffle_mask] "r"(shuffle_mask)
+          :);
+    }
+    asm volatile("fcvt.s.h %0, %1;" : "=r"(ap) : "r"(pL[2U * (i * n + j)]) :);
+    asm volatile("fcvt.s.h %0, %1;"
+                 : "=r"(bp)
+                 : "r"(pL[2U * (i * n + j) + 1])
+                 :);
+    asm volatile("fcvt.s.h %0, %1;" : "=r"(diag) : "r"(pL[2U * (j * n + j)]) :);
+    as = (ap - as) / diag;
+    bs = (bp - bs) / diag;
+    asm volatile("vfcpka.h.s %0, %1, %2;" : "=r"(asbs) : "r"(as), "r"(bs) :);
+    (*(v2h *)&pL[2U * (i * n + j)]) = asbs;
+  }
+  return;
+}
+
+/**
+  @brief         Factorization of the diagonal block of a panel.
+  @param[in]     pL points to the partially updated matrix
+  @param[in]     n dimension of the input data
+  @param[in]     kb first column of the panel
+  @return        none
+*/
+void mempool_cholesky_f16vecp_diagblock(__fp16 *pL, const uint32_t n,
+                                        const uint32_t kb) {
+
+  float sum;
+  __fp16 ap;
+  v2h ab;
+  uint32_t i, k;
+
+  for (i = kb; i < kb + CHOLESKY_BLOCK; i++) {
+    // Elements on the row, left of the diagonal
+    mempool_cholesky_f16vecp_row(pL, n, i, kb, i);
+    // Element on the diagonal
+    ap = pL[2U * (i * n + i)];
+    asm volatile("fcvt.s.h %0, %1;" : "=r"(sum) : "r"(ap) :);
+    for (k = kb; k < i; k++) {
+      ab = (*(v2h *)&pL[2U * (i * n + k)]);
+      asm volatile("vfndotpex.s.h %[sum], %[ab], %[ab];"
+                   : [sum] "+&r"(sum)
+                   : [ab] "r"(ab)
+                   :);
+    }
+    sum = (float)sqrt(sum);
+    asm volatile("fcvt.h.s %0, %1;" : "=r"(ap) : "r"(sum) :);
+    pL[2U * (i * n + i)] = ap;
+    pL[2U * (i * n + i) + 1] = (__fp16)0.0f;
+  }
+  return;
+}
+
+/**
+  @brief         Parallel blocked Cholesky decomposition.
+  @param[in]     pSrc points to input matrix
+  @param[in]     pL points to output lower triangular matrix
+  @param[in]     n dimension of the input data
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_cholesky_f16vecp(__fp16 *pSrc, __fp16 *pL, const uint32_t n,
+                              const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  const uint32_t neg_mask = 0x80000000;
+  const uint32_t shuffle_mask = 0x00020003;
+  v2h ab0, ab1, ab2, ab3;
+  v2h ba0, ba1, ba2, ba3;
+  v2h cd0, cd1, cd2, cd3;
+  v2h apbp, asbs;
+  float as, bs;
+  uint32_t i, j, kb, ke;
+
+  // Copy the lower triangle, clear the upper triangle
+  for (i = core_id; i < n; i += nPE) {
+    for (j = 0; j < n; j++) {
+      apbp = (j <= i) ? (*(v2h *)&pSrc[2U * (i * n + j)]) : (v2h)0.0f;
+      (*(v2h *)&pL[2U * (i * n + j)]) = apbp;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+  for (kb = 0; kb < n; kb += CHOLESKY_BLOCK) {
+    ke = kb + CHOLESKY_BLOCK;
+
+    // Diagonal block, panels are assigned round-robin
+    if (core_id == (kb / CHOLESKY_BLOCK) % nPE) {
+      mempool_cholesky_f16vecp_diagblock(pL, n, kb);
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    // Panel below the diagonal block
+    for (i = ke + core_id; i < n; i += nPE) {
+      mempool_cholesky_f16vecp_row(pL, n, i, kb, ke);
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    // Trailing matrix update, the panel row of each core is kept in registers
+    if (ke < n) {
+      for (i = ke + core_id; i < n; i += nPE) {
+        ab0 = (*(v2h *)&pL[2U * (i * n + kb)]);
+        ab1 = (*(v2h *)&pL[2U * (i * n + kb + 1)]);
+        ab2 = (*(v2h *)&pL[2U * (i * n + kb + 2)]);
+        ab3 = (*(v2h *)&pL[2U * (i * n + kb + 3)]);
+        // (a, b) -> (b, -a), to compute (bc - ad) with a single dotp
+        asm volatile("pv.shuffle2.h %[ba0], %[ab0], %[shuffle_mask];"
+                     "pv.shuffle2.h %[ba1], %[ab1], %[shuffle_mask];"
+                     "pv.shuffle2.h %[ba2], %[ab2], %[shuffle_mask];"
+                     "pv.shuffle2.h %[ba3], %[ab3], %[shuffle_mask];"
+                     "xor %[ba0], %[neg_mask], %[ba0];"
+                     "xor %[ba1], %[neg_mask], %[ba1];"
+                     "xor %[ba2], %[neg_mask], %[ba2];"
+                     "xor %[ba3], %[neg_mask], %[ba3];"
+                     : [ba0] "=&r"(ba0), [ba1] "=&r"(ba1), [ba2] "=&r"(ba2),
+                       [ba3] "=&r"(ba3)
+                     : [ab0] "r"(ab0), [ab1] "r"(ab1), [ab2] "r"(ab2),
+                       [ab3] "r"(ab3), [neg_mask] "r"(neg_mask),
+                       [shuffle_mask] "r"(shuffle_mask)
+                     :);
+        for (j = ke; j <= i; j++) {
+          cd0 = (*(v2h *)&pL[2U * (j * n + kb)]);
+          cd1 = (*(v2h *)&pL[2U * (j * n + kb + 1)]);
+          cd2 = (*(v2h *)&pL[2U * (j * n + kb + 2)]);
+          cd3 = (*(v2h *)&pL[2U * (j * n + kb + 3)]);
+          apbp = (*(v2h *)&pL[2U * (i * n + j)]);
+          as = 0.0f;
+          bs = 0.0f;
+          // s = s + (ac + bd) + j(bc - ad)
+          asm volatile("vfdotpex.s.h  %[as], %[ab0], %[cd0];"
+                       "vfdotpex.s.h  %[bs], %[ba0], %[cd0];"
+                       "vfdotpex.s.h  %[as], %[ab1], %[cd1];"
+                       "vfdotpex.s.h  %[bs], %[ba1], %[cd1];"
+                       "vfdotpex.s.h  %[as], %[ab2], %[cd2];"
+                       "vfdotpex.s.h  %[bs], %[ba2], %[cd2];"
+                       "vfdotpex.s.h  %[as], %[ab3], %[cd3];"
+                       "vfdotpex.s.h  %[bs], %[ba3], %[cd3];"
+                       "vfcpka.h.s    %[asbs], %[as], %[bs];"
+                       "vfsub.h       %[apbp], %[apbp], %[asbs];"
+                       : [as] "+&r"(as), [bs] "+&r"(bs), [asbs] "=&r"(asbs),
+                         [apbp] "+&r"(apbp)
+                       : [ab0] "r"(ab0), [ab1] "r"(ab1), [ab2] "r"(ab2),
+                         [ab3] "r"(ab3), [ba0] "r"(ba0), [ba1] "r"(ba1),
+                         [ba2] "r"(ba2), [ba3] "r"(ba3), [cd0] "r"(cd0),
+                         [cd1] "r"(cd1), [cd2] "r"(cd2), [cd3] "r"(cd3)
+                       :);
+          (*(v2h *)&pL[2U * (i * n + j)]) = apbp;
+        }
+      }
+      mempool_log_partial_barrier(2, absolute_core_id, nPE);
+    }
+  }
+  return;
+}
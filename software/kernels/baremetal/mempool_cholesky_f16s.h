@@ -404,7 +404,7 @@ void mempool_cholesky_f16vecs(__fp16 *pSrc, __fp16 *pL, const uint32_t n,
     for (i = j + 1; i < n; i++) {
       // Pivot
       ap = pSrc[2U * (i * offset + j)];
-      bp = pSrc[2U * (i * offset + j + 1)];
+      bp = pSrc[2U * (i * offset + j) + 1];
       // Diag
       diag = pL[2U * (j * offset + j)];
 
@@ -0,0 +1,227 @@
+// Copyright 2021 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Blocked right-looking Cholesky decomposition of a complex Hermitian matrix.
+The matrix is split in panels of CHOLESKY_BLOCK columns. For each panel:
+- The diagonal block is factorized by a single core (round-robin over panels).
+- The rows of the panel below the diagonal block are computed in parallel.
+- The panel is broadcast to all cores, which update the trailing lower
+triangular matrix, each core working on a set of rows.
+
+    x
+    x x
+    D D D
+    P P P . .
+    P P P . . .
+
+Data is interleaved (real, imaginary) and stored row-major. The input matrix
+is copied to the output, so that the decomposition can also run in place.
+The order of the matrix must be a multiple of CHOLESKY_BLOCK and the number of
+cores a power of two.
+*/
+
+#pragma once
+#ifdef __XDIVSQRT
+
+#ifndef CHOLESKY_BLOCK
+#define CHOLESKY_BLOCK (4)
+#endif
+#if CHOLESKY_BLOCK != 4
+#error "ERROR: the trailing update is unrolled for CHOLESKY_BLOCK == 4."
+#endif
+
+/**
+  @brief         Factorization of the diagonal block of a panel.
+  @param[in]     pL points to the partially updated matrix
+  @param[in]     n dimension of the input data
+  @param[in]     kb first column of the panel
+  @return        none
+*/
+void mempool_cholesky_f32p_diagblock(float *pL, const uint32_t n,
+                                     const uint32_t kb) {
+
+  float a, b, c, d;
+  float ap, bp, diag;
+  uint32_t i, j, k;
+
+  for (j = kb; j < kb + CHOLESKY_BLOCK; j++) {
+    // Elements on diagonal
+    ap = pL[2U * (j * n + j)];
+    for (k = kb; k < j; k++) {
+      a = pL[2U * (j * n + k)];
+      b = pL[2U * (j * n + k) + 1];
+      asm volatile("fnmsub.s %[ap], %[a], %[a], %[ap];"
+                   "fnmsub.s %[ap], %[b], %[b], %[ap];"
+                   : [ap] "+&r"(ap)
+                   : [a] "r"(a), [b] "r"(b)
+                   :);
+    }
+    asm volatile("fsqrt.s %[ap], %[ap];" : [ap] "+&r"(ap) : :);
+    pL[2U * (j * n + j)] = ap;
+    pL[2U * (j * n + j) + 1] = 0.0f;
+    diag = ap;
+
+    // Elements on rows of the diagonal block
+    for (i = j + 1; i < kb + CHOLESKY_BLOCK; i++) {
+      ap = pL[2U * (i * n + j)];
+      bp = pL[2U * (i * n + j) + 1];
+      for (k = kb; k < j; k++) {
+        a = pL[2U * (i * n + k)];
+        b = pL[2U * (i * n + k) + 1];
+        c = pL[2U * (j * n + k)];
+        d = pL[2U * (j * n + k) + 1];
+        asm volatile("fnmsub.s %[ap], %[a], %[c], %[ap];"
+                     "fnmsub.s %[ap], %[b], %[d], %[ap];"
+                     "fnmsub.s %[bp], %[b], %[c], %[bp];"
+                     "fmadd.s  %[bp], %[a], %[d], %[bp];"
+                     : [ap] "+&r"(ap), [bp] "+&r"(bp)
+                     : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                     :);
+      }
+      asm volatile("fdiv.s %[ap], %[ap], %[diag];"
+                   "fdiv.s %[bp], %[bp], %[diag];"
+                   : [ap] "+&r"(ap), [bp] "+&r"(bp)
+                   : [diag] "r"(diag)
+                   :);
+      pL[2U * (i * n + j)] = ap;
+      pL[2U * (i * n + j) + 1] = bp;
+    }
+  }
+  return;
+}
+
+/**
+  @brief         Parallel blocked Cholesky decomposition.
+  @param[in]     pSrc points to input matrix
+  @param[in]     pL points to output lower triangular matrix
+  @param[in]     n dimension of the input data
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_cholesky_f32p(float *pSrc, float *pL, const uint32_t n,
+                           const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  float a0, b0, a1, b1, a2, b2, a3, b3;
+  float c0, d0, c1, d1, c2, d2, c3, d3;
+  float ap, bp, diag;
+  uint32_t i, j, k, kb, ke;
+
+  // Copy the lower triangle, clear the upper triangle
+  for (i = core_id; i < n; i += nPE) {
+    for (j = 0; j < n; j++) {
+      ap = (j <= i) ? pSrc[2U * (i * n + j)] : 0.0f;
+      bp = (j <= i) ? pSrc[2U * (i * n + j) + 1] : 0.0f;
+      pL[2U * (i * n + j)] = ap;
+      pL[2U * (i * n + j) + 1] = bp;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+  for (kb = 0; kb < n; kb += CHOLESKY_BLOCK) {
+    ke = kb + CHOLESKY_BLOCK;
+
+    // Diagonal block, panels are assigned round-robin
+    if (core_id == (kb / CHOLESKY_BLOCK) % nPE) {
+      mempool_cholesky_f32p_diagblock(pL, n, kb);
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    // Panel below the diagonal block
+    for (i = ke + core_id; i < n; i += nPE) {
+      for (j = kb; j < ke; j++) {
+        ap = pL[2U * (i * n + j)];
+        bp = pL[2U * (i * n + j) + 1];
+        diag = pL[2U * (j * n + j)];
+        for (k = kb; k < j; k++) {
+          a0 = pL[2U * (i * n + k)];
+          b0 = pL[2U * (i * n + k) + 1];
+          c0 = pL[2U * (j * n + k)];
+          d0 = pL[2U * (j * n + k) + 1];
+          asm volatile("fnmsub.s %[ap], %[a0], %[c0], %[ap];"
+                       "fnmsub.s %[ap], %[b0], %[d0], %[ap];"
+                       "fnmsub.s %[bp], %[b0], %[c0], %[bp];"
+                       "fmadd.s  %[bp], %[a0], %[d0], %[bp];"
+                       : [ap] "+&r"(ap), [bp] "+&r"(bp)
+                       : [a0] "r"(a0), [b0] "r"(b0), [c0] "r"(c0),
+                         [d0] "r"(d0)
+                       :);
+        }
+        asm volatile("fdiv.s %[ap], %[ap], %[diag];"
+                     "fdiv.s %[bp], %[bp], %[diag];"
+                     : [ap] "+&r"(ap), [bp] "+&r"(bp)
+                     : [diag] "r"(diag)
+                     :);
+        pL[2U * (i * n + j)] = ap;
+        pL[2U * (i * n + j) + 1] = bp;
+      }
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    // Trailing matrix update, the panel row of each core is kept in registers
+    if (ke < n) {
+      for (i = ke + core_id; i < n; i += nPE) {
+        a0 = pL[2U * (i * n + kb)];
+        b0 = pL[2U * (i * n + kb) + 1];
+        a1 = pL[2U * (i * n + kb + 1)];
+        b1 = pL[2U * (i * n + kb + 1) + 1];
+        a2 = pL[2U * (i * n + kb + 2)];
+        b2 = pL[2U * (i * n + kb + 2) + 1];
+        a3 = pL[2U * (i * n + kb + 3)];
+        b3 = pL[2U * (i * n + kb + 3) + 1];
+        for (j = ke; j <= i; j++) {
+          c0 = pL[2U * (j * n + kb)];
+          d0 = pL[2U * (j * n + kb) + 1];
+          c1 = pL[2U * (j * n + kb + 1)];
+          d1 = pL[2U * (j * n + kb + 1) + 1];
+          c2 = pL[2U * (j * n + kb + 2)];
+          d2 = pL[2U * (j * n + kb + 2) + 1];
+          c3 = pL[2U * (j * n + kb + 3)];
+          d3 = pL[2U * (j * n + kb + 3) + 1];
+          ap = pL[2U * (i * n + j)];
+          bp = pL[2U * (i * n + j) + 1];
+          // s = s - (ac + bd) - j(bc - ad)
+          asm volatile("fnmsub.s %[ap], %[a0], %[c0], %[ap];"
+                       "fnmsub.s %[bp], %[b0], %[c0], %[bp];"
+                       "fnmsub.s %[ap], %[a1], %[c1], %[ap];"
+                       "fnmsub.s %[bp], %[b1], %[c1], %[bp];"
+                       "fnmsub.s %[ap], %[a2], %[c2], %[ap];"
+                       "fnmsub.s %[bp], %[b2], %[c2], %[bp];"
+                       "fnmsub.s %[ap], %[a3], %[c3], %[ap];"
+                       "fnmsub.s %[bp], %[b3], %[c3], %[bp];"
+                       "fnmsub.s %[ap], %[b0], %[d0], %[ap];"
+                       "fmadd.s  %[bp], %[a0], %[d0], %[bp];"
+                       "fnmsub.s %[ap], %[b1], %[d1], %[ap];"
+                       "fmadd.s  %[bp], %[a1], %[d1], %[bp];"
+                       "fnmsub.s %[ap], %[b2], %[d2], %[ap];"
+                       "fmadd.s  %[bp], %[a2], %[d2], %[bp];"
+                       "fnmsub.s %[ap], %[b3], %[d3], %[ap];"
+                       "fmadd.s  %[bp], %[a3], %[d3], %[bp];"
+                       : [ap] "+&r"(ap), [bp] "+&r"(bp)
+                       : [a0] "r"(a0), [b0] "r"(b0), [a1] "r"(a1),
+                         [b1] "r"(b1), [a2] "r"(a2), [b2] "r"(b2),
+                         [a3] "r"(a3), [b3] "r"(b3), [c0] "r"(c0),
+                         [d0] "r"(d0), [c1] "r"(c1), [d1] "r"(d1),
+                         [c2] "r"(c2), [d2] "r"(d2), [c3] "r"(c3), [d3] "r"(d3)
+                       :);
+          pL[2U * (i * n + j)] = ap;
+          pL[2U * (i * n + j) + 1] = bp;
+        }
+      }
+      mempool_log_partial_barrier(2, absolute_core_id, nPE);
+    }
+  }
+  return;
+}
+
+#else
+
+#error "ERROR: f32 MMSE functions available only for __XDIVSQRT."
+
+#endif
@@ -4,6 +4,7 @@
 
 // Author: Marco Bertuletti, ETH Zurich
 
+#pragma once
 #ifdef __XDIVSQRT
 
 /**
@@ -44,7 +45,7 @@ void mempool_cholesky_f32s(float *pSrc, float *pL, const uint32_t n,
                  : [ap] "+&r"(ap)
                  : [sum] "r"(sum)
                  :);
-    pL[2U * (j * n + j)] = ap;
+    pL[2U * (j * offset + j)] = ap;
 
     // Elements on rows
     for (i = j + 1; i < n; i++) {
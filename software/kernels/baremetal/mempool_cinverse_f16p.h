@@ -0,0 +1,101 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Batched kernels on independent complex problems, e.g. the subcarriers of a
+MIMO precoder.
+
+The matrices are folded, with rows NUM_BANKS complex elements apart, and the
+problems lie side by side in the banks. A problem of n rows and w columns is
+w banks wide: problem itr is in column itr % CFOLD_F16_NCOL(w) of the banks and
+in block itr / CFOLD_F16_NCOL(w) of n rows. Each column is solved by the
+w / BANKING_FACTOR cores that own its banks, so all the accesses to the
+matrices are local.
+
+*/
+
+#pragma once
+#include "baremetal/mempool_cholesky_f16s.h"
+#include "baremetal/mempool_cinverse_f16s.h"
+#include "baremetal/mempool_linearsolver_f16s.h"
+
+// Problems of w columns in a row of banks
+#define CFOLD_F16_NCOL(w) (NUM_BANKS / (w))
+// Offset of the problem itr of n rows and w columns
+#define CFOLD_F16(itr, n, w)                                                   \
+  (((itr) / CFOLD_F16_NCOL(w)) * (2 * (n)*NUM_BANKS) +                         \
+   ((itr) % CFOLD_F16_NCOL(w)) * (2 * (w)))
+
+/**
+  @brief         Batched inversion of Hermitian positive-definite matrices, via
+  their Cholesky decomposition.
+  @param[in]     pG points to the folded input matrices
+  @param[out]    pL points to the folded Cholesky factors
+  @param[out]    pInv points to the folded inverse matrices
+  @param[in]     n dimension of the matrices, multiple of BANKING_FACTOR
+  @param[in]     nBatch number of matrices
+  @param[in]     core_id id of the core
+  @param[in]     nPE number of cores, multiple of n / BANKING_FACTOR
+  @return        none
+*/
+void mempool_cinverse_f16p(__fp16 *pG, __fp16 *pL, __fp16 *pInv,
+                           const uint32_t n, const uint32_t nBatch,
+                           const uint32_t core_id, const uint32_t nPE) {
+
+  uint32_t const nCol = CFOLD_F16_NCOL(n);
+  uint32_t const nShare = n / BANKING_FACTOR;
+  uint32_t col, itr, offset;
+
+  for (col = core_id / nShare; col < nCol; col += nPE / nShare) {
+    for (itr = col + (core_id % nShare) * nCol; itr < nBatch;
+         itr += nShare * nCol) {
+      offset = CFOLD_F16(itr, n, n);
+      mempool_cholesky_f16vecs(pG + offset, pL + offset, n, 1);
+      mempool_cinverse_f16s(pL + offset, pInv + offset, n, 1);
+    }
+  }
+  return;
+}
+
+/**
+  @brief         Batched solution of Hermitian positive-definite systems with
+  multiple right-hand sides, G * X = B, via the Cholesky decomposition
+  G = L * L' and two triangular solutions.
+  @param[in]     pA points to the folded problems [G B], of n rows and
+  n + nrhs columns
+  @param[out]    pLX points to the folded solutions [L X], of n rows and
+  n + nrhs columns
+  @param[in]     n dimension of the systems
+  @param[in]     nrhs number of right-hand sides, even
+  @param[in]     nBatch number of systems
+  @param[in]     core_id id of the core
+  @param[in]     nPE number of cores, multiple of (n + nrhs) / BANKING_FACTOR
+  @return        none
+*/
+void mempool_csolve_f16p(__fp16 *pA, __fp16 *pLX, const uint32_t n,
+                         const uint32_t nrhs, const uint32_t nBatch,
+                         const uint32_t core_id, const uint32_t nPE) {
+
+  uint32_t const nCol = CFOLD_F16_NCOL(n + nrhs);
+  uint32_t const nShare = (n + nrhs) / BANKING_FACTOR;
+  uint32_t col, itr;
+  __fp16 *pG, *pB, *pL, *pX;
+
+  for (col = core_id / nShare; col < nCol; col += nPE / nShare) {
+    for (itr = col + (core_id % nShare) * nCol; itr < nBatch;
+         itr += nShare * nCol) {
+      pG = pA + CFOLD_F16(itr, n, n + nrhs);
+      pB = pG + 2 * n;
+      pL = pLX + CFOLD_F16(itr, n, n + nrhs);
+      pX = pL + 2 * n;
+      mempool_cholesky_f16vecs(pG, pL, n, 1);
+      mempool_Ltrisol_nrhs_f16s(pL, pB, pX, n, nrhs, 0, 1);
+      mempool_Ltrisol_nrhs_f16s(pL, pX, pX, n, nrhs, 1, 1);
+    }
+  }
+  return;
+}
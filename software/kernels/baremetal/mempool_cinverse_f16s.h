@@ -0,0 +1,121 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#pragma once
+#include "builtins_v2.h"
+
+/**
+  @brief         Single-core inversion of a Hermitian positive-definite matrix
+  G = L * L', from its Cholesky factor. inv(G) = inv(L)' * inv(L), where inv(L)
+  is computed in the lower triangle of the output and then overwritten, row by
+  row from the last one, by the lower triangle of inv(G). The upper triangle is
+  its conjugate. The sums are accumulated in f32.
+  @param[in]     pL points to the lower triangular Cholesky factor
+  @param[out]    pInv points to the inverse matrix
+  @param[in]     n dimension of the matrices
+  @param[in]     folded matrices are folded with rows NUM_BANKS apart
+  @return        none
+*/
+
+void mempool_cinverse_f16s(__fp16 *pL, __fp16 *pInv, const uint32_t n,
+                           const uint32_t folded) {
+
+  uint32_t i, j, k;
+  v2h ab, cd;
+  v2h cnd, dc;
+  v2h res;
+  float as, bs;
+  float ap, bp;
+  float diag;
+  const uint32_t offset = folded ? NUM_BANKS : n;
+  const uint32_t neg_mask = 0x80000000;
+  const uint32_t shuffle_mask = 0x00020003;
+
+  // Y = inv(L), solving L * Y = I column by column
+  for (i = 0; i < n; i++) {
+    asm volatile("fcvt.s.h %0, %1;"
+                 : "=r"(diag)
+                 : "r"(pL[2U * (i * offset + i)])
+                 :);
+    diag = 1.0f / diag;
+    for (j = 0; j <= i; j++) {
+      as = 0.0f;
+      bs = 0.0f;
+      for (k = j; k < i; k++) {
+        ab = (*(v2h *)&pL[2U * (i * offset + k)]);
+        cd = (*(v2h *)&pInv[2U * (k * offset + j)]);
+        asm volatile(
+            // s = s + (ac - bd) + j(ad + bc)
+            "xor           %[cnd], %[neg_mask], %[cd];"
+            "pv.shuffle2.h %[dc],  %[cd], %[shuffle_mask];"
+            "vfdotpex.s.h  %[as],  %[ab], %[cnd];"
+            "vfdotpex.s.h  %[bs],  %[ab], %[dc];"
+            : [as] "+&r"(as), [bs] "+&r"(bs), [cnd] "=&r"(cnd),
+              [dc] "=&r"(dc)
+            : [ab] "r"(ab), [cd] "r"(cd), [neg_mask] "r"(neg_mask),
+              [shuffle_mask] "r"(shuffle_mask)
+            :);
+      }
+      as = ((i == j) ? (1.0f - as) : -as) * diag;
+      bs = -bs * diag;
+      asm volatile("vfcpka.h.s %0, %1, %2;" : "=r"(res) : "r"(as), "r"(bs) :);
+      (*(v2h *)&pInv[2U * (i * offset + j)]) = res;
+    }
+  }
+
+  // X = inv(L') * Y, solving L' * X = Y from the last row
+  for (i = 0; i < n; i++) {
+    uint32_t ridx = n - i - 1;
+    asm volatile("fcvt.s.h %0, %1;"
+                 : "=r"(diag)
+                 : "r"(pL[2U * (ridx * offset + ridx)])
+                 :);
+    diag = 1.0f / diag;
+    for (j = 0; j <= ridx; j++) {
+      as = 0.0f;
+      bs = 0.0f;
+      for (k = ridx + 1; k < n; k++) {
+        ab = (*(v2h *)&pL[2U * (k * offset + ridx)]);
+        cd = (*(v2h *)&pInv[2U * (k * offset + j)]);
+        asm volatile(
+            // s = s + (ac + bd) + j(ad - bc)
+            "xor           %[ab],  %[neg_mask], %[ab];"
+            "xor           %[cnd], %[neg_mask], %[cd];"
+            "pv.shuffle2.h %[dc],  %[cd], %[shuffle_mask];"
+            "vfdotpex.s.h  %[as],  %[ab], %[cnd];"
+            "vfdotpex.s.h  %[bs],  %[ab], %[dc];"
+            : [as] "+&r"(as), [bs] "+&r"(bs), [ab] "+&r"(ab),
+              [cnd] "=&r"(cnd), [dc] "=&r"(dc)
+            : [cd] "r"(cd), [neg_mask] "r"(neg_mask),
+              [shuffle_mask] "r"(shuffle_mask)
+            :);
+      }
+      asm volatile("fcvt.s.h %0, %1;"
+                   : "=r"(ap)
+                   : "r"(pInv[2U * (ridx * offset + j)])
+                   :);
+      asm volatile("fcvt.s.h %0, %1;"
+                   : "=r"(bp)
+                   : "r"(pInv[2U * (ridx * offset + j) + 1])
+                   :);
+      as = (ap - as) * diag;
+      bs = (bp - bs) * diag;
+      asm volatile("vfcpka.h.s %0, %1, %2;" : "=r"(res) : "r"(as), "r"(bs) :);
+      (*(v2h *)&pInv[2U * (ridx * offset + j)]) = res;
+    }
+  }
+
+  // Upper triangle, the diagonal is real
+  for (i = 0; i < n; i++) {
+    pInv[2U * (i * offset + i) + 1] = (__fp16)0.0f;
+    for (j = 0; j < i; j++) {
+      res = (*(v2h *)&pInv[2U * (i * offset + j)]);
+      asm volatile("xor %0, %1, %0;" : "+&r"(res) : "r"(neg_mask) :);
+      (*(v2h *)&pInv[2U * (j * offset + i)]) = res;
+    }
+  }
+  return;
+}
@@ -0,0 +1,116 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#pragma once
+#ifdef __XDIVSQRT
+
+/**
+  @brief         Single-core inversion of a Hermitian positive-definite matrix
+  G = L * L', from its Cholesky factor. inv(G) = inv(L)' * inv(L), where inv(L)
+  is computed in the lower triangle of the output and then overwritten, row by
+  row from the last one, by the lower triangle of inv(G). The upper triangle is
+  its conjugate.
+  @param[in]     pL points to the lower triangular Cholesky factor
+  @param[out]    pInv points to the inverse matrix
+  @param[in]     n dimension of the matrices
+  @param[in]     folded matrices are folded with rows NUM_BANKS apart
+  @return        none
+*/
+
+void mempool_cinverse_f32s(float *pL, float *pInv, const uint32_t n,
+                           const uint32_t folded) {
+
+  uint32_t i, j, k;
+  float a, b;
+  float c, d;
+  float as, bs;
+  float diag;
+  const uint32_t offset = folded ? NUM_BANKS : n;
+
+  // Y = inv(L), solving L * Y = I column by column
+  for (i = 0; i < n; i++) {
+    diag = pL[2U * (i * offset + i)];
+    asm volatile("fdiv.s %[diag], %[one], %[diag];"
+                 : [diag] "+&r"(diag)
+                 : [one] "r"(1.0f)
+                 :);
+    for (j = 0; j <= i; j++) {
+      as = (i == j) ? 1.0f : 0.0f;
+      bs = 0.0f;
+      for (k = j; k < i; k++) {
+        a = pL[2U * (i * offset + k)];
+        b = pL[2U * (i * offset + k) + 1];
+        c = pInv[2U * (k * offset + j)];
+        d = pInv[2U * (k * offset + j) + 1];
+        asm volatile("fnmsub.s %[as], %[a], %[c], %[as];"
+                     "fnmsub.s %[bs], %[a], %[d], %[bs];"
+                     "fmadd.s  %[as], %[b], %[d], %[as];"
+                     "fnmsub.s %[bs], %[b], %[c], %[bs];"
+                     : [as] "+&r"(as), [bs] "+&r"(bs)
+                     : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                     :);
+      }
+      asm volatile("fmul.s %[as], %[as], %[diag];"
+                   "fmul.s %[bs], %[bs], %[diag];"
+                   : [as] "+&r"(as), [bs] "+&r"(bs)
+                   : [diag] "r"(diag)
+                   :);
+      pInv[2U * (i * offset + j)] = as;
+      pInv[2U * (i * offset + j) + 1] = bs;
+    }
+  }
+
+  // X = inv(L') * Y, solving L' * X = Y from the last row
+  for (i = 0; i < n; i++) {
+    uint32_t ridx = n - i - 1;
+    diag = pL[2U * (ridx * offset + ridx)];
+    asm volatile("fdiv.s %[diag], %[one], %[diag];"
+                 : [diag] "+&r"(diag)
+                 : [one] "r"(1.0f)
+                 :);
+    for (j = 0; j <= ridx; j++) {
+      as = pInv[2U * (ridx * offset + j)];
+      bs = pInv[2U * (ridx * offset + j) + 1];
+      for (k = ridx + 1; k < n; k++) {
+        // Conjugate of L[k][ridx]
+        a = pL[2U * (k * offset + ridx)];
+        b = -pL[2U * (k * offset + ridx) + 1];
+        c = pInv[2U * (k * offset + j)];
+        d = pInv[2U * (k * offset + j) + 1];
+        asm volatile("fnmsub.s %[as], %[a], %[c], %[as];"
+                     "fnmsub.s %[bs], %[a], %[d], %[bs];"
+                     "fmadd.s  %[as], %[b], %[d], %[as];"
+                     "fnmsub.s %[bs], %[b], %[c], %[bs];"
+                     : [as] "+&r"(as), [bs] "+&r"(bs)
+                     : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                     :);
+      }
+      asm volatile("fmul.s %[as], %[as], %[diag];"
+                   "fmul.s %[bs], %[bs], %[diag];"
+                   : [as] "+&r"(as), [bs] "+&r"(bs)
+                   : [diag] "r"(diag)
+                   :);
+      pInv[2U * (ridx * offset + j)] = as;
+      pInv[2U * (ridx * offset + j) + 1] = bs;
+    }
+  }
+
+  // Upper triangle, the diagonal is real
+  for (i = 0; i < n; i++) {
+    pInv[2U * (i * offset + i) + 1] = 0.0f;
+    for (j = 0; j < i; j++) {
+      pInv[2U * (j * offset + i)] = pInv[2U * (i * offset + j)];
+      pInv[2U * (j * offset + i) + 1] = -pInv[2U * (i * offset + j) + 1];
+    }
+  }
+  return;
+}
+
+#else
+
+#error "ERROR: f32 MMSE functions available only for __XDIVSQRT."
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Frequency-domain 2D convolution on 32b floating point data. The cost does not
+depend on the size of the filter, so that for large filters it is cheaper than
+the direct convolution of mempool_conv2d_i32p.h.
+- The image and the filter are transformed with a 2D FFT, leaving the spectra
+transposed.
+- The spectra are multiplied and conjugated, and scaled by 1 / (nRows nCols).
+- The inverse is the 2D FFT of the conjugated product: on the transposed
+spectrum it returns the result in the original layout.
+The kernel computes the circular convolution of the image with pKer.
+conv2d_parallel computes the correlation
+out[i][j] = sum_(m,n) img[i + m][j + n] k[m][n] / sum_(m,n) k[m][n].
+To match it, up to the division by the sum of the weights, which this kernel
+does not apply, the filter k must be stored flipped and wrapped in a
+nRows x nCols matrix of zeros, with pKer[(-m) % nRows][(-n) % nCols] = k[m][n]
+for the offsets m, n from the center of k, as generate_fconv2d_fft does. An
+unflipped filter returns the convolution with k instead, which differs for
+asymmetric filters.
+Re and Im parts are interleaved, the result is in the real part of pImg.
+*/
+
+#pragma once
+#include "baremetal/mempool_cfft2d_f32p.h"
+
+/**
+  @brief         Parallel frequency-domain 2D convolution.
+  @param[in]     pImg points to the image, holds the result
+  @param[in]     pKer points to the filter, overwritten with its spectrum
+  @param[in]     pTmp points to a buffer of the same size of pImg
+  @param[in]     nRows number of rows of the image
+  @param[in]     nCols number of columns of the image
+  @param[in]     pCoefRow points to the twiddles of the FFTs of the rows
+  @param[in]     pRadixRow points to the radices of the FFTs of the rows
+  @param[in]     nStagesRow number of stages of the FFTs of the rows
+  @param[in]     pDigitRevRow points to the digit reversal table of the rows
+  @param[in]     pCoefCol points to the twiddles of the FFTs of the columns
+  @param[in]     pRadixCol points to the radices of the FFTs of the columns
+  @param[in]     nStagesCol number of stages of the FFTs of the columns
+  @param[in]     pDigitRevCol points to the digit reversal table of the columns
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_conv2d_fft_f32p(
+    float *pImg, float *pKer, float *pTmp, const uint32_t nRows,
+    const uint32_t nCols, const float *pCoefRow, const uint32_t *pRadixRow,
+    const uint32_t nStagesRow, const uint16_t *pDigitRevRow,
+    const float *pCoefCol, const uint32_t *pRadixCol, const uint32_t nStagesCol,
+    const uint16_t *pDigitRevCol, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  float scale = 1.0f / (float)(nRows * nCols);
+  float a, b, c, d;
+  uint32_t i;
+
+  /* FORWARD TRANSFORMS */
+  mempool_cfft2d_f32p(pImg, pTmp, nRows, nCols, pCoefRow, pRadixRow,
+                      nStagesRow, pDigitRevRow, pCoefCol, pRadixCol,
+                      nStagesCol, pDigitRevCol, 1, nPE);
+  mempool_cfft2d_f32p(pKer, pTmp, nRows, nCols, pCoefRow, pRadixRow,
+                      nStagesRow, pDigitRevRow, pCoefCol, pRadixCol,
+                      nStagesCol, pDigitRevCol, 1, nPE);
+
+  /* PRODUCT OF THE SPECTRA */
+  for (i = core_id; i < nRows * nCols; i += nPE) {
+    a = pImg[2U * i];
+    b = pImg[2U * i + 1U];
+    c = pKer[2U * i];
+    d = pKer[2U * i + 1U];
+    // conj((a + jb)(c + jd)) / (nRows nCols)
+    pImg[2U * i] = scale * (a * c - b * d);
+    pImg[2U * i + 1U] = -scale * (a * d + b * c);
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+  /* INVERSE TRANSFORM, on the nCols x nRows transposed spectrum */
+  mempool_cfft2d_f32p(pImg, pTmp, nCols, nRows, pCoefCol, pRadixCol,
+                      nStagesCol, pDigitRevCol, pCoefRow, pRadixRow,
+                      nStagesRow, pDigitRevRow, 1, nPE);
+  return;
+}
@@ -0,0 +1,92 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel polyphase FIR filter, decimator and interpolator on 16b floating
+point data, same scheme as mempool_fir_q16p.h. Pairs of taps and of samples
+are multiplied and accumulated in f32 with vfdotpex.s.h.
+*/
+
+#pragma once
+#include "baremetal/mempool_fir_polyphase.h"
+#include "builtins_v2.h"
+
+/**
+  @brief         Parallel polyphase resampler by L / D.
+  @param[in]     pSrc points to the input, word aligned. It is preceded by at
+  least nTaps / L samples of history, and followed by FIR_TAIL zero samples
+  @param[in]     pCoeffs points to the replicated polyphase coefficients
+  @param[out]    pDst points to the nOut outputs
+  @param[in]     nOut number of outputs
+  @param[in]     nTaps number of taps, multiple of 2 * L
+  @param[in]     L interpolation factor
+  @param[in]     D decimation factor
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_fir_f16p(const __fp16 *pSrc, const int32_t *pCoeffs, __fp16 *pDst,
+                      const uint32_t nOut, const uint32_t nTaps,
+                      const uint32_t L, const uint32_t D, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t nTapsPhase = nTaps / L;
+  uint32_t nWords = FIR_WORDS(nTapsPhase);
+  uint32_t nRows = FIR_ROWS(nTapsPhase);
+  uint32_t start = (nOut / nPE) * core_id + ((nOut % nPE) * core_id) / nPE;
+  uint32_t end = (nOut / nPE) * (core_id + 1) +
+                 ((nOut % nPE) * (core_id + 1)) / nPE;
+  uint32_t n, w, j, len, m, p, q;
+  int32_t s;
+  float acc0, acc1;
+  __fp16 res;
+  const v2h *px;
+  const v2h *pc;
+
+  // Local copy of the coefficients
+  pCoeffs += (mempool_get_tile_id() * FIR_TILE_BANKS) % NUM_BANKS;
+  // Newest input sample and phase of the first output
+  m = (start * D) / L;
+  p = (start * D) % L;
+  for (n = start; n < end; n++) {
+    // First input sample, and set of coefficients for its parity
+    s = (int32_t)m - (int32_t)nTapsPhase + 1;
+    q = (uint32_t)s & 1U;
+    px = (const v2h *)(pSrc + s - (int32_t)q);
+    pc = (const v2h *)(pCoeffs + (2 * p + q) * nRows * NUM_BANKS);
+    acc0 = 0.0f;
+    acc1 = 0.0f;
+    for (w = 0; w < nWords; w += FIR_TILE_BANKS) {
+      len = nWords - w;
+      len = len > FIR_TILE_BANKS ? FIR_TILE_BANKS : len;
+      for (j = 0; j < len; j += 2) {
+        asm volatile("vfdotpex.s.h %[acc0], %[x0], %[c0];"
+                     "vfdotpex.s.h %[acc1], %[x1], %[c1];"
+                     : [acc0] "+&r"(acc0), [acc1] "+&r"(acc1)
+                     : [x0] "r"(px[j]), [c0] "r"(pc[j]), [x1] "r"(px[j + 1]),
+                       [c1] "r"(pc[j + 1])
+                     :);
+      }
+      px += FIR_TILE_BANKS;
+      pc += NUM_BANKS;
+    }
+    asm volatile("fadd.s   %[acc0], %[acc0], %[acc1];"
+                 "fcvt.h.s %[res], %[acc0];"
+                 : [acc0] "+&r"(acc0), [res] "=r"(res)
+                 : [acc1] "r"(acc1)
+                 :);
+    pDst[n] = res;
+    // Next output
+    p += D;
+    while (p >= L) {
+      p -= L;
+      m++;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
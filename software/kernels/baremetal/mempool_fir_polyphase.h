@@ -0,0 +1,85 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Coefficients of the polyphase FIR kernels on 16b data (mempool_fir_q16p.h and
+mempool_fir_f16p.h).
+
+The resampler by L / D computes y[n] = sum_j h[j * L + p] x[m - j], for
+j < nTaps / L, with m = (n * D) / L and p = (n * D) % L. L = D = 1 is a FIR
+filter, L = 1 a decimator and D = 1 an interpolator.
+
+The taps of phase p are reversed and packed in pairs, so that the output is
+the dot-product of FIR_WORDS words of coefficients and of consecutive words of
+the input. The input words are aligned, so each phase has two sets of
+coefficients: set 2p for the outputs whose first input sample is even, and set
+2p + 1, shifted by one sample, for odd ones.
+
+Each set is replicated in the local banks of every tile. The word w of a set is
+in row w / FIR_TILE_BANKS, and each row spans all the banks, with the copy of
+tile t in the banks t * FIR_TILE_BANKS ... (t + 1) * FIR_TILE_BANKS - 1.
+*/
+
+#pragma once
+
+#define FIR_TILE_BANKS (NUM_CORES_PER_TILE * BANKING_FACTOR)
+
+// Words of a set of coefficients for nTapsPhase taps (even), at least one
+// zero sample is added to shift the odd sets, and the words are even
+#define FIR_WORDS(nTapsPhase) ((((nTapsPhase) / 2) + 2) & ~1U)
+// Rows of a set of coefficients
+#define FIR_ROWS(nTapsPhase)                                                   \
+  ((FIR_WORDS(nTapsPhase) + FIR_TILE_BANKS - 1) / FIR_TILE_BANKS)
+// Words of the replicated coefficients of a resampler
+#define FIR_COEFF_WORDS(nTaps, L)                                              \
+  (2 * (L)*FIR_ROWS((nTaps) / (L)) * NUM_BANKS)
+// Zero samples the kernels read after the last input
+#define FIR_TAIL 4
+
+/**
+  @brief         Parallel construction of the polyphase coefficients,
+  replicated in each tile.
+  @param[in]     pH points to the nTaps taps, 16b samples
+  @param[in]     nTaps number of taps, multiple of 2 * L
+  @param[in]     L interpolation factor
+  @param[out]    pCoeffs points to the FIR_COEFF_WORDS(nTaps, L) words of the
+  coefficients, the first word is in bank 0
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_fir_polyphase_init(const uint16_t *pH, const uint32_t nTaps,
+                                const uint32_t L, uint32_t *pCoeffs,
+                                const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t nTapsPhase = nTaps / L;
+  uint32_t nWords = FIR_WORDS(nTapsPhase);
+  uint32_t nRows = FIR_ROWS(nTapsPhase);
+  uint32_t i, set, w, k, t, idx, word;
+  int32_t j;
+
+  for (i = core_id; i < 2 * L * nWords; i += nPE) {
+    set = i / nWords;
+    w = i % nWords;
+    word = 0;
+    for (k = 0; k < 2; k++) {
+      // Reversed tap of phase set / 2, shifted by set % 2 samples
+      j = (int32_t)(2 * w + k) - (int32_t)(set & 1U);
+      if (j >= 0 && j < (int32_t)nTapsPhase) {
+        word |= (uint32_t)pH[(nTapsPhase - 1 - (uint32_t)j) * L + (set >> 1U)]
+                << (16 * k);
+      }
+    }
+    idx = (set * nRows + w / FIR_TILE_BANKS) * NUM_BANKS + w % FIR_TILE_BANKS;
+    for (t = 0; t < NUM_BANKS; t += FIR_TILE_BANKS) {
+      pCoeffs[idx + t] = word;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
@@ -0,0 +1,85 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel polyphase FIR filter, decimator and interpolator on Q15 data, the
+coefficients are built by mempool_fir_polyphase_init.
+The outputs are split in contiguous blocks over the cores, and the block of
+each core reads nTaps / L - 1 input samples before its first one (the halo),
+which overlap with the block of the previous core. Pairs of taps and of
+samples are multiplied and accumulated with pv.sdotsp.h, reading the
+coefficients from the local banks of the tile of the core.
+*/
+
+#pragma once
+#include "baremetal/mempool_fir_polyphase.h"
+#include "builtins_v2.h"
+
+/**
+  @brief         Parallel polyphase resampler by L / D.
+  @param[in]     pSrc points to the input, word aligned. It is preceded by at
+  least nTaps / L samples of history, and followed by FIR_TAIL zero samples
+  @param[in]     pCoeffs points to the replicated polyphase coefficients
+  @param[out]    pDst points to the nOut outputs
+  @param[in]     nOut number of outputs
+  @param[in]     nTaps number of taps, multiple of 2 * L
+  @param[in]     L interpolation factor
+  @param[in]     D decimation factor
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_fir_q16p(const int16_t *pSrc, const int32_t *pCoeffs,
+                      int16_t *pDst, const uint32_t nOut, const uint32_t nTaps,
+                      const uint32_t L, const uint32_t D, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t nTapsPhase = nTaps / L;
+  uint32_t nWords = FIR_WORDS(nTapsPhase);
+  uint32_t nRows = FIR_ROWS(nTapsPhase);
+  uint32_t start = (nOut / nPE) * core_id + ((nOut % nPE) * core_id) / nPE;
+  uint32_t end = (nOut / nPE) * (core_id + 1) +
+                 ((nOut % nPE) * (core_id + 1)) / nPE;
+  uint32_t n, w, j, len, m, p, q;
+  int32_t s, acc0, acc1;
+  const v2s *px;
+  const v2s *pc;
+
+  // Local copy of the coefficients
+  pCoeffs += (mempool_get_tile_id() * FIR_TILE_BANKS) % NUM_BANKS;
+  // Newest input sample and phase of the first output
+  m = (start * D) / L;
+  p = (start * D) % L;
+  for (n = start; n < end; n++) {
+    // First input sample, and set of coefficients for its parity
+    s = (int32_t)m - (int32_t)nTapsPhase + 1;
+    q = (uint32_t)s & 1U;
+    px = (const v2s *)(pSrc + s - (int32_t)q);
+    pc = (const v2s *)(pCoeffs + (2 * p + q) * nRows * NUM_BANKS);
+    acc0 = 0;
+    acc1 = 0;
+    for (w = 0; w < nWords; w += FIR_TILE_BANKS) {
+      len = nWords - w;
+      len = len > FIR_TILE_BANKS ? FIR_TILE_BANKS : len;
+      for (j = 0; j < len; j += 2) {
+        acc0 = __SUMDOTP2(px[j], pc[j], acc0);
+        acc1 = __SUMDOTP2(px[j + 1], pc[j + 1], acc1);
+      }
+      px += FIR_TILE_BANKS;
+      pc += NUM_BANKS;
+    }
+    pDst[n] = (int16_t)__CLIP((acc0 + acc1) >> 15, 15);
+    // Next output
+    p += D;
+    while (p >= L) {
+      p -= L;
+      m++;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
@@ -0,0 +1,151 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Per-tile histograms and equalization LUTs of the histogram kernels
+(mempool_histogram_i8p.h and mempool_histogram_i16p.h).
+
+Each tile keeps private bins in its local banks, so the cores of a tile
+update them with atomics in their own tile, and no bank is shared by the whole
+cluster. Bin b of tile t is in row b / HIST_TILE_BANKS and bank
+t * HIST_TILE_BANKS + b % HIST_TILE_BANKS, with a row every NUM_BANKS words.
+The private histograms are merged pairwise into tile 0, first between
+neighbouring tiles of a group and last across groups. The equalization LUT is
+replicated in each tile with the same layout.
+
+*/
+
+#pragma once
+
+#define HIST_TILE_BANKS (NUM_CORES_PER_TILE * BANKING_FACTOR)
+// Rows of the copy of a tile
+#define HIST_ROWS(nBins) (((nBins) + HIST_TILE_BANKS - 1) / HIST_TILE_BANKS)
+// Words of the bins or of the LUT of all the tiles
+#define HIST_WORDS(nBins) (HIST_ROWS(nBins) * NUM_BANKS)
+// Offset of bin b in the copy of a tile
+#define HIST_IDX(b)                                                            \
+  (((b) / HIST_TILE_BANKS) * NUM_BANKS + (b) % HIST_TILE_BANKS)
+
+/**
+  @brief         Parallel reset of the per-tile bins, each core clears its
+  local banks.
+  @param[out]    pBins points to the HIST_WORDS(nBins) words of the bins, the
+  first word is in bank 0
+  @param[in]     nBins number of bins
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_init(uint32_t *pBins, const uint32_t nBins,
+                            const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t r, k;
+
+  for (r = 0; r < HIST_ROWS(nBins); r++) {
+    for (k = 0; k < BANKING_FACTOR; k++) {
+      pBins[r * NUM_BANKS + core_id * BANKING_FACTOR + k] = 0;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
+
+/**
+  @brief         Parallel tree merge of the per-tile bins into tile 0. At step
+  s tile t, multiple of 2 * s, adds the bins of tile t + s. Each core adds the
+  bins in its local banks, and the tiles of a merge synchronize with a partial
+  barrier.
+  @param[in,out] pBins points to the per-tile bins
+  @param[in]     nBins number of bins
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_merge(uint32_t *pBins, const uint32_t nBins,
+                             const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t tile_id = core_id / NUM_CORES_PER_TILE;
+  uint32_t nTiles = nPE / NUM_CORES_PER_TILE;
+  uint32_t step, r, k, idx;
+
+  for (step = 1; step < nTiles; step *= 2) {
+    // Wait for the tiles of the merge
+    mempool_log_partial_barrier(2, absolute_core_id,
+                                2 * step * NUM_CORES_PER_TILE);
+    if (tile_id % (2 * step) == 0) {
+      for (r = 0; r < HIST_ROWS(nBins); r++) {
+        idx = r * NUM_BANKS + core_id * BANKING_FACTOR;
+        for (k = 0; k < BANKING_FACTOR; k++) {
+          pBins[idx + k] += pBins[idx + k + step * HIST_TILE_BANKS];
+        }
+      }
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
+
+/**
+  @brief         Parallel histogram-equalization LUT. The LUT maps bin b to
+  round((cdf[b] - cdf_min) * maxVal / (nPixels - cdf_min)), where cdf_min is
+  the first non-zero value of the cumulative histogram.
+  @param[in]     pBins points to the per-tile bins, merged in tile 0
+  @param[out]    pCdf points to nBins + 1 words for the cumulative histogram
+  and cdf_min
+  @param[out]    pLut points to the HIST_WORDS(nBins) words of the LUT,
+  replicated in each tile
+  @param[in]     nBins number of bins
+  @param[in]     nPixels number of pixels of the histogram
+  @param[in]     maxVal maximum output value
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_lut(uint32_t *pBins, uint32_t *pCdf, uint32_t *pLut,
+                           const uint32_t nBins, const uint32_t nPixels,
+                           const uint32_t maxVal, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t nTiles = nPE / NUM_CORES_PER_TILE;
+  uint32_t b, t, sum, cdf_min, den, val;
+
+  // Cumulative histogram on the local bins of tile 0
+  if (core_id == 0) {
+    sum = 0;
+    cdf_min = 0;
+    for (b = 0; b < nBins; b++) {
+      sum += pBins[HIST_IDX(b)];
+      pCdf[b] = sum;
+      if (cdf_min == 0) {
+        cdf_min = sum;
+      }
+    }
+    pCdf[nBins] = cdf_min;
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+  cdf_min = pCdf[nBins];
+  den = nPixels - cdf_min;
+  for (b = core_id; b < nBins; b += nPE) {
+    if (den == 0) {
+      // Constant image
+      val = (b * maxVal) / (nBins - 1);
+    } else if (pCdf[b] < cdf_min) {
+      val = 0;
+    } else {
+      val = (uint32_t)(((uint64_t)(pCdf[b] - cdf_min) * maxVal + den / 2) /
+                       den);
+    }
+    for (t = 0; t < nTiles; t++) {
+      pLut[HIST_IDX(b) + t * HIST_TILE_BANKS] = val;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
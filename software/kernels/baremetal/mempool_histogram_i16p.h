@@ -0,0 +1,79 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#pragma once
+#include "baremetal/mempool_histogram.h"
+
+/**
+  @brief         Parallel histogram of 16b pixels in 65536 >> shift per-tile
+  bins. Each core processes the words of its local banks.
+  @param[in]     pSrc points to the pixels, 2 per word, the first word is in
+  bank 0
+  @param[in]     nWords number of words, multiple of BANKING_FACTOR
+  @param[in,out] pBins points to the HIST_WORDS(65536 >> shift) words of the
+  bins
+  @param[in]     shift pixel bits dropped to index the bins
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_i16p(const uint32_t *pSrc, const uint32_t nWords,
+                            uint32_t *pBins, const uint32_t shift,
+                            const uint32_t nPE) {
+
+  uint32_t core_id = mempool_get_core_id() % nPE;
+  uint32_t *pTile = pBins + (core_id / NUM_CORES_PER_TILE) * HIST_TILE_BANKS;
+  uint32_t const mask = 0xFFFFU >> shift;
+  uint32_t i, k, word;
+  uint32_t p0, p1;
+
+  for (i = core_id * BANKING_FACTOR; i < nWords; i += nPE * BANKING_FACTOR) {
+    for (k = 0; k < BANKING_FACTOR; k++) {
+      word = pSrc[i + k];
+      p0 = (word >> shift) & mask;
+      p1 = word >> (16 + shift);
+      __atomic_fetch_add(&pTile[HIST_IDX(p0)], 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&pTile[HIST_IDX(p1)], 1, __ATOMIC_RELAXED);
+    }
+  }
+  return;
+}
+
+/**
+  @brief         Parallel histogram equalization of 16b pixels with the LUT
+  replicated in each tile.
+  @param[in]     pSrc points to the pixels, 2 per word, the first word is in
+  bank 0
+  @param[out]    pDst points to the equalized pixels, can be pSrc
+  @param[in]     nWords number of words, multiple of BANKING_FACTOR
+  @param[in]     pLut points to the HIST_WORDS(65536 >> shift) words of the
+  LUT
+  @param[in]     shift pixel bits dropped to index the LUT
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_equalize_i16p(const uint32_t *pSrc, uint32_t *pDst,
+                                     const uint32_t nWords,
+                                     const uint32_t *pLut,
+                                     const uint32_t shift,
+                                     const uint32_t nPE) {
+
+  uint32_t core_id = mempool_get_core_id() % nPE;
+  const uint32_t *pTile =
+      pLut + (core_id / NUM_CORES_PER_TILE) * HIST_TILE_BANKS;
+  uint32_t const mask = 0xFFFFU >> shift;
+  uint32_t i, k, word;
+  uint32_t p0, p1;
+
+  for (i = core_id * BANKING_FACTOR; i < nWords; i += nPE * BANKING_FACTOR) {
+    for (k = 0; k < BANKING_FACTOR; k++) {
+      word = pSrc[i + k];
+      p0 = pTile[HIST_IDX((word >> shift) & mask)];
+      p1 = pTile[HIST_IDX(word >> (16 + shift))];
+      pDst[i + k] = p0 | (p1 << 16);
+    }
+  }
+  return;
+}
@@ -0,0 +1,78 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+#pragma once
+#include "baremetal/mempool_histogram.h"
+#include "builtins_v2.h"
+
+/**
+  @brief         Parallel histogram of 8b pixels in 256 per-tile bins. Each
+  core processes the words of its local banks and extracts the pixels with
+  p.extractu.
+  @param[in]     pSrc points to the pixels, 4 per word, the first word is in
+  bank 0
+  @param[in]     nWords number of words, multiple of BANKING_FACTOR
+  @param[in,out] pBins points to the HIST_WORDS(256) words of the bins
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_i8p(const uint32_t *pSrc, const uint32_t nWords,
+                           uint32_t *pBins, const uint32_t nPE) {
+
+  uint32_t core_id = mempool_get_core_id() % nPE;
+  uint32_t *pTile = pBins + (core_id / NUM_CORES_PER_TILE) * HIST_TILE_BANKS;
+  uint32_t i, k, word;
+  uint32_t p0, p1, p2, p3;
+
+  for (i = core_id * BANKING_FACTOR; i < nWords; i += nPE * BANKING_FACTOR) {
+    for (k = 0; k < BANKING_FACTOR; k++) {
+      word = pSrc[i + k];
+      p0 = __BITEXTRACTU(word, 8, 0);
+      p1 = __BITEXTRACTU(word, 8, 8);
+      p2 = __BITEXTRACTU(word, 8, 16);
+      p3 = __BITEXTRACTU(word, 8, 24);
+      __atomic_fetch_add(&pTile[HIST_IDX(p0)], 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&pTile[HIST_IDX(p1)], 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&pTile[HIST_IDX(p2)], 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&pTile[HIST_IDX(p3)], 1, __ATOMIC_RELAXED);
+    }
+  }
+  return;
+}
+
+/**
+  @brief         Parallel histogram equalization of 8b pixels with the LUT
+  replicated in each tile.
+  @param[in]     pSrc points to the pixels, 4 per word, the first word is in
+  bank 0
+  @param[out]    pDst points to the equalized pixels, can be pSrc
+  @param[in]     nWords number of words, multiple of BANKING_FACTOR
+  @param[in]     pLut points to the HIST_WORDS(256) words of the LUT
+  @param[in]     nPE number of cores, power of two multiple of the tile size
+  @return        none
+*/
+void mempool_histogram_equalize_i8p(const uint32_t *pSrc, uint32_t *pDst,
+                                    const uint32_t nWords,
+                                    const uint32_t *pLut, const uint32_t nPE) {
+
+  uint32_t core_id = mempool_get_core_id() % nPE;
+  const uint32_t *pTile =
+      pLut + (core_id / NUM_CORES_PER_TILE) * HIST_TILE_BANKS;
+  uint32_t i, k, word;
+  uint32_t p0, p1, p2, p3;
+
+  for (i = core_id * BANKING_FACTOR; i < nWords; i += nPE * BANKING_FACTOR) {
+    for (k = 0; k < BANKING_FACTOR; k++) {
+      word = pSrc[i + k];
+      p0 = pTile[HIST_IDX(__BITEXTRACTU(word, 8, 0))];
+      p1 = pTile[HIST_IDX(__BITEXTRACTU(word, 8, 8))];
+      p2 = pTile[HIST_IDX(__BITEXTRACTU(word, 8, 16))];
+      p3 = pTile[HIST_IDX(__BITEXTRACTU(word, 8, 24))];
+      pDst[i + k] = p0 | (p1 << 8) | (p2 << 16) | (p3 << 24);
+    }
+  }
+  return;
+}
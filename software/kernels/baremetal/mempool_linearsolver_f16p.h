@@ -0,0 +1,133 @@
+// Copyright 2021 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Blocked solution of a lower triangular system, matching the panels of
+mempool_cholesky_f16vecp. Same scheme as mempool_Ltrisol_f32p, the division by
+the diagonal is computed in f32.
+*/
+
+#pragma once
+#include "builtins_v2.h"
+
+#ifndef CHOLESKY_BLOCK
+#define CHOLESKY_BLOCK (4)
+#endif
+
+/**
+  @brief         Subtract the product of an element of L and a solution.
+  @param[in]     pL points to the element of the triangular matrix
+  @param[in]     px points to the solved variable
+  @param[in,out] as real part of the known variable
+  @param[in,out] bs imaginary part of the known variable
+  @param[in]     transposed use the conjugate of the element of L
+  @return        none
+*/
+static inline void mempool_Ltrisol_f16p_mac(__fp16 *pL, __fp16 *px,
+                                            __fp16 *as, __fp16 *bs,
+                                            const uint32_t transposed) {
+  __fp16 a = pL[0];
+  __fp16 b = pL[1];
+  __fp16 c = px[0];
+  __fp16 d = px[1];
+  __fp16 ar = *as;
+  __fp16 br = *bs;
+  if (transposed) {
+    asm volatile("fnmsub.h  %[ar], %[a], %[c], %[ar];"
+                 "fnmsub.h  %[ar], %[b], %[d], %[ar];"
+                 "fnmsub.h  %[br], %[a], %[d], %[br];"
+                 "fmadd.h   %[br], %[b], %[c], %[br];"
+                 : [ar] "+&r"(ar), [br] "+&r"(br)
+                 : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                 :);
+  } else {
+    asm volatile("fnmsub.h  %[ar], %[a], %[c], %[ar];"
+                 "fnmsub.h  %[br], %[a], %[d], %[br];"
+                 "fmadd.h   %[ar], %[b], %[d], %[ar];"
+                 "fnmsub.h  %[br], %[b], %[c], %[br];"
+                 : [ar] "+&r"(ar), [br] "+&r"(br)
+                 : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                 :);
+  }
+  *as = ar;
+  *bs = br;
+  return;
+}
+
+/**
+  @brief         Parallel solution of lower triangular system
+  @param[in]     pL input triangular matrix
+  @param[in]     in known variables vector
+  @param[in]     x unknown solutions vector
+  @param[in]     n dimension of the system
+  @param[in]     transposed solve transposed (hermitian) system
+  @param[in]     nPE number of cores
+  @return        none
+*/
+
+void mempool_Ltrisol_f16p(__fp16 *pL, __fp16 *in, __fp16 *x, const uint32_t n,
+                          const uint32_t transposed, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t blk, i, k, kb, ridx, cidx, lidx;
+  __fp16 as, bs, diag;
+  float ax, bx, diag_f32;
+  v2h res;
+
+  for (i = core_id; i < n; i += nPE) {
+    (*(v2h *)&x[2U * i]) = (*(v2h *)&in[2U * i]);
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+  for (blk = 0; blk < n; blk += CHOLESKY_BLOCK) {
+    // The transposed system is solved backwards
+    kb = transposed ? (n - blk - CHOLESKY_BLOCK) : blk;
+
+    // Diagonal block
+    if (core_id == (blk / CHOLESKY_BLOCK) % nPE) {
+      for (i = 0; i < CHOLESKY_BLOCK; i++) {
+        ridx = transposed ? (kb + CHOLESKY_BLOCK - 1 - i) : (kb + i);
+        diag = pL[2U * (ridx * n + ridx)];
+        as = x[2U * ridx];
+        bs = x[2U * ridx + 1];
+        for (k = 0; k < i; k++) {
+          cidx = transposed ? (kb + CHOLESKY_BLOCK - 1 - k) : (kb + k);
+          lidx = transposed ? (cidx * n + ridx) : (ridx * n + cidx);
+          mempool_Ltrisol_f16p_mac(&pL[2U * lidx], &x[2U * cidx], &as, &bs,
+                                   transposed);
+        }
+        asm volatile("fcvt.s.h %0, %1;" : "=r"(diag_f32) : "r"(diag) :);
+        asm volatile("fcvt.s.h %0, %1;" : "=r"(ax) : "r"(as) :);
+        asm volatile("fcvt.s.h %0, %1;" : "=r"(bx) : "r"(bs) :);
+        ax = ax / diag_f32;
+        bx = bx / diag_f32;
+        asm volatile("vfcpka.h.s %0, %1, %2;" : "=r"(res) : "r"(ax), "r"(bx) :);
+        (*(v2h *)&x[2U * ridx]) = res;
+      }
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    // Update of the remaining known variables
+    if (blk + CHOLESKY_BLOCK < n) {
+      for (i = core_id; i < n - blk - CHOLESKY_BLOCK; i += nPE) {
+        ridx = transposed ? i : (kb + CHOLESKY_BLOCK + i);
+        as = x[2U * ridx];
+        bs = x[2U * ridx + 1];
+        for (k = kb; k < kb + CHOLESKY_BLOCK; k++) {
+          lidx = transposed ? (k * n + ridx) : (ridx * n + k);
+          mempool_Ltrisol_f16p_mac(&pL[2U * lidx], &x[2U * k], &as, &bs,
+                                   transposed);
+        }
+        x[2U * ridx] = as;
+        x[2U * ridx + 1] = bs;
+      }
+      mempool_log_partial_barrier(2, absolute_core_id, nPE);
+    }
+  }
+  return;
+}
@@ -148,3 +148,112 @@ void mempool_Ltrisol_f16s(__fp16 *pL, __fp16 *in, __fp16 *x, const uint32_t n,
 }
 
 #endif
+
+/**
+  @brief         Single-core solution of lower triangular system with multiple
+  right-hand sides, L * X = B or L' * X = B. Each element of L is reused for
+  two columns of X and the sums are accumulated in f32.
+  @param[in]     pL input triangular matrix
+  @param[in]     pB known variables, n x nrhs matrix
+  @param[out]    pX unknown solutions, n x nrhs matrix, can be pB
+  @param[in]     n dimension of the system
+  @param[in]     nrhs number of right-hand sides, even
+  @param[in]     transposed solve the conjugate transposed system
+  @param[in]     folded matrices are folded with rows NUM_BANKS apart
+  @return        none
+*/
+
+void mempool_Ltrisol_nrhs_f16s(__fp16 *pL, __fp16 *pB, __fp16 *pX,
+                               const uint32_t n, const uint32_t nrhs,
+                               const uint32_t transposed,
+                               const uint32_t folded) {
+
+  uint32_t i, j, k;
+  v2h ab, cd0, cd1;
+  v2h cnd0, cnd1, dc0, dc1;
+  v2h res0, res1;
+  float as0, bs0, as1, bs1;
+  float ap0, bp0, ap1, bp1;
+  float diag;
+  const uint32_t offset = folded ? NUM_BANKS : n;
+  const uint32_t ldx = folded ? NUM_BANKS : nrhs;
+  const uint32_t neg_mask = 0x80000000;
+  const uint32_t shuffle_mask = 0x00020003;
+  // Conjugate L for the transposed system
+  const uint32_t conj_mask = transposed ? 0x80000000 : 0x0;
+
+  for (i = 0; i < n; i++) {
+    uint32_t ridx = transposed ? (n - i - 1) : i;
+    asm volatile("fcvt.s.h %0, %1;"
+                 : "=r"(diag)
+                 : "r"(pL[2U * (ridx * offset + ridx)])
+                 :);
+    diag = 1.0f / diag;
+    for (j = 0; j < nrhs; j += 2) {
+      as0 = 0.0f;
+      bs0 = 0.0f;
+      as1 = 0.0f;
+      bs1 = 0.0f;
+      // Use the previously solved rows to calculate the sums
+      for (k = 0; k < i; k++) {
+        uint32_t cidx = transposed ? (n - k - 1) : k;
+        if (!transposed) {
+          ab = (*(v2h *)&pL[2U * (ridx * offset + cidx)]);
+        } else {
+          ab = (*(v2h *)&pL[2U * (cidx * offset + ridx)]);
+        }
+        cd0 = (*(v2h *)&pX[2U * (cidx * ldx + j)]);
+        cd1 = (*(v2h *)&pX[2U * (cidx * ldx + j + 1)]);
+        asm volatile(
+            // s = s + (ac - bd) + j(ad + bc)
+            "xor           %[ab],   %[conj_mask], %[ab];"
+            "xor           %[cnd0], %[neg_mask], %[cd0];"
+            "xor           %[cnd1], %[neg_mask], %[cd1];"
+            "pv.shuffle2.h %[dc0],  %[cd0], %[shuffle_mask];"
+            "pv.shuffle2.h %[dc1],  %[cd1], %[shuffle_mask];"
+            "vfdotpex.s.h  %[as0],  %[ab], %[cnd0];"
+            "vfdotpex.s.h  %[bs0],  %[ab], %[dc0];"
+            "vfdotpex.s.h  %[as1],  %[ab], %[cnd1];"
+            "vfdotpex.s.h  %[bs1],  %[ab], %[dc1];"
+            : [as0] "+&r"(as0), [bs0] "+&r"(bs0), [as1] "+&r"(as1),
+              [bs1] "+&r"(bs1), [ab] "+&r"(ab), [cnd0] "=&r"(cnd0),
+              [cnd1] "=&r"(cnd1), [dc0] "=&r"(dc0), [dc1] "=&r"(dc1)
+            : [cd0] "r"(cd0), [cd1] "r"(cd1), [conj_mask] "r"(conj_mask),
+              [neg_mask] "r"(neg_mask), [shuffle_mask] "r"(shuffle_mask)
+            :);
+      }
+      // Subtract the sums from B and multiply by the inverse of L[i][i]
+      asm volatile("fcvt.s.h %0, %1;"
+                   : "=r"(ap0)
+                   : "r"(pB[2U * (ridx * ldx + j)])
+                   :);
+      asm volatile("fcvt.s.h %0, %1;"
+                   : "=r"(bp0)
+                   : "r"(pB[2U * (ridx * ldx + j) + 1])
+                   :);
+      asm volatile("fcvt.s.h %0, %1;"
+                   : "=r"(ap1)
+                   : "r"(pB[2U * (ridx * ldx + j + 1)])
+                   :);
+      asm volatile("fcvt.s.h %0, %1;"
+                   : "=r"(bp1)
+                   : "r"(pB[2U * (ridx * ldx + j + 1) + 1])
+                   :);
+      as0 = (ap0 - as0) * diag;
+      bs0 = (bp0 - bs0) * diag;
+      as1 = (ap1 - as1) * diag;
+      bs1 = (bp1 - bs1) * diag;
+      asm volatile("vfcpka.h.s %0, %1, %2;"
+                   : "=r"(res0)
+                   : "r"(as0), "r"(bs0)
+                   :);
+      asm volatile("vfcpka.h.s %0, %1, %2;"
+                   : "=r"(res1)
+                   : "r"(as1), "r"(bs1)
+                   :);
+      (*(v2h *)&pX[2U * (ridx * ldx + j)]) = res0;
+      (*(v2h *)&pX[2U * (ridx * ldx + j + 1)]) = res1;
+    }
+  }
+  return;
+}
@@ -0,0 +1,143 @@
+// Copyright 2021 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Blocked solution of a lower triangular system, matching the panels of
+mempool_cholesky_f32p. For each block of CHOLESKY_BLOCK unknowns:
+- The block is solved by a single core (round-robin over blocks).
+- The solved unknowns are broadcast to all cores, which update the known
+variables of the remaining rows.
+The transposed system L^H x = y is solved backwards with the same scheme.
+*/
+
+#pragma once
+#ifdef __XDIVSQRT
+
+#ifndef CHOLESKY_BLOCK
+#define CHOLESKY_BLOCK (4)
+#endif
+
+/**
+  @brief         Subtract the product of an element of L and a solution.
+  @param[in]     pL points to the element of the triangular matrix
+  @param[in]     px points to the solved variable
+  @param[in,out] as real part of the known variable
+  @param[in,out] bs imaginary part of the known variable
+  @param[in]     transposed use the conjugate of the element of L
+  @return        none
+*/
+static inline void mempool_Ltrisol_f32p_mac(float *pL, float *px, float *as,
+                                            float *bs,
+                                            const uint32_t transposed) {
+  float a = pL[0];
+  float b = pL[1];
+  float c = px[0];
+  float d = px[1];
+  float ar = *as;
+  float br = *bs;
+  if (transposed) {
+    // s = s - (ac + bd) - j(ad - bc)
+    asm volatile("fnmsub.s %[ar], %[a], %[c], %[ar];"
+                 "fnmsub.s %[br], %[a], %[d], %[br];"
+                 "fnmsub.s %[ar], %[b], %[d], %[ar];"
+                 "fmadd.s  %[br], %[b], %[c], %[br];"
+                 : [ar] "+&r"(ar), [br] "+&r"(br)
+                 : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                 :);
+  } else {
+    // s = s - (ac - bd) - j(ad + bc)
+    asm volatile("fnmsub.s %[ar], %[a], %[c], %[ar];"
+                 "fnmsub.s %[br], %[a], %[d], %[br];"
+                 "fmadd.s  %[ar], %[b], %[d], %[ar];"
+                 "fnmsub.s %[br], %[b], %[c], %[br];"
+                 : [ar] "+&r"(ar), [br] "+&r"(br)
+                 : [a] "r"(a), [b] "r"(b), [c] "r"(c), [d] "r"(d)
+                 :);
+  }
+  *as = ar;
+  *bs = br;
+  return;
+}
+
+/**
+  @brief         Parallel solution of lower triangular system
+  @param[in]     pL input triangular matrix
+  @param[in]     in known variables vector
+  @param[in]     x unknown solutions vector
+  @param[in]     n dimension of the system
+  @param[in]     transposed solve transposed (hermitian) system
+  @param[in]     nPE number of cores
+  @return        none
+*/
+
+void mempool_Ltrisol_f32p(float *pL, float *in, float *x, const uint32_t n,
+                          const uint32_t transposed, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t blk, i, k, kb, ridx, cidx, lidx;
+  float as, bs, diag;
+
+  for (i = core_id; i < n; i += nPE) {
+    x[2U * i] = in[2U * i];
+    x[2U * i + 1] = in[2U * i + 1];
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+  for (blk = 0; blk < n; blk += CHOLESKY_BLOCK) {
+    // The transposed system is solved backwards
+    kb = transposed ? (n - blk - CHOLESKY_BLOCK) : blk;
+
+    // Diagonal block
+    if (core_id == (blk / CHOLESKY_BLOCK) % nPE) {
+      for (i = 0; i < CHOLESKY_BLOCK; i++) {
+        ridx = transposed ? (kb + CHOLESKY_BLOCK - 1 - i) : (kb + i);
+        diag = pL[2U * (ridx * n + ridx)];
+        as = x[2U * ridx];
+        bs = x[2U * ridx + 1];
+        for (k = 0; k < i; k++) {
+          cidx = transposed ? (kb + CHOLESKY_BLOCK - 1 - k) : (kb + k);
+          lidx = transposed ? (cidx * n + ridx) : (ridx * n + cidx);
+          mempool_Ltrisol_f32p_mac(&pL[2U * lidx], &x[2U * cidx], &as, &bs,
+                                   transposed);
+        }
+        asm volatile("fdiv.s %[as], %[as], %[diag];"
+                     "fdiv.s %[bs], %[bs], %[diag];"
+                     : [as] "+&r"(as), [bs] "+&r"(bs)
+                     : [diag] "r"(diag)
+                     :);
+        x[2U * ridx] = as;
+        x[2U * ridx + 1] = bs;
+      }
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    // Update of the remaining known variables
+    if (blk + CHOLESKY_BLOCK < n) {
+      for (i = core_id; i < n - blk - CHOLESKY_BLOCK; i += nPE) {
+        ridx = transposed ? i : (kb + CHOLESKY_BLOCK + i);
+        as = x[2U * ridx];
+        bs = x[2U * ridx + 1];
+        for (k = kb; k < kb + CHOLESKY_BLOCK; k++) {
+          lidx = transposed ? (k * n + ridx) : (ridx * n + k);
+          mempool_Ltrisol_f32p_mac(&pL[2U * lidx], &x[2U * k], &as, &bs,
+                                   transposed);
+        }
+        x[2U * ridx] = as;
+        x[2U * ridx + 1] = bs;
+      }
+      mempool_log_partial_barrier(2, absolute_core_id, nPE);
+    }
+  }
+  return;
+}
+
+#else
+
+#error "ERROR: f32 MMSE functions available only for __XDIVSQRT."
+
+#endif
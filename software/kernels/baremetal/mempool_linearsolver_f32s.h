@@ -69,6 +69,91 @@ void mempool_Ltrisol_f32s(float *pL, float *in, float *x, const uint32_t n,
   return;
 }
 
+/**
+  @brief         Single-core solution of lower triangular system with multiple
+  right-hand sides, L * X = B or L' * X = B. Each element of L is reused for
+  two columns of X.
+  @param[in]     pL input triangular matrix
+  @param[in]     pB known variables, n x nrhs matrix
+  @param[out]    pX unknown solutions, n x nrhs matrix, can be pB
+  @param[in]     n dimension of the system
+  @param[in]     nrhs number of right-hand sides, even
+  @param[in]     transposed solve the conjugate transposed system
+  @param[in]     folded matrices are folded with rows NUM_BANKS apart
+  @return        none
+*/
+
+void mempool_Ltrisol_nrhs_f32s(float *pL, float *pB, float *pX,
+                               const uint32_t n, const uint32_t nrhs,
+                               const uint32_t transposed,
+                               const uint32_t folded) {
+
+  uint32_t i, j, k;
+  float a, b;
+  float c0, d0, c1, d1;
+  float as0, bs0, as1, bs1;
+  float diag;
+  const uint32_t offset = folded ? NUM_BANKS : n;
+  const uint32_t ldx = folded ? NUM_BANKS : nrhs;
+
+  for (i = 0; i < n; i++) {
+    uint32_t ridx = transposed ? (n - i - 1) : i;
+    diag = pL[2U * (ridx * offset + ridx)];
+    asm volatile("fdiv.s %[diag], %[one], %[diag];"
+                 : [diag] "+&r"(diag)
+                 : [one] "r"(1.0f)
+                 :);
+    for (j = 0; j < nrhs; j += 2) {
+      as0 = pB[2U * (ridx * ldx + j)];
+      bs0 = pB[2U * (ridx * ldx + j) + 1];
+      as1 = pB[2U * (ridx * ldx + j + 1)];
+      bs1 = pB[2U * (ridx * ldx + j + 1) + 1];
+      // Use the previously solved rows to calculate the sums
+      for (k = 0; k < i; k++) {
+        uint32_t cidx = transposed ? (n - k - 1) : k;
+        if (!transposed) {
+          a = pL[2U * (ridx * offset + cidx)];
+          b = pL[2U * (ridx * offset + cidx) + 1];
+        } else {
+          a = pL[2U * (cidx * offset + ridx)];
+          b = -pL[2U * (cidx * offset + ridx) + 1];
+        }
+        c0 = pX[2U * (cidx * ldx + j)];
+        d0 = pX[2U * (cidx * ldx + j) + 1];
+        c1 = pX[2U * (cidx * ldx + j + 1)];
+        d1 = pX[2U * (cidx * ldx + j + 1) + 1];
+        asm volatile("fnmsub.s %[as0], %[a], %[c0], %[as0];"
+                     "fnmsub.s %[bs0], %[a], %[d0], %[bs0];"
+                     "fnmsub.s %[as1], %[a], %[c1], %[as1];"
+                     "fnmsub.s %[bs1], %[a], %[d1], %[bs1];"
+                     "fmadd.s  %[as0], %[b], %[d0], %[as0];"
+                     "fnmsub.s %[bs0], %[b], %[c0], %[bs0];"
+                     "fmadd.s  %[as1], %[b], %[d1], %[as1];"
+                     "fnmsub.s %[bs1], %[b], %[c1], %[bs1];"
+                     : [as0] "+&r"(as0), [bs0] "+&r"(bs0), [as1] "+&r"(as1),
+                       [bs1] "+&r"(bs1)
+                     : [a] "r"(a), [b] "r"(b), [c0] "r"(c0), [d0] "r"(d0),
+                       [c1] "r"(c1), [d1] "r"(d1)
+                     :);
+      }
+      // Multiply by the inverse of the diagonal element L[i][i]
+      asm volatile("fmul.s %[as0], %[as0], %[diag];"
+                   "fmul.s %[bs0], %[bs0], %[diag];"
+                   "fmul.s %[as1], %[as1], %[diag];"
+                   "fmul.s %[bs1], %[bs1], %[diag];"
+                   : [as0] "+&r"(as0), [bs0] "+&r"(bs0), [as1] "+&r"(as1),
+                     [bs1] "+&r"(bs1)
+                   : [diag] "r"(diag)
+                   :);
+      pX[2U * (ridx * ldx + j)] = as0;
+      pX[2U * (ridx * ldx + j) + 1] = bs0;
+      pX[2U * (ridx * ldx + j + 1)] = as1;
+      pX[2U * (ridx * ldx + j + 1) + 1] = bs1;
+    }
+  }
+  return;
+}
+
 #else
 
 #error "ERROR: f32 MMSE functions available only for __XDIVSQRT."
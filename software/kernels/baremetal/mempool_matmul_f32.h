@@ -119,6 +119,59 @@ void matmul_2x2_parallel_f32(float const *__restrict__ A,
   }
 }
 
+void matmul_4x2_parallel_f32(const float *__restrict__ pSrcA,
+                             const float *__restrict__ pSrcB,
+                             float *__restrict__ pDstC, uint32_t M, uint32_t N,
+                             uint32_t P, uint32_t core_id,
+                             uint32_t numThreads) {
+  uint32_t i = 0; // loop counter for M
+  uint32_t j = 0; // loop counter for N
+  uint32_t k = 0; // loop counter for P
+  for (k = core_id; k < P / 2; k += numThreads) {
+    for (i = 0; i < M / 4; i++) {
+      float sum00 = 0.0f;
+      float sum01 = 0.0f;
+      float sum10 = 0.0f;
+      float sum11 = 0.0f;
+      float sum20 = 0.0f;
+      float sum21 = 0.0f;
+      float sum30 = 0.0f;
+      float sum31 = 0.0f;
+      for (j = 0; j < N; j++) {
+        float a0 = pSrcA[(i * 4) * N + j];
+        float a1 = pSrcA[(i * 4 + 1) * N + j];
+        float a2 = pSrcA[(i * 4 + 2) * N + j];
+        float a3 = pSrcA[(i * 4 + 3) * N + j];
+        float b0 = pSrcB[j * P + (k * 2)];
+        float b1 = pSrcB[j * P + (k * 2) + 1];
+        asm volatile("fmadd.s %[sum00], %[a0], %[b0], %[sum00];"
+                     "fmadd.s %[sum01], %[a0], %[b1], %[sum01];"
+                     "fmadd.s %[sum10], %[a1], %[b0], %[sum10];"
+                     "fmadd.s %[sum11], %[a1], %[b1], %[sum11];"
+                     "fmadd.s %[sum20], %[a2], %[b0], %[sum20];"
+                     "fmadd.s %[sum21], %[a2], %[b1], %[sum21];"
+                     "fmadd.s %[sum30], %[a3], %[b0], %[sum30];"
+                     "fmadd.s %[sum31], %[a3], %[b1], %[sum31];"
+                     : [sum00] "+&r"(sum00), [sum01] "+&r"(sum01),
+                       [sum10] "+&r"(sum10), [sum11] "+&r"(sum11),
+                       [sum20] "+&r"(sum20), [sum21] "+&r"(sum21),
+                       [sum30] "+&r"(sum30), [sum31] "+&r"(sum31)
+                     : [a0] "r"(a0), [a1] "r"(a1), [a2] "r"(a2), [a3] "r"(a3),
+                       [b0] "r"(b0), [b1] "r"(b1)
+                     :);
+      }
+      pDstC[(i * 4) * P + (k * 2)] = sum00;
+      pDstC[(i * 4) * P + (k * 2 + 1)] = sum01;
+      pDstC[(i * 4 + 1) * P + (k * 2)] = sum10;
+      pDstC[(i * 4 + 1) * P + (k * 2 + 1)] = sum11;
+      pDstC[(i * 4 + 2) * P + (k * 2)] = sum20;
+      pDstC[(i * 4 + 2) * P + (k * 2 + 1)] = sum21;
+      pDstC[(i * 4 + 3) * P + (k * 2)] = sum30;
+      pDstC[(i * 4 + 3) * P + (k * 2 + 1)] = sum31;
+    }
+  }
+}
+
 void matmul_4x2_parallel_f32vec(const float *__restrict__ pSrcA,
                                 const float *__restrict__ pSrcB,
                                 float *__restrict__ pDstC, uint32_t M,
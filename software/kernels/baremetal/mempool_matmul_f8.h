@@ -0,0 +1,207 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/* This library implements the matrix multiplication on fp8 (e5m2) inputs,
+ * with f16 accumulation and outputs.
+ *
+ * A is an M x N matrix, B is a N x P matrix, and C is a M x P matrix
+ * C = AB
+ */
+
+#pragma once
+#include "builtins_v2.h"
+
+/**
+  @brief         Parallel fp8 matrix multiplication with f16 accumulation.
+  Each core computes 4 x 4 blocks of C, in columns core_id * 4, core_id * 4 +
+  numThreads * 4, ...
+  vfdotpex.h.b accumulates two products in each f16 half of a word. The rows of
+  B are interleaved in pairs, {B[j][k], B[j+1][k], B[j][k+1], B[j+1][k+1]},
+  and A is repeated, {A[i][j], A[i][j+1], A[i][j], A[i][j+1]}, so that each
+  accumulator holds two adjacent outputs of C, stored as a single word.
+  @param[in]     pSrcA points to the first input matrix
+  @param[in]     pSrcB points to the second input matrix
+  @param[out]    pDstC points to the output matrix
+  @param[in]     M number of rows of A, multiple of 4
+  @param[in]     N number of columns of A, multiple of 4
+  @param[in]     P number of columns of B, multiple of 4
+  @param[in]     core_id id of the core
+  @param[in]     numThreads number of cores
+  @return        none
+*/
+void matmul_4x4_parallel_f8vec(const __fp8 *__restrict__ pSrcA,
+                               const __fp8 *__restrict__ pSrcB,
+                               __fp16 *__restrict__ pDstC, uint32_t M,
+                               uint32_t N, uint32_t P, uint32_t core_id,
+                               uint32_t numThreads) {
+
+  uint32_t i = 0; // loop counter for M
+  uint32_t j = 0; // loop counter for N
+  uint32_t k = 0; // loop counter for P
+
+  const uint32_t maskA01 = 0x05040504;
+  const uint32_t maskA23 = 0x07060706;
+  const uint32_t maskB01 = 0x01050004;
+  const uint32_t maskB23 = 0x03070206;
+
+  for (k = core_id * 4; k < P; k += numThreads * 4) {
+    for (i = 0; i < M; i += 4) {
+      uint32_t sum00 = 0U, sum01 = 0U;
+      uint32_t sum10 = 0U, sum11 = 0U;
+      uint32_t sum20 = 0U, sum21 = 0U;
+      uint32_t sum30 = 0U, sum31 = 0U;
+      for (j = 0; j < N; j += 4) {
+        uint32_t b0 = *(uint32_t *)&(pSrcB[j * P + k]);
+        uint32_t b1 = *(uint32_t *)&(pSrcB[(j + 1) * P + k]);
+        uint32_t b2 = *(uint32_t *)&(pSrcB[(j + 2) * P + k]);
+        uint32_t b3 = *(uint32_t *)&(pSrcB[(j + 3) * P + k]);
+        uint32_t bVec01a = b1, bVec23a = b1;
+        uint32_t bVec01b = b3, bVec23b = b3;
+        uint32_t a, aVec01, aVec23;
+        // Interleave the rows of B in pairs
+        asm volatile("pv.shuffle2.b %[bVec01a], %[b0], %[maskB01];"
+                     "pv.shuffle2.b %[bVec23a], %[b0], %[maskB23];"
+                     "pv.shuffle2.b %[bVec01b], %[b2], %[maskB01];"
+                     "pv.shuffle2.b %[bVec23b], %[b2], %[maskB23];"
+                     : [bVec01a] "+&r"(bVec01a), [bVec23a] "+&r"(bVec23a),
+                       [bVec01b] "+&r"(bVec01b), [bVec23b] "+&r"(bVec23b)
+                     : [b0] "r"(b0), [b2] "r"(b2), [maskB01] "r"(maskB01),
+                       [maskB23] "r"(maskB23)
+                     :);
+        // Repeat pairs of A and accumulate two outputs in each sum
+        a = *(uint32_t *)&(pSrcA[i * N + j]);
+        asm volatile("pv.shuffle2.b %[aVec01], %[a], %[maskA01];"
+                     "pv.shuffle2.b %[aVec23], %[a], %[maskA23];"
+                     "vfdotpex.h.b  %[sum0], %[aVec01], %[bVec01a];"
+                     "vfdotpex.h.b  %[sum1], %[aVec01], %[bVec23a];"
+                     "vfdotpex.h.b  %[sum0], %[aVec23], %[bVec01b];"
+                     "vfdotpex.h.b  %[sum1], %[aVec23], %[bVec23b];"
+                     : [sum0] "+&r"(sum00), [sum1] "+&r"(sum01),
+                       [aVec01] "=&r"(aVec01), [aVec23] "=&r"(aVec23)
+                     : [a] "r"(a), [maskA01] "r"(maskA01),
+                       [maskA23] "r"(maskA23), [bVec01a] "r"(bVec01a),
+                       [bVec23a] "r"(bVec23a), [bVec01b] "r"(bVec01b),
+                       [bVec23b] "r"(bVec23b)
+                     :);
+        a = *(uint32_t *)&(pSrcA[(i + 1) * N + j]);
+        asm volatile("pv.shuffle2.b %[aVec01], %[a], %[maskA01];"
+                     "pv.shuffle2.b %[aVec23], %[a], %[maskA23];"
+                     "vfdotpex.h.b  %[sum0], %[aVec01], %[bVec01a];"
+                     "vfdotpex.h.b  %[sum1], %[aVec01], %[bVec23a];"
+                     "vfdotpex.h.b  %[sum0], %[aVec23], %[bVec01b];"
+                     "vfdotpex.h.b  %[sum1], %[aVec23], %[bVec23b];"
+                     : [sum0] "+&r"(sum10), [sum1] "+&r"(sum11),
+                       [aVec01] "=&r"(aVec01), [aVec23] "=&r"(aVec23)
+                     : [a] "r"(a), [maskA01] "r"(maskA01),
+                       [maskA23] "r"(maskA23), [bVec01a] "r"(bVec01a),
+                       [bVec23a] "r"(bVec23a), [bVec01b] "r"(bVec01b),
+                       [bVec23b] "r"(bVec23b)
+                     :);
+        a = *(uint32_t *)&(pSrcA[(i + 2) * N + j]);
+        asm volatile("pv.shuffle2.b %[aVec01], %[a], %[maskA01];"
+                     "pv.shuffle2.b %[aVec23], %[a], %[maskA23];"
+                     "vfdotpex.h.b  %[sum0], %[aVec01], %[bVec01a];"
+                     "vfdotpex.h.b  %[sum1], %[aVec01], %[bVec23a];"
+                     "vfdotpex.h.b  %[sum0], %[aVec23], %[bVec01b];"
+                     "vfdotpex.h.b  %[sum1], %[aVec23], %[bVec23b];"
+                     : [sum0] "+&r"(sum20), [sum1] "+&r"(sum21),
+                       [aVec01] "=&r"(aVec01), [aVec23] "=&r"(aVec23)
+                     : [a] "r"(a), [maskA01] "r"(maskA01),
+                       [maskA23] "r"(maskA23), [bVec01a] "r"(bVec01a),
+                       [bVec23a] "r"(bVec23a), [bVec01b] "r"(bVec01b),
+                       [bVec23b] "r"(bVec23b)
+                     :);
+        a = *(uint32_t *)&(pSrcA[(i + 3) * N + j]);
+        asm volatile("pv.shuffle2.b %[aVec01], %[a], %[maskA01];"
+                     "pv.shuffle2.b %[aVec23], %[a], %[maskA23];"
+                     "vfdotpex.h.b  %[sum0], %[aVec01], %[bVec01a];"
+                     "vfdotpex.h.b  %[sum1], %[aVec01], %[bVec23a];"
+                     "vfdotpex.h.b  %[sum0], %[aVec23], %[bVec01b];"
+                     "vfdotpex.h.b  %[sum1], %[aVec23], %[bVec23b];"
+                     : [sum0] "+&r"(sum30), [sum1] "+&r"(sum31),
+                       [aVec01] "=&r"(aVec01), [aVec23] "=&r"(aVec23)
+                     : [a] "r"(a), [maskA01] "r"(maskA01),
+                       [maskA23] "r"(maskA23), [bVec01a] "r"(bVec01a),
+                       [bVec23a] "r"(bVec23a), [bVec01b] "r"(bVec01b),
+                       [bVec23b] "r"(bVec23b)
+                     :);
+      }
+      (*(uint32_t *)&pDstC[i * P + k]) = sum00;
+      (*(uint32_t *)&pDstC[i * P + k + 2]) = sum01;
+      (*(uint32_t *)&pDstC[(i + 1) * P + k]) = sum10;
+      (*(uint32_t *)&pDstC[(i + 1) * P + k + 2]) = sum11;
+      (*(uint32_t *)&pDstC[(i + 2) * P + k]) = sum20;
+      (*(uint32_t *)&pDstC[(i + 2) * P + k + 2]) = sum21;
+      (*(uint32_t *)&pDstC[(i + 3) * P + k]) = sum30;
+      (*(uint32_t *)&pDstC[(i + 3) * P + k + 2]) = sum31;
+    }
+  }
+  return;
+}
+
+/**
+  @brief         Parallel conversion of f16 values to fp8 (e5m2).
+  @param[in]     pSrc points to the f16 values
+  @param[out]    pDst points to the fp8 values
+  @param[in]     n number of values, multiple of 4
+  @param[in]     core_id id of the core
+  @param[in]     numThreads number of cores
+  @return        none
+*/
+void mempool_cvt_f16_to_f8(const __fp16 *__restrict__ pSrc,
+                           __fp8 *__restrict__ pDst, uint32_t n,
+                           uint32_t core_id, uint32_t numThreads) {
+  uint32_t i;
+  for (i = core_id * 4; i < n; i += numThreads * 4) {
+    __fp8 r0, r1, r2, r3;
+    asm volatile("fcvt.b.h %[r0], %[s0];"
+                 "fcvt.b.h %[r1], %[s1];"
+                 "fcvt.b.h %[r2], %[s2];"
+                 "fcvt.b.h %[r3], %[s3];"
+                 : [r0] "=&r"(r0), [r1] "=&r"(r1), [r2] "=&r"(r2),
+                   [r3] "=&r"(r3)
+                 : [s0] "r"(pSrc[i]), [s1] "r"(pSrc[i + 1]),
+                   [s2] "r"(pSrc[i + 2]), [s3] "r"(pSrc[i + 3])
+                 :);
+    pDst[i] = r0;
+    pDst[i + 1] = r1;
+    pDst[i + 2] = r2;
+    pDst[i + 3] = r3;
+  }
+  return;
+}
+
+/**
+  @brief         Parallel conversion of fp8 (e5m2) values to f16.
+  @param[in]     pSrc points to the fp8 values
+  @param[out]    pDst points to the f16 values
+  @param[in]     n number of values, multiple of 4
+  @param[in]     core_id id of the core
+  @param[in]     numThreads number of cores
+  @return        none
+*/
+void mempool_cvt_f8_to_f16(const __fp8 *__restrict__ pSrc,
+                           __fp16 *__restrict__ pDst, uint32_t n,
+                           uint32_t core_id, uint32_t numThreads) {
+  uint32_t i;
+  for (i = core_id * 4; i < n; i += numThreads * 4) {
+    __fp16 r0, r1, r2, r3;
+    asm volatile("fcvt.h.b %[r0], %[s0];"
+                 "fcvt.h.b %[r1], %[s1];"
+                 "fcvt.h.b %[r2], %[s2];"
+                 "fcvt.h.b %[r3], %[s3];"
+                 : [r0] "=&r"(r0), [r1] "=&r"(r1), [r2] "=&r"(r2),
+                   [r3] "=&r"(r3)
+                 : [s0] "r"(pSrc[i]), [s1] "r"(pSrc[i + 1]),
+                   [s2] "r"(pSrc[i + 2]), [s3] "r"(pSrc[i + 3])
+                 :);
+    pDst[i] = r0;
+    pDst[i + 1] = r1;
+    pDst[i + 2] = r2;
+    pDst[i + 3] = r3;
+  }
+  return;
+}
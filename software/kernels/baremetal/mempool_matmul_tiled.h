@@ -0,0 +1,400 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/* This library implements a matrix multiplication of arbitrary shape, for
+ * matrices in L2 that do not fit in L1:
+ *
+ * A is an M x N matrix, B is a N x P matrix, and C is a M x P matrix
+ * C = AB
+ *
+ * The product is split in tiles of MATMUL_TILE_M x MATMUL_TILE_K of A and
+ * MATMUL_TILE_K x MATMUL_TILE_P of B, the K tiles of a tile of C are
+ * consecutive steps. The DMA loads the tiles of the next step in a second
+ * buffer while the cores compute, and stores each tile of C from one of two
+ * accumulation buffers while the cores compute the next one.
+ *
+ * Full tiles are computed by the unrolled parallel kernels, the cores are split
+ * in groups of rows, each group runs the kernel on its rows of the tile. The
+ * tiles at the edges of the matrices are computed by a remainder kernel.
+ *
+ * The tile sizes must be powers of two, multiples of 4, and the number of
+ * cores must be a power of two.
+ */
+
+#pragma once
+#include "builtins_v2.h"
+
+#include "baremetal/mempool_matmul_f16.h"
+#include "baremetal/mempool_matmul_f32.h"
+#include "baremetal/mempool_matmul_i16p.h"
+#include "baremetal/mempool_matmul_i32p.h"
+#include "baremetal/mempool_matmul_i8p.h"
+
+#ifndef MATMUL_TILE_M
+#define MATMUL_TILE_M (64)
+#endif
+#ifndef MATMUL_TILE_K
+#define MATMUL_TILE_K (64)
+#endif
+#ifndef MATMUL_TILE_P
+#define MATMUL_TILE_P (64)
+#endif
+
+// Bytes of the L1 workspace, for inputs and outputs of in_size and out_size
+// bytes: two buffers for the tiles of A and B, two accumulation buffers and a
+// buffer for the partial products of C
+#define MATMUL_TILED_L1_BYTES(in_size, out_size)                               \
+  (2 * (MATMUL_TILE_M * MATMUL_TILE_K + MATMUL_TILE_K * MATMUL_TILE_P) *       \
+       (in_size) +                                                             \
+   3 * MATMUL_TILE_M * MATMUL_TILE_P * (out_size))
+
+typedef enum {
+  MATMUL_I8 = 0,
+  MATMUL_I16,
+  MATMUL_I32,
+  MATMUL_F16,
+  MATMUL_F32
+} matmul_type_t;
+
+// Bytes of the inputs and of the outputs
+static const uint32_t matmul_in_size[] = {1, 2, 4, 2, 4};
+static const uint32_t matmul_out_size[] = {4, 4, 4, 2, 4};
+// Columns of C computed by each core and rows unrolled by the kernels
+static const uint32_t matmul_unroll_cols[] = {4, 2, 4, 2, 2};
+static const uint32_t matmul_unroll_rows[] = {2, 4, 4, 4, 4};
+
+/**
+  @brief         Remainder kernel, computes or accumulates the product of
+  arbitrary tiles, the elements of C are distributed to the cores.
+  @param[in]     type type of the matrices
+  @param[in]     pA points to the tile of A, rows MATMUL_TILE_K apart
+  @param[in]     pB points to the tile of B, rows MATMUL_TILE_P apart
+  @param[out]    pC points to the tile of C, rows MATMUL_TILE_P apart
+  @param[in]     m rows of the tile of A
+  @param[in]     k columns of the tile of A
+  @param[in]     p columns of the tile of B
+  @param[in]     acc accumulate the product to C
+  @param[in]     core_id id of the core
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void matmul_tile_edge(matmul_type_t type, const void *pA, const void *pB,
+                      void *pC, uint32_t m, uint32_t k, uint32_t p,
+                      uint32_t acc, uint32_t core_id, uint32_t nPE) {
+  uint32_t idx, i, j, l;
+  for (idx = core_id; idx < m * p; idx += nPE) {
+    i = idx / p;
+    j = idx % p;
+    uint32_t a = i * MATMUL_TILE_K;
+    uint32_t b = j;
+    uint32_t c = i * MATMUL_TILE_P + j;
+    switch (type) {
+    case MATMUL_I8: {
+      int32_t sum = acc ? ((int32_t *)pC)[c] : 0;
+      for (l = 0; l < k; l++, b += MATMUL_TILE_P) {
+        sum += ((int8_t *)pA)[a + l] * ((int8_t *)pB)[b];
+      }
+      ((int32_t *)pC)[c] = sum;
+      break;
+    }
+    case MATMUL_I16: {
+      int32_t sum = acc ? ((int32_t *)pC)[c] : 0;
+      for (l = 0; l < k; l++, b += MATMUL_TILE_P) {
+        sum += ((int16_t *)pA)[a + l] * ((int16_t *)pB)[b];
+      }
+      ((int32_t *)pC)[c] = sum;
+      break;
+    }
+    case MATMUL_I32: {
+      int32_t sum = acc ? ((int32_t *)pC)[c] : 0;
+      for (l = 0; l < k; l++, b += MATMUL_TILE_P) {
+        sum += ((int32_t *)pA)[a + l] * ((int32_t *)pB)[b];
+      }
+      ((int32_t *)pC)[c] = sum;
+      break;
+    }
+    case MATMUL_F16: {
+      __fp16 res = acc ? ((__fp16 *)pC)[c] : (__fp16)0.0f;
+      float sum, fa, fb;
+      asm volatile("fcvt.s.h %0, %1;" : "=r"(sum) : "r"(res) :);
+      for (l = 0; l < k; l++, b += MATMUL_TILE_P) {
+        __fp16 ha = ((__fp16 *)pA)[a + l];
+        __fp16 hb = ((__fp16 *)pB)[b];
+        asm volatile("fcvt.s.h %[fa], %[ha];"
+                     "fcvt.s.h %[fb], %[hb];"
+                     "fmadd.s  %[sum], %[fa], %[fb], %[sum];"
+                     : [sum] "+&r"(sum), [fa] "=&r"(fa), [fb] "=&r"(fb)
+                     : [ha] "r"(ha), [hb] "r"(hb)
+                     :);
+      }
+      asm volatile("fcvt.h.s %0, %1;" : "=r"(res) : "r"(sum) :);
+      ((__fp16 *)pC)[c] = res;
+      break;
+    }
+    case MATMUL_F32: {
+      float sum = acc ? ((float *)pC)[c] : 0.0f;
+      for (l = 0; l < k; l++, b += MATMUL_TILE_P) {
+        sum += ((float *)pA)[a + l] * ((float *)pB)[b];
+      }
+      ((float *)pC)[c] = sum;
+      break;
+    }
+    }
+  }
+  return;
+}
+
+/**
+  @brief         Computes the product of full tiles with the unrolled kernels.
+  The cores are split in groups, each group computes some rows of C and
+  accumulates them to the tile of C.
+  @param[in]     type type of the matrices
+  @param[in]     pA points to the tile of A
+  @param[in]     pB points to the tile of B
+  @param[out]    pC points to the tile of C
+  @param[in]     pPart points to the buffer of the partial products
+  @param[in]     acc accumulate the product to C
+  @param[in]     core_id id of the core
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void matmul_tile_full(matmul_type_t type, const void *pA, const void *pB,
+                      void *pC, void *pPart, uint32_t acc, uint32_t core_id,
+                      uint32_t nPE) {
+
+  uint32_t in_size = matmul_in_size[type];
+  uint32_t out_size = matmul_out_size[type];
+  // Cores of a group, each computes matmul_unroll_cols[type] columns
+  uint32_t nCol = MATMUL_TILE_P / matmul_unroll_cols[type];
+  nCol = nCol > nPE ? nPE : nCol;
+  // Groups of rows
+  uint32_t nGrp = nPE / nCol;
+  uint32_t maxGrp = MATMUL_TILE_M / matmul_unroll_rows[type];
+  nGrp = nGrp > maxGrp ? maxGrp : nGrp;
+  uint32_t nRows = MATMUL_TILE_M / nGrp;
+  // The 4x4 kernel assigns at least 4 rows to each core
+  uint32_t nChunk = nRows;
+  if (type == MATMUL_I32 && nChunk > 4 * nCol) {
+    nChunk = 4 * nCol;
+  }
+  uint32_t grp = core_id / nCol;
+  uint32_t col_id = core_id % nCol;
+  if (grp >= nGrp) {
+    return;
+  }
+
+  uint8_t *pDst = (uint8_t *)(acc ? pPart : pC);
+  uint32_t row, i;
+  for (row = grp * nRows; row < (grp + 1) * nRows; row += nChunk) {
+    const uint8_t *pSrcA =
+        (const uint8_t *)pA + row * MATMUL_TILE_K * in_size;
+    uint8_t *pDstC = pDst + row * MATMUL_TILE_P * out_size;
+    switch (type) {
+#ifdef __XPULPIMG
+    case MATMUL_I8:
+      matmul_unrolled_2x4_parallel_i8_xpulpv2(
+          (const int8_t *)pSrcA, (const int8_t *)pB, (int32_t *)pDstC, nChunk,
+          MATMUL_TILE_K, MATMUL_TILE_P, col_id, nCol);
+      break;
+    case MATMUL_I16:
+      matmul_unrolled_4x2_parallel_i16_xpulpv2(
+          (const int16_t *)pSrcA, (const int16_t *)pB, (int32_t *)pDstC,
+          nChunk, MATMUL_TILE_K, MATMUL_TILE_P, col_id, nCol);
+      break;
+#endif
+    case MATMUL_I32:
+      mat_mul_unrolled_4x4_parallel((const int32_t *)pSrcA, (const int32_t *)pB,
+                                    (int32_t *)pDstC, nChunk, MATMUL_TILE_K,
+                                    MATMUL_TILE_P, col_id, nCol);
+      break;
+    case MATMUL_F16:
+      matmul_4x2_parallel_f16vec((const __fp16 *)pSrcA, (const __fp16 *)pB,
+                                 (__fp16 *)pDstC, nChunk, MATMUL_TILE_K,
+                                 MATMUL_TILE_P, col_id, nCol);
+      break;
+    case MATMUL_F32:
+      matmul_4x2_parallel_f32((const float *)pSrcA, (const float *)pB,
+                              (float *)pDstC, nChunk, MATMUL_TILE_K,
+                              MATMUL_TILE_P, col_id, nCol);
+      break;
+    default:
+      break;
+    }
+  }
+  if (!acc) {
+    return;
+  }
+
+  // Accumulate the rows of the group
+  mempool_log_partial_barrier(2, core_id, nCol);
+  uint32_t first = grp * nRows * MATMUL_TILE_P;
+  uint32_t last = first + nRows * MATMUL_TILE_P;
+  switch (type) {
+  case MATMUL_F16:
+    for (i = first + 2 * col_id; i < last; i += 2 * nCol) {
+      v2h sum = *(v2h *)&((__fp16 *)pC)[i];
+      v2h part = *(v2h *)&((__fp16 *)pPart)[i];
+      asm volatile("vfadd.h %[sum], %[sum], %[part];"
+                   : [sum] "+&r"(sum)
+                   : [part] "r"(part)
+                   :);
+      *(v2h *)&((__fp16 *)pC)[i] = sum;
+    }
+    break;
+  case MATMUL_F32:
+    for (i = first + col_id; i < last; i += nCol) {
+      ((float *)pC)[i] += ((float *)pPart)[i];
+    }
+    break;
+  default:
+    for (i = first + col_id; i < last; i += nCol) {
+      ((int32_t *)pC)[i] += ((int32_t *)pPart)[i];
+    }
+    break;
+  }
+  return;
+}
+
+/**
+  @brief         Parallel matrix multiplication of matrices in L2, streamed
+  tile by tile to L1 with the DMA.
+  @param[in]     type type of the matrices
+  @param[in]     pSrcA points to the M x N matrix A in L2
+  @param[in]     pSrcB points to the N x P matrix B in L2
+  @param[out]    pDstC points to the M x P matrix C in L2
+  @param[in]     M number of rows of A
+  @param[in]     N number of columns of A
+  @param[in]     P number of columns of B
+  @param[in]     pWork points to MATMUL_TILED_L1_BYTES bytes of L1, word
+  aligned
+  @param[in]     pBarrier points to a counter in L1, zero
+  @param[in]     core_id id of the core
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_matmul_tiled(matmul_type_t type, const void *pSrcA,
+                          const void *pSrcB, void *pDstC, uint32_t M,
+                          uint32_t N, uint32_t P, void *pWork,
+                          uint32_t volatile *pBarrier, uint32_t core_id,
+                          uint32_t nPE) {
+
+  uint32_t in_size = matmul_in_size[type];
+  uint32_t out_size = matmul_out_size[type];
+  uint32_t tile_A = MATMUL_TILE_M * MATMUL_TILE_K * in_size;
+  uint32_t tile_B = MATMUL_TILE_K * MATMUL_TILE_P * in_size;
+  uint32_t tile_C = MATMUL_TILE_M * MATMUL_TILE_P * out_size;
+  uint8_t *pA[2], *pB[2], *pC[2], *pPart;
+  pA[0] = (uint8_t *)pWork;
+  pA[1] = pA[0] + tile_A;
+  pB[0] = pA[1] + tile_A;
+  pB[1] = pB[0] + tile_B;
+  pC[0] = pB[1] + tile_B;
+  pC[1] = pC[0] + tile_C;
+  pPart = pC[1] + tile_C;
+
+  uint32_t nTilesM = (M + MATMUL_TILE_M - 1) / MATMUL_TILE_M;
+  uint32_t nTilesK = (N + MATMUL_TILE_K - 1) / MATMUL_TILE_K;
+  uint32_t nTilesP = (P + MATMUL_TILE_P - 1) / MATMUL_TILE_P;
+  uint32_t nSteps = nTilesM * nTilesP * nTilesK;
+  uint32_t s, r, tile, im, ik, ip, m, k, p, full;
+
+  for (s = 0; s <= nSteps; s++) {
+
+    // The last core to finish a step waits for the tiles of the next one,
+    // then starts the store of the tile of C just computed and the loads of
+    // the tiles of the step after
+    if ((s == 0 && core_id == 0) ||
+        (s > 0 && (nPE - 1) == __atomic_fetch_add(pBarrier, 1,
+                                                   __ATOMIC_RELAXED))) {
+      __atomic_store_n(pBarrier, 0, __ATOMIC_RELAXED);
+      __sync_synchronize();
+      dma_wait();
+      if (s > 0 && s < nSteps) {
+        wake_up_all();
+      }
+      // Store C, the tiles being accumulated are not overwritten
+      tile = (s - 1) / nTilesK;
+      if (s > 0 && (s % nTilesK == 0)) {
+        im = tile / nTilesP;
+        ip = tile % nTilesP;
+        m = (M - im * MATMUL_TILE_M) < MATMUL_TILE_M ? M - im * MATMUL_TILE_M
+                                                     : MATMUL_TILE_M;
+        p = (P - ip * MATMUL_TILE_P) < MATMUL_TILE_P ? P - ip * MATMUL_TILE_P
+                                                     : MATMUL_TILE_P;
+        for (r = 0; r < m; r++) {
+          dma_memcpy_nonblocking(
+              (uint8_t *)pDstC +
+                  ((im * MATMUL_TILE_M + r) * P + ip * MATMUL_TILE_P) *
+                      out_size,
+              pC[tile % 2] + r * MATMUL_TILE_P * out_size, p * out_size);
+        }
+      }
+      // Load A and B, the buffers were used two steps before
+      for (uint32_t l = (s == 0 ? 0 : s + 1); l <= s + 1 && l < nSteps; l++) {
+        tile = l / nTilesK;
+        ik = l % nTilesK;
+        im = tile / nTilesP;
+        ip = tile % nTilesP;
+        m = (M - im * MATMUL_TILE_M) < MATMUL_TILE_M ? M - im * MATMUL_TILE_M
+                                                     : MATMUL_TILE_M;
+        k = (N - ik * MATMUL_TILE_K) < MATMUL_TILE_K ? N - ik * MATMUL_TILE_K
+                                                     : MATMUL_TILE_K;
+        p = (P - ip * MATMUL_TILE_P) < MATMUL_TILE_P ? P - ip * MATMUL_TILE_P
+                                                     : MATMUL_TILE_P;
+        for (r = 0; r < m; r++) {
+          dma_memcpy_nonblocking(
+              pA[l % 2] + r * MATMUL_TILE_K * in_size,
+              (const uint8_t *)pSrcA +
+                  ((im * MATMUL_TILE_M + r) * N + ik * MATMUL_TILE_K) *
+                      in_size,
+              k * in_size);
+        }
+        for (r = 0; r < k; r++) {
+          dma_memcpy_nonblocking(
+              pB[l % 2] + r * MATMUL_TILE_P * in_size,
+              (const uint8_t *)pSrcB +
+                  ((ik * MATMUL_TILE_K + r) * P + ip * MATMUL_TILE_P) *
+                      in_size,
+              p * in_size);
+        }
+      }
+      // The first tiles and the last tile of C are waited for
+      if (s == 0 || s == nSteps) {
+        dma_wait();
+        wake_up_all();
+      }
+    }
+    mempool_wfi();
+    if (s == nSteps) {
+      break;
+    }
+
+    // Compute the step
+    tile = s / nTilesK;
+    ik = s % nTilesK;
+    im = tile / nTilesP;
+    ip = tile % nTilesP;
+    m = (M - im * MATMUL_TILE_M) < MATMUL_TILE_M ? M - im * MATMUL_TILE_M
+                                                 : MATMUL_TILE_M;
+    k = (N - ik * MATMUL_TILE_K) < MATMUL_TILE_K ? N - ik * MATMUL_TILE_K
+                                                 : MATMUL_TILE_K;
+    p = (P - ip * MATMUL_TILE_P) < MATMUL_TILE_P ? P - ip * MATMUL_TILE_P
+                                                 : MATMUL_TILE_P;
+    full = (m == MATMUL_TILE_M) && (k == MATMUL_TILE_K) && (p == MATMUL_TILE_P);
+#ifndef __XPULPIMG
+    // The 8b and 16b kernels use the Xpulpimg SIMD instructions
+    full = full && (type != MATMUL_I8) && (type != MATMUL_I16);
+#endif
+    if (full) {
+      matmul_tile_full(type, pA[s % 2], pB[s % 2], pC[tile % 2], pPart, ik > 0,
+                       core_id, nPE);
+    } else {
+      matmul_tile_edge(type, pA[s % 2], pB[s % 2], pC[tile % 2], m, k, p,
+                       ik > 0, core_id, nPE);
+    }
+  }
+  return;
+}
@@ -0,0 +1,319 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Decimation-in-frequency butterflies of radix 2, 3, 4, 5 and 8 for the
+mixed-radix FFT. Each butterfly reads the inputs pIn[i0 + q * m], q = 0..r-1,
+computes the r-points DFT, multiplies the outputs p = 1..r-1 by the
+precomputed twiddles pTw[p - 1] and stores the results in place.
+If pTw is NULL the twiddle multiplication is skipped (last stage).
+Re and Im parts are interleaved.
+*/
+
+#pragma once
+
+// (ar + j ai) * (br + j bi)
+#define CMUL_F32(ar, ai, br, bi)                                               \
+  do {                                                                         \
+    float __tr = ar * br - ai * bi;                                            \
+    ai = ar * bi + ai * br;                                                    \
+    ar = __tr;                                                                 \
+  } while (0)
+
+// Multiply the p-th output by the (p - 1)-th twiddle
+#define TWIDDLE_F32(xr, xi, p)                                                 \
+  CMUL_F32(xr, xi, pTw[2U * ((p)-1U)], pTw[2U * ((p)-1U) + 1U])
+
+/**
+  @brief         Radix-2 butterfly.
+  @param[in]     pIn  points to input/output buffer of 32b data
+  @param[in]     i0 index of the first element of the butterfly
+  @param[in]     m distance between the elements of the butterfly
+  @param[in]     pTw points to the twiddles of the butterfly
+  @return        none
+*/
+static inline void radix2_butterfly_f32(float *pIn, uint32_t i0, uint32_t m,
+                                        const float *pTw) {
+  uint32_t i1 = i0 + m;
+  float x0r = pIn[2U * i0];
+  float x0i = pIn[2U * i0 + 1U];
+  float x1r = pIn[2U * i1];
+  float x1i = pIn[2U * i1 + 1U];
+  float y0r = x0r + x1r;
+  float y0i = x0i + x1i;
+  float y1r = x0r - x1r;
+  float y1i = x0i - x1i;
+  if (pTw != NULL) {
+    TWIDDLE_F32(y1r, y1i, 1U);
+  }
+  pIn[2U * i0] = y0r;
+  pIn[2U * i0 + 1U] = y0i;
+  pIn[2U * i1] = y1r;
+  pIn[2U * i1 + 1U] = y1i;
+}
+
+/**
+  @brief         Radix-3 butterfly.
+  @param[in]     pIn  points to input/output buffer of 32b data
+  @param[in]     i0 index of the first element of the butterfly
+  @param[in]     m distance between the elements of the butterfly
+  @param[in]     pTw points to the twiddles of the butterfly
+  @return        none
+*/
+static inline void radix3_butterfly_f32(float *pIn, uint32_t i0, uint32_t m,
+                                        const float *pTw) {
+  const float s60 = 0.86602540f; // sin(2pi/3)
+  uint32_t i1 = i0 + m;
+  uint32_t i2 = i1 + m;
+  float x0r = pIn[2U * i0];
+  float x0i = pIn[2U * i0 + 1U];
+  float x1r = pIn[2U * i1];
+  float x1i = pIn[2U * i1 + 1U];
+  float x2r = pIn[2U * i2];
+  float x2i = pIn[2U * i2 + 1U];
+  // t1 = x1 + x2, t2 = x0 - t1 / 2, t3 = sin(2pi/3) (x1 - x2)
+  float t1r = x1r + x2r;
+  float t1i = x1i + x2i;
+  float t2r = x0r - 0.5f * t1r;
+  float t2i = x0i - 0.5f * t1i;
+  float t3r = s60 * (x1r - x2r);
+  float t3i = s60 * (x1i - x2i);
+  // y0 = x0 + t1, y1 = t2 - j t3, y2 = t2 + j t3
+  float y0r = x0r + t1r;
+  float y0i = x0i + t1i;
+  float y1r = t2r + t3i;
+  float y1i = t2i - t3r;
+  float y2r = t2r - t3i;
+  float y2i = t2i + t3r;
+  if (pTw != NULL) {
+    TWIDDLE_F32(y1r, y1i, 1U);
+    TWIDDLE_F32(y2r, y2i, 2U);
+  }
+  pIn[2U * i0] = y0r;
+  pIn[2U * i0 + 1U] = y0i;
+  pIn[2U * i1] = y1r;
+  pIn[2U * i1 + 1U] = y1i;
+  pIn[2U * i2] = y2r;
+  pIn[2U * i2 + 1U] = y2i;
+}
+
+/**
+  @brief         Radix-4 butterfly.
+  @param[in]     pIn  points to input/output buffer of 32b data
+  @param[in]     i0 index of the first element of the butterfly
+  @param[in]     m distance between the elements of the butterfly
+  @param[in]     pTw points to the twiddles of the butterfly
+  @return        none
+*/
+static inline void radix4_butterfly_f32(float *pIn, uint32_t i0, uint32_t m,
+                                        const float *pTw) {
+  uint32_t i1 = i0 + m;
+  uint32_t i2 = i1 + m;
+  uint32_t i3 = i2 + m;
+  float x0r = pIn[2U * i0];
+  float x0i = pIn[2U * i0 + 1U];
+  float x1r = pIn[2U * i1];
+  float x1i = pIn[2U * i1 + 1U];
+  float x2r = pIn[2U * i2];
+  float x2i = pIn[2U * i2 + 1U];
+  float x3r = pIn[2U * i3];
+  float x3i = pIn[2U * i3 + 1U];
+  // a = x0 + x2, b = x0 - x2, c = x1 + x3, d = x1 - x3
+  float ar = x0r + x2r;
+  float ai = x0i + x2i;
+  float br = x0r - x2r;
+  float bi = x0i - x2i;
+  float cr = x1r + x3r;
+  float ci = x1i + x3i;
+  float dr = x1r - x3r;
+  float di = x1i - x3i;
+  // y0 = a + c, y1 = b - j d, y2 = a - c, y3 = b + j d
+  float y0r = ar + cr;
+  float y0i = ai + ci;
+  float y1r = br + di;
+  float y1i = bi - dr;
+  float y2r = ar - cr;
+  float y2i = ai - ci;
+  float y3r = br - di;
+  float y3i = bi + dr;
+  if (pTw != NULL) {
+    TWIDDLE_F32(y1r, y1i, 1U);
+    TWIDDLE_F32(y2r, y2i, 2U);
+    TWIDDLE_F32(y3r, y3i, 3U);
+  }
+  pIn[2U * i0] = y0r;
+  pIn[2U * i0 + 1U] = y0i;
+  pIn[2U * i1] = y1r;
+  pIn[2U * i1 + 1U] = y1i;
+  pIn[2U * i2] = y2r;
+  pIn[2U * i2 + 1U] = y2i;
+  pIn[2U * i3] = y3r;
+  pIn[2U * i3 + 1U] = y3i;
+}
+
+/**
+  @brief         Radix-5 butterfly.
+  @param[in]     pIn  points to input/output buffer of 32b data
+  @param[in]     i0 index of the first element of the butterfly
+  @param[in]     m distance between the elements of the butterfly
+  @param[in]     pTw points to the twiddles of the butterfly
+  @return        none
+*/
+static inline void radix5_butterfly_f32(float *pIn, uint32_t i0, uint32_t m,
+                                        const float *pTw) {
+  const float c1 = 0.30901699f;  // cos(2pi/5)
+  const float c2 = -0.80901699f; // cos(4pi/5)
+  const float s1 = 0.95105652f;  // sin(2pi/5)
+  const float s2 = 0.58778525f;  // sin(4pi/5)
+  uint32_t i1 = i0 + m;
+  uint32_t i2 = i1 + m;
+  uint32_t i3 = i2 + m;
+  uint32_t i4 = i3 + m;
+  float x0r = pIn[2U * i0];
+  float x0i = pIn[2U * i0 + 1U];
+  float x1r = pIn[2U * i1];
+  float x1i = pIn[2U * i1 + 1U];
+  float x2r = pIn[2U * i2];
+  float x2i = pIn[2U * i2 + 1U];
+  float x3r = pIn[2U * i3];
+  float x3i = pIn[2U * i3 + 1U];
+  float x4r = pIn[2U * i4];
+  float x4i = pIn[2U * i4 + 1U];
+  // a1 = x1 + x4, a2 = x2 + x3, b1 = x1 - x4, b2 = x2 - x3
+  float a1r = x1r + x4r;
+  float a1i = x1i + x4i;
+  float a2r = x2r + x3r;
+  float a2i = x2i + x3i;
+  float b1r = x1r - x4r;
+  float b1i = x1i - x4i;
+  float b2r = x2r - x3r;
+  float b2i = x2i - x3i;
+  // t1 = x0 + c1 a1 + c2 a2, t2 = x0 + c2 a1 + c1 a2
+  float t1r = x0r + c1 * a1r + c2 * a2r;
+  float t1i = x0i + c1 * a1i + c2 * a2i;
+  float t2r = x0r + c2 * a1r + c1 * a2r;
+  float t2i = x0i + c2 * a1i + c1 * a2i;
+  // u1 = s1 b1 + s2 b2, u2 = s2 b1 - s1 b2
+  float u1r = s1 * b1r + s2 * b2r;
+  float u1i = s1 * b1i + s2 * b2i;
+  float u2r = s2 * b1r - s1 * b2r;
+  float u2i = s2 * b1i - s1 * b2i;
+  // y1 = t1 - j u1, y4 = t1 + j u1, y2 = t2 - j u2, y3 = t2 + j u2
+  float y0r = x0r + a1r + a2r;
+  float y0i = x0i + a1i + a2i;
+  float y1r = t1r + u1i;
+  float y1i = t1i - u1r;
+  float y4r = t1r - u1i;
+  float y4i = t1i + u1r;
+  float y2r = t2r + u2i;
+  float y2i = t2i - u2r;
+  float y3r = t2r - u2i;
+  float y3i = t2i + u2r;
+  if (pTw != NULL) {
+    TWIDDLE_F32(y1r, y1i, 1U);
+    TWIDDLE_F32(y2r, y2i, 2U);
+    TWIDDLE_F32(y3r, y3i, 3U);
+    TWIDDLE_F32(y4r, y4i, 4U);
+  }
+  pIn[2U * i0] = y0r;
+  pIn[2U * i0 + 1U] = y0i;
+  pIn[2U * i1] = y1r;
+  pIn[2U * i1 + 1U] = y1i;
+  pIn[2U * i2] = y2r;
+  pIn[2U * i2 + 1U] = y2i;
+  pIn[2U * i3] = y3r;
+  pIn[2U * i3 + 1U] = y3i;
+  pIn[2U * i4] = y4r;
+  pIn[2U * i4 + 1U] = y4i;
+}
+
+/**
+  @brief         Radix-8 butterfly, computed as two radix-4 butterflies on the
+  even and odd inputs, combined with the 8-points twiddles.
+  @param[in]     pIn  points to input/output buffer of 32b data
+  @param[in]     i0 index of the first element of the butterfly
+  @param[in]     m distance between the elements of the butterfly
+  @param[in]     pTw points to the twiddles of the butterfly
+  @return        none
+*/
+static inline void radix8_butterfly_f32(float *pIn, uint32_t i0, uint32_t m,
+                                        const float *pTw) {
+  const float r2 = 0.70710678f; // 1 / sqrt(2)
+  float xr[8], xi[8];
+  float er[4], ei[4], odr[4], odi[4];
+  float tr, ti;
+  uint32_t q;
+
+  for (q = 0; q < 8; q++) {
+    xr[q] = pIn[2U * (i0 + q * m)];
+    xi[q] = pIn[2U * (i0 + q * m) + 1U];
+  }
+  // Radix-4 on the even inputs
+  float ar = xr[0] + xr[4];
+  float ai = xi[0] + xi[4];
+  float br = xr[0] - xr[4];
+  float bi = xi[0] - xi[4];
+  float cr = xr[2] + xr[6];
+  float ci = xi[2] + xi[6];
+  float dr = xr[2] - xr[6];
+  float di = xi[2] - xi[6];
+  er[0] = ar + cr;
+  ei[0] = ai + ci;
+  er[1] = br + di;
+  ei[1] = bi - dr;
+  er[2] = ar - cr;
+  ei[2] = ai - ci;
+  er[3] = br - di;
+  ei[3] = bi + dr;
+  // Radix-4 on the odd inputs
+  ar = xr[1] + xr[5];
+  ai = xi[1] + xi[5];
+  br = xr[1] - xr[5];
+  bi = xi[1] - xi[5];
+  cr = xr[3] + xr[7];
+  ci = xi[3] + xi[7];
+  dr = xr[3] - xr[7];
+  di = xi[3] - xi[7];
+  odr[0] = ar + cr;
+  odi[0] = ai + ci;
+  odr[1] = br + di;
+  odi[1] = bi - dr;
+  odr[2] = ar - cr;
+  odi[2] = ai - ci;
+  odr[3] = br - di;
+  odi[3] = bi + dr;
+  // Odd outputs times W8^k: W8^1 = (1 - j) / sqrt(2), W8^2 = -j,
+  // W8^3 = -(1 + j) / sqrt(2)
+  tr = r2 * (odr[1] + odi[1]);
+  ti = r2 * (odi[1] - odr[1]);
+  odr[1] = tr;
+  odi[1] = ti;
+  tr = odi[2];
+  ti = -odr[2];
+  odr[2] = tr;
+  odi[2] = ti;
+  tr = r2 * (odi[3] - odr[3]);
+  ti = -r2 * (odr[3] + odi[3]);
+  odr[3] = tr;
+  odi[3] = ti;
+  // y[k] = e[k] + o[k], y[k + 4] = e[k] - o[k]
+  for (q = 0; q < 4; q++) {
+    xr[q] = er[q] + odr[q];
+    xi[q] = ei[q] + odi[q];
+    xr[q + 4] = er[q] - odr[q];
+    xi[q + 4] = ei[q] - odi[q];
+  }
+  if (pTw != NULL) {
+    for (q = 1; q < 8; q++) {
+      TWIDDLE_F32(xr[q], xi[q], q);
+    }
+  }
+  for (q = 0; q < 8; q++) {
+    pIn[2U * (i0 + q * m)] = xr[q];
+    pIn[2U * (i0 + q * m) + 1U] = xi[q];
+  }
+}
@@ -0,0 +1,171 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel mixed-radix decimation-in-frequency FFT on 32b floating point data,
+for lengths that are products of 2, 3 and 5 (e.g. 1536 = 3 x 8^3 and
+3072 = 3 x 8^3 x 2). The radix of each stage is listed in pRadix: the
+generator uses radix-5 and radix-3 stages first and then radix-8 stages, so
+that power-of-two lengths take a third fewer passes than with radix-4.
+
+- Stages run in place on pSrc. At the stage of radix r and length L, the
+butterflies are distributed cyclically over the cores. The twiddles of
+butterfly j are stored contiguously at pCoef + 2 * (offset + j * (r - 1)), so
+that cores with consecutive butterflies access consecutive banks.
+- Unlike the folded radix-4 kernels, the twiddles are a single table shared
+by all the tiles, not a copy per tile. The r inputs of a butterfly are m
+elements apart and are not folded either, so a butterfly makes 2r mostly
+remote accesses to pSrc against r - 1 twiddle loads, which the layout above
+already spreads over all the banks. Per-tile copies would multiply the
+twiddle memory by the number of tiles for a small share of the traffic.
+- The last stage has no twiddles.
+- The digit reversal is a scatter of pSrc to pDst, with pDigitRevTable[i]
+holding the output index of element i.
+Re and Im parts are interleaved.
+*/
+
+#pragma once
+#include "baremetal/mempool_mixedradix_cfft_butterfly_f32.h"
+
+/**
+  @brief         Butterfly stages of n_FFTs_ROW mixed-radix FFTs, computed in
+  place. The FFT in row idx_row and column idx_col starts at
+  pSrc + 2 * fftLen * (idx_row * n_FFTs_COL + idx_col). The outputs are in
+  digit reversed order.
+  @param[in]     pSrc points to input/output buffer of 32b data
+  @param[in]     fftLen length of the complex input vectors
+  @param[in]     n_FFTs_ROW number of FFTs in a column
+  @param[in]     n_FFTs_COL number of columns of FFTs
+  @param[in]     pCoef points to the twiddles of all the stages
+  @param[in]     pRadix points to the radix of each stage
+  @param[in]     nStages number of stages
+  @param[in]     nPE number of cores for each column
+  @return        none
+*/
+void mempool_mixedradix_cfft_f32p_stages(float *pSrc, const uint32_t fftLen,
+                                         const uint32_t n_FFTs_ROW,
+                                         const uint32_t n_FFTs_COL,
+                                         const float *pCoef,
+                                         const uint32_t *pRadix,
+                                         const uint32_t nStages,
+                                         const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t col_id = absolute_core_id / nPE;
+  uint32_t s, r, L, m, offset, idx, b, j, i0, idx_row;
+  const float *pTw;
+  float *pIn;
+
+  L = fftLen;
+  offset = 0;
+  for (s = 0; s < nStages; s++) {
+    r = pRadix[s];
+    m = L / r;
+    for (idx = core_id; idx < fftLen / r; idx += nPE) {
+      b = idx / m;
+      j = idx - b * m;
+      i0 = b * L + j;
+      pTw = (m > 1U) ? &pCoef[2U * (offset + j * (r - 1U))] : NULL;
+      for (idx_row = 0; idx_row < n_FFTs_ROW; idx_row++) {
+        pIn = pSrc + 2U * fftLen * (idx_row * n_FFTs_COL + col_id);
+        switch (r) {
+        case 8:
+          radix8_butterfly_f32(pIn, i0, m, pTw);
+          break;
+        case 5:
+          radix5_butterfly_f32(pIn, i0, m, pTw);
+          break;
+        case 4:
+          radix4_butterfly_f32(pIn, i0, m, pTw);
+          break;
+        case 3:
+          radix3_butterfly_f32(pIn, i0, m, pTw);
+          break;
+        default:
+          radix2_butterfly_f32(pIn, i0, m, pTw);
+          break;
+        }
+      }
+    }
+    offset += m * (r - 1U);
+    L = m;
+    mempool_log_partial_barrier(2, absolute_core_id, n_FFTs_COL * nPE);
+  }
+  return;
+}
+
+/**
+  @brief         Scheduler of mixed-radix FFTs. n_FFTs_COL groups of nPE cores
+  each compute a column of n_FFTs_ROW FFTs. The FFT in row idx_row and column
+  idx_col starts at pSrc + 2 * fftLen * (idx_row * n_FFTs_COL + idx_col).
+  Each core computes the same butterfly on all the FFTs of its column.
+  @param[in]     pSrc points to input buffer of 32b data, overwritten
+  @param[out]    pDst points to output buffer of 32b data
+  @param[in]     fftLen length of the complex input vectors
+  @param[in]     n_FFTs_ROW number of FFTs in a column
+  @param[in]     n_FFTs_COL number of columns of FFTs
+  @param[in]     pCoef points to the twiddles of all the stages
+  @param[in]     pRadix points to the radix of each stage
+  @param[in]     nStages number of stages
+  @param[in]     pDigitRevTable points to the digit reversal table
+  @param[in]     nPE number of cores for each column (n_FFTs_COL * nPE must be
+  a power of two)
+  @return        none
+*/
+void mempool_mixedradix_cfft_f32p_scheduler(
+    float *pSrc, float *pDst, const uint32_t fftLen, const uint32_t n_FFTs_ROW,
+    const uint32_t n_FFTs_COL, const float *pCoef, const uint32_t *pRadix,
+    const uint32_t nStages, const uint16_t *pDigitRevTable,
+    const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t col_id = absolute_core_id / nPE;
+  uint32_t idx, j, idx_row;
+  float *pIn;
+  float *pOut;
+
+  mempool_mixedradix_cfft_f32p_stages(pSrc, fftLen, n_FFTs_ROW, n_FFTs_COL,
+                                      pCoef, pRadix, nStages, nPE);
+
+  /* DIGIT REVERSAL */
+  for (idx = core_id; idx < fftLen; idx += nPE) {
+    j = pDigitRevTable[idx];
+    for (idx_row = 0; idx_row < n_FFTs_ROW; idx_row++) {
+      pIn = pSrc + 2U * fftLen * (idx_row * n_FFTs_COL + col_id);
+      pOut = pDst + 2U * fftLen * (idx_row * n_FFTs_COL + col_id);
+      pOut[2U * j] = pIn[2U * idx];
+      pOut[2U * j + 1U] = pIn[2U * idx + 1U];
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, n_FFTs_COL * nPE);
+  return;
+}
+
+/**
+  @brief         Parallel mixed-radix FFT.
+  @param[in]     pSrc points to input buffer of 32b data, overwritten
+  @param[out]    pDst points to output buffer of 32b data
+  @param[in]     fftLen length of the complex input vector
+  @param[in]     pCoef points to the twiddles of all the stages
+  @param[in]     pRadix points to the radix of each stage
+  @param[in]     nStages number of stages
+  @param[in]     pDigitRevTable points to the digit reversal table
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_mixedradix_cfft_f32p(float *pSrc, float *pDst,
+                                  const uint32_t fftLen, const float *pCoef,
+                                  const uint32_t *pRadix,
+                                  const uint32_t nStages,
+                                  const uint16_t *pDigitRevTable,
+                                  const uint32_t nPE) {
+  mempool_mixedradix_cfft_f32p_scheduler(pSrc, pDst, fftLen, 1, 1, pCoef,
+                                         pRadix, nStages, pDigitRevTable, nPE);
+  return;
+}
@@ -326,7 +326,8 @@ void mempool_radix4_cfft_f16p_scheduler(
   pTmp = pCoef_src;
   pCoef_src = pCoef_dst;
   pCoef_dst = pTmp;
-  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  // The next stage overwrites the twiddles read by the other columns
+  mempool_log_partial_barrier(2, absolute_core_id, n_FFTs_COL * nPE);
 
   /* MIDDLE STAGE */
   for (k = fftLen / 4U; k > 4U; k >>= 2U) {
@@ -0,0 +1,188 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel sorting of unsigned 32b keys, optionally with 32b values.
+
+LSD radix sort, RADIXSORT_BITS bits per pass:
+- Each core counts the digits of a contiguous chunk of keys in its histogram.
+- The histograms are scanned over the cores, digit by digit, and the totals of
+the digits are scanned with a binary tree (up-sweep and down-sweep).
+- Each core scatters its chunk to the offsets of its digits, which keeps the
+sort stable.
+The histograms of the cores take RADIXSORT_NBINS * NUM_CORES words. With
+local_hist set, the histogram of each core is in its local banks (see
+RADIXSORT_HIDX), else the histograms are contiguous in the interleaved memory.
+32 / RADIXSORT_BITS must be even, so that the sorted keys end in pKeys.
+
+Bitonic sort, for small arrays with a power of two length. Each compare and
+swap step is distributed over the cores and followed by a barrier.
+*/
+
+#pragma once
+
+#ifndef RADIXSORT_BITS
+#define RADIXSORT_BITS (8)
+#endif
+#define RADIXSORT_NBINS (1U << RADIXSORT_BITS)
+
+// Index of the counter of digit d of core c
+#define RADIXSORT_HIDX(c, d, local)                                            \
+  ((local) ? (((d) / BANKING_FACTOR) * NUM_BANKS + (c)*BANKING_FACTOR +       \
+              (d) % BANKING_FACTOR)                                            \
+           : ((c)*RADIXSORT_NBINS + (d)))
+
+/**
+  @brief         Parallel exclusive scan of the totals of the digits, with an
+  up-sweep and a down-sweep of a binary tree.
+  @param[in,out] pTotal points to the RADIXSORT_NBINS totals of the digits
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_radixsort_scan_i32p(uint32_t *pTotal, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t s, i, idx, t;
+
+  // Up-sweep
+  for (s = 1; s < RADIXSORT_NBINS; s <<= 1U) {
+    for (i = core_id; i < RADIXSORT_NBINS / (2U * s); i += nPE) {
+      idx = (2U * i + 2U) * s - 1U;
+      pTotal[idx] += pTotal[idx - s];
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  }
+  // Down-sweep
+  for (s = RADIXSORT_NBINS / 2U; s > 0; s >>= 1U) {
+    for (i = core_id; i < RADIXSORT_NBINS / (2U * s); i += nPE) {
+      idx = (2U * i + 2U) * s - 1U;
+      t = pTotal[idx - s];
+      pTotal[idx - s] = (s == RADIXSORT_NBINS / 2U) ? 0 : pTotal[idx];
+      pTotal[idx] = (s == RADIXSORT_NBINS / 2U) ? t : pTotal[idx] + t;
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  }
+  return;
+}
+
+/**
+  @brief         Parallel LSD radix sort.
+  @param[in,out] pKeys points to the keys
+  @param[in,out] pVals points to the values, or NULL
+  @param[in]     pKeysTmp points to a buffer of n keys
+  @param[in]     pValsTmp points to a buffer of n values, or NULL
+  @param[in]     pHist points to the histograms of the cores
+  @param[in]     pTotal points to RADIXSORT_NBINS words
+  @param[in]     n number of keys
+  @param[in]     local_hist histograms in the local banks of the cores
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_radixsort_i32p(uint32_t *pKeys, uint32_t *pVals,
+                            uint32_t *pKeysTmp, uint32_t *pValsTmp,
+                            uint32_t *pHist, uint32_t *pTotal,
+                            const uint32_t n, const uint32_t local_hist,
+                            const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t start = (n / nPE) * core_id + ((n % nPE) * core_id) / nPE;
+  uint32_t end = (n / nPE) * (core_id + 1) + ((n % nPE) * (core_id + 1)) / nPE;
+  uint32_t shift, i, c, d, sum, cnt, key;
+  uint32_t *pTmp;
+
+  for (shift = 0; shift < 32; shift += RADIXSORT_BITS) {
+
+    /* HISTOGRAM */
+    for (d = 0; d < RADIXSORT_NBINS; d++) {
+      pHist[RADIXSORT_HIDX(core_id, d, local_hist)] = 0;
+    }
+    for (i = start; i < end; i++) {
+      d = (pKeys[i] >> shift) & (RADIXSORT_NBINS - 1U);
+      pHist[RADIXSORT_HIDX(core_id, d, local_hist)]++;
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    /* SCAN */
+    // Over the cores, the histograms hold the offsets within the digit
+    for (d = core_id; d < RADIXSORT_NBINS; d += nPE) {
+      sum = 0;
+      for (c = 0; c < nPE; c++) {
+        cnt = pHist[RADIXSORT_HIDX(c, d, local_hist)];
+        pHist[RADIXSORT_HIDX(c, d, local_hist)] = sum;
+        sum += cnt;
+      }
+      pTotal[d] = sum;
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+    // Over the digits
+    mempool_radixsort_scan_i32p(pTotal, nPE);
+
+    /* SCATTER */
+    for (d = 0; d < RADIXSORT_NBINS; d++) {
+      pHist[RADIXSORT_HIDX(core_id, d, local_hist)] += pTotal[d];
+    }
+    for (i = start; i < end; i++) {
+      key = pKeys[i];
+      d = (key >> shift) & (RADIXSORT_NBINS - 1U);
+      c = pHist[RADIXSORT_HIDX(core_id, d, local_hist)]++;
+      pKeysTmp[c] = key;
+      if (pVals != NULL) {
+        pValsTmp[c] = pVals[i];
+      }
+    }
+    mempool_log_partial_barrier(2, absolute_core_id, nPE);
+
+    pTmp = pKeys;
+    pKeys = pKeysTmp;
+    pKeysTmp = pTmp;
+    pTmp = pVals;
+    pVals = pValsTmp;
+    pValsTmp = pTmp;
+  }
+  return;
+}
+
+/**
+  @brief         Parallel bitonic sort.
+  @param[in,out] pKeys points to the keys
+  @param[in,out] pVals points to the values, or NULL
+  @param[in]     n number of keys, power of two
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_bitonicsort_i32p(uint32_t *pKeys, uint32_t *pVals,
+                              const uint32_t n, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t k, j, p, i, l, a, b;
+
+  for (k = 2; k <= n; k <<= 1U) {
+    for (j = k >> 1U; j > 0; j >>= 1U) {
+      for (p = core_id; p < n / 2U; p += nPE) {
+        // Pair (i, i + j), ascending if the bit k of i is not set
+        i = 2U * j * (p / j) + (p % j);
+        l = i + j;
+        a = pKeys[i];
+        b = pKeys[l];
+        if (((i & k) == 0) == (a > b)) {
+          pKeys[i] = b;
+          pKeys[l] = a;
+          if (pVals != NULL) {
+            a = pVals[i];
+            pVals[i] = pVals[l];
+            pVals[l] = a;
+          }
+        }
+      }
+      mempool_log_partial_barrier(2, absolute_core_id, nPE);
+    }
+  }
+  return;
+}
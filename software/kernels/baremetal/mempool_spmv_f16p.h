@@ -0,0 +1,140 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel sparse matrix-vector multiplication y = A x on 16b floating point
+data, same partitioning as mempool_spmv_i32p.h. Pairs of nonzeros and of the
+gathered elements of x are packed in SIMD registers and accumulated in f32
+with vfdotpex.s.h.
+The ELLPACK blocks of BANKING_FACTOR rows only keep the 32b column indexes in
+the local banks of a core. The nonzeros and y pack two rows per word, so the
+block of a core spans BANKING_FACTOR / 2 banks, of the core with half its id.
+*/
+
+#pragma once
+#include "baremetal/mempool_spmv_partition.h"
+#include "builtins_v2.h"
+
+/**
+  @brief         Parallel CSR sparse matrix-vector multiplication.
+  @param[in]     pVal points to the nonzeros
+  @param[in]     pColIdx points to the column indexes of the nonzeros
+  @param[in]     pRowPtr points to the row pointer
+  @param[in]     pRowSplit points to the row ranges of the cores
+  @param[in]     pX points to the input vector
+  @param[in]     replicated x is replicated in the banks of each group
+  @param[out]    pY points to the output vector
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_csr_spmv_f16p(const __fp16 *pVal, const uint32_t *pColIdx,
+                           const uint32_t *pRowPtr, const uint32_t *pRowSplit,
+                           const __fp16 *pX, const uint32_t replicated,
+                           __fp16 *pY, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t xs = 0;
+  uint32_t r, k, end, c0, c1;
+  __fp16 a0, a1, x0, x1, res;
+  const __fp16 zero = (__fp16)0.0f;
+  v2h a01, x01;
+  float sum;
+
+  if (replicated) {
+    pX += 2 * mempool_get_group_id() * SPMV_GROUP_BANKS;
+    xs = NUM_BANKS - SPMV_GROUP_BANKS;
+  }
+  for (r = pRowSplit[core_id]; r < pRowSplit[core_id + 1]; r++) {
+    sum = 0.0f;
+    end = pRowPtr[r + 1];
+    for (k = pRowPtr[r]; k < end; k += 2) {
+      c0 = pColIdx[k];
+      a0 = pVal[k];
+      x0 = pX[SPMV_XIDX_16(c0, xs)];
+      // Odd number of nonzeros, the last pair is padded with zeros
+      a1 = zero;
+      x1 = zero;
+      if (k + 1 < end) {
+        c1 = pColIdx[k + 1];
+        a1 = pVal[k + 1];
+        x1 = pX[SPMV_XIDX_16(c1, xs)];
+      }
+      asm volatile("pv.pack.h    %[a01], %[a1], %[a0];"
+                   "pv.pack.h    %[x01], %[x1], %[x0];"
+                   "vfdotpex.s.h %[sum], %[a01], %[x01];"
+                   : [sum] "+&r"(sum), [a01] "=&r"(a01), [x01] "=&r"(x01)
+                   : [a0] "r"(a0), [a1] "r"(a1), [x0] "r"(x0), [x1] "r"(x1)
+                   :);
+    }
+    asm volatile("fcvt.h.s %0, %1;" : "=r"(res) : "r"(sum) :);
+    pY[r] = res;
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
+
+/**
+  @brief         Parallel ELLPACK sparse matrix-vector multiplication.
+  @param[in]     pVal points to the nonzeros, column-major
+  @param[in]     pColIdx points to the column indexes of the nonzeros
+  @param[in]     nRows number of rows of the matrix
+  @param[in]     width number of nonzeros per row
+  @param[in]     pX points to the input vector
+  @param[in]     replicated x is replicated in the banks of each group
+  @param[out]    pY points to the output vector
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_ell_spmv_f16p(const __fp16 *pVal, const uint32_t *pColIdx,
+                           const uint32_t nRows, const uint32_t width,
+                           const __fp16 *pX, const uint32_t replicated,
+                           __fp16 *pY, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t xs = 0;
+  uint32_t r0, r, re, k, c0, c1;
+  __fp16 a0, a1, x0, x1, res;
+  const __fp16 zero = (__fp16)0.0f;
+  v2h a01, x01;
+  float sum;
+
+  if (replicated) {
+    pX += 2 * mempool_get_group_id() * SPMV_GROUP_BANKS;
+    xs = NUM_BANKS - SPMV_GROUP_BANKS;
+  }
+  for (r0 = core_id * BANKING_FACTOR; r0 < nRows;
+       r0 += nPE * BANKING_FACTOR) {
+    re = (r0 + BANKING_FACTOR < nRows) ? (r0 + BANKING_FACTOR) : nRows;
+    for (r = r0; r < re; r++) {
+      sum = 0.0f;
+      for (k = 0; k < width; k += 2) {
+        c0 = pColIdx[k * nRows + r];
+        a0 = pVal[k * nRows + r];
+        x0 = pX[SPMV_XIDX_16(c0, xs)];
+        a1 = zero;
+        x1 = zero;
+        if (k + 1 < width) {
+          c1 = pColIdx[(k + 1) * nRows + r];
+          a1 = pVal[(k + 1) * nRows + r];
+          x1 = pX[SPMV_XIDX_16(c1, xs)];
+        }
+        asm volatile("pv.pack.h    %[a01], %[a1], %[a0];"
+                     "pv.pack.h    %[x01], %[x1], %[x0];"
+                     "vfdotpex.s.h %[sum], %[a01], %[x01];"
+                     : [sum] "+&r"(sum), [a01] "=&r"(a01), [x01] "=&r"(x01)
+                     : [a0] "r"(a0), [a1] "r"(a1), [x0] "r"(x0), [x1] "r"(x1)
+                     :);
+      }
+      asm volatile("fcvt.h.s %0, %1;" : "=r"(res) : "r"(sum) :);
+      pY[r] = res;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
@@ -0,0 +1,132 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Parallel sparse matrix-vector multiplication y = A x on 32b floating point data.
+- CSR: each core computes a range of rows with about the same number of
+nonzeros, from mempool_spmv_partition.
+- ELLPACK: the matrix is stored column-major, padded to the same number of
+nonzeros per row. Blocks of BANKING_FACTOR rows are assigned round-robin, so
+that with nPE = NUM_CORES and nRows a multiple of NUM_BANKS, the slices of y
+and of the matrix of each core are in its local banks.
+x is either shared, or replicated in the banks of each group by
+mempool_spmv_replicate.
+*/
+
+#pragma once
+#include "baremetal/mempool_spmv_partition.h"
+
+/**
+  @brief         Parallel CSR sparse matrix-vector multiplication.
+  @param[in]     pVal points to the nonzeros
+  @param[in]     pColIdx points to the column indexes of the nonzeros
+  @param[in]     pRowPtr points to the row pointer
+  @param[in]     pRowSplit points to the row ranges of the cores
+  @param[in]     pX points to the input vector
+  @param[in]     replicated x is replicated in the banks of each group
+  @param[out]    pY points to the output vector
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_csr_spmv_f32p(const float *pVal, const uint32_t *pColIdx,
+                           const uint32_t *pRowPtr, const uint32_t *pRowSplit,
+                           const float *pX, const uint32_t replicated,
+                           float *pY, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t xs = 0;
+  uint32_t r, k, end, c0, c1;
+  float sum0, sum1, a0, a1, x0, x1;
+
+  if (replicated) {
+    pX += mempool_get_group_id() * SPMV_GROUP_BANKS;
+    xs = NUM_BANKS - SPMV_GROUP_BANKS;
+  }
+  for (r = pRowSplit[core_id]; r < pRowSplit[core_id + 1]; r++) {
+    sum0 = 0.0f;
+    sum1 = 0.0f;
+    end = pRowPtr[r + 1];
+    for (k = pRowPtr[r]; k + 1 < end; k += 2) {
+      c0 = pColIdx[k];
+      c1 = pColIdx[k + 1];
+      a0 = pVal[k];
+      a1 = pVal[k + 1];
+      x0 = pX[SPMV_XIDX(c0, xs)];
+      x1 = pX[SPMV_XIDX(c1, xs)];
+      asm volatile("fmadd.s %[sum0], %[a0], %[x0], %[sum0];"
+                   "fmadd.s %[sum1], %[a1], %[x1], %[sum1];"
+                   : [sum0] "+&r"(sum0), [sum1] "+&r"(sum1)
+                   : [a0] "r"(a0), [a1] "r"(a1), [x0] "r"(x0), [x1] "r"(x1)
+                   :);
+    }
+    if (k < end) {
+      c0 = pColIdx[k];
+      sum0 += pVal[k] * pX[SPMV_XIDX(c0, xs)];
+    }
+    pY[r] = sum0 + sum1;
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
+
+/**
+  @brief         Parallel ELLPACK sparse matrix-vector multiplication.
+  @param[in]     pVal points to the nonzeros, column-major
+  @param[in]     pColIdx points to the column indexes of the nonzeros
+  @param[in]     nRows number of rows of the matrix
+  @param[in]     width number of nonzeros per row
+  @param[in]     pX points to the input vector
+  @param[in]     replicated x is replicated in the banks of each group
+  @param[out]    pY points to the output vector
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_ell_spmv_f32p(const float *pVal, const uint32_t *pColIdx,
+                           const uint32_t nRows, const uint32_t width,
+                           const float *pX, const uint32_t replicated,
+                           float *pY, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t xs = 0;
+  uint32_t r0, r, re, k, c0, c1;
+  float sum0, sum1, a0, a1, x0, x1;
+
+  if (replicated) {
+    pX += mempool_get_group_id() * SPMV_GROUP_BANKS;
+    xs = NUM_BANKS - SPMV_GROUP_BANKS;
+  }
+  for (r0 = core_id * BANKING_FACTOR; r0 < nRows;
+       r0 += nPE * BANKING_FACTOR) {
+    re = (r0 + BANKING_FACTOR < nRows) ? (r0 + BANKING_FACTOR) : nRows;
+    for (r = r0; r < re; r++) {
+      sum0 = 0.0f;
+      sum1 = 0.0f;
+      for (k = 0; k + 1 < width; k += 2) {
+        c0 = pColIdx[k * nRows + r];
+        c1 = pColIdx[(k + 1) * nRows + r];
+        a0 = pVal[k * nRows + r];
+        a1 = pVal[(k + 1) * nRows + r];
+        x0 = pX[SPMV_XIDX(c0, xs)];
+        x1 = pX[SPMV_XIDX(c1, xs)];
+        asm volatile("fmadd.s %[sum0], %[a0], %[x0], %[sum0];"
+                     "fmadd.s %[sum1], %[a1], %[x1], %[sum1];"
+                     : [sum0] "+&r"(sum0), [sum1] "+&r"(sum1)
+                     : [a0] "r"(a0), [a1] "r"(a1), [x0] "r"(x0), [x1] "r"(x1)
+                     :);
+      }
+      if (k < width) {
+        c0 = pColIdx[k * nRows + r];
+        sum0 += pVal[k * nRows + r] * pX[SPMV_XIDX(c0, xs)];
+      }
+      pY[r] = sum0 + sum1;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
@@ -0,0 +1,89 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Marco Bertuletti, ETH Zurich
+
+/*
+
+Helpers of the sparse matrix-vector multiplication kernels.
+- mempool_spmv_partition splits the rows of a CSR matrix in nPE ranges with
+about the same number of nonzeros.
+- mempool_spmv_replicate copies the x vector in the banks of each group. In
+the copy of group g, the element i is in the word
+(i / SPMV_GROUP_BANKS) * NUM_BANKS + g * SPMV_GROUP_BANKS + i % SPMV_GROUP_BANKS
+so that the cores of a group never read x from another group.
+*/
+
+#pragma once
+
+#define SPMV_GROUP_BANKS (NUM_BANKS / NUM_GROUPS)
+
+// Index of element c of x, xs is 0 for the shared vector and
+// (NUM_BANKS - SPMV_GROUP_BANKS) for the copies of the groups
+#define SPMV_XIDX(c, xs) ((c) + ((c) / SPMV_GROUP_BANKS) * (xs))
+// Same for 16b elements, two per word
+#define SPMV_XIDX_16(c, xs) ((c) + ((c) / (2 * SPMV_GROUP_BANKS)) * 2 * (xs))
+
+/**
+  @brief         Parallel partitioning of the rows of a CSR matrix by number
+  of nonzeros. Each core looks for the first row of its range with a binary
+  search on the row pointer.
+  @param[in]     pRowPtr points to the row pointer of the CSR matrix
+  @param[in]     nRows number of rows of the matrix
+  @param[out]    pRowSplit points to the nPE + 1 boundaries of the ranges
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_spmv_partition(const uint32_t *pRowPtr, const uint32_t nRows,
+                            uint32_t *pRowSplit, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t target = (pRowPtr[nRows] / nPE) * core_id +
+                    ((pRowPtr[nRows] % nPE) * core_id) / nPE;
+  uint32_t lo = 0, hi = nRows, mid;
+
+  // First row starting at or after the target nonzero
+  while (lo < hi) {
+    mid = (lo + hi) >> 1U;
+    if (pRowPtr[mid] < target) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+  pRowSplit[core_id] = lo;
+  if (core_id == 0) {
+    pRowSplit[nPE] = nRows;
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
+
+/**
+  @brief         Parallel copy of a vector in the banks of each group.
+  @param[in]     pSrc points to the vector, as 32b words
+  @param[out]    pDst points to the copies, of size
+  ceil(nWords / SPMV_GROUP_BANKS) * NUM_BANKS words
+  @param[in]     nWords number of words of the vector
+  @param[in]     nPE number of cores
+  @return        none
+*/
+void mempool_spmv_replicate(const uint32_t *pSrc, uint32_t *pDst,
+                            const uint32_t nWords, const uint32_t nPE) {
+
+  uint32_t absolute_core_id = mempool_get_core_id();
+  uint32_t core_id = absolute_core_id % nPE;
+  uint32_t i, g, idx, word;
+
+  for (i = core_id; i < nWords; i += nPE) {
+    word = pSrc[i];
+    idx = (i / SPMV_GROUP_BANKS) * NUM_BANKS + i % SPMV_GROUP_BANKS;
+    for (g = 0; g < NUM_GROUPS; g++) {
+      pDst[idx + g * SPMV_GROUP_BANKS] = word;
+    }
+  }
+  mempool_log_partial_barrier(2, absolute_core_id, nPE);
+  return;
+}
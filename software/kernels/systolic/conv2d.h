@@ -0,0 +1,95 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+/* This library implements a weight-stationary 2D convolution
+ * on the generic systolic array of systolic.h
+ */
+
+/* The output O of size (M - K + 1) x (N - K + 1) is computed from the M x N
+ * image I and the K x K kernel W as
+ * O[y][x] = sum_{i,j} W[i][j] * I[y + i][x + j]
+ *
+ * The grid has K rows and B * K columns, one block of K x K PEs computes the
+ * output rows y = b, b + B, b + 2B, ...
+ * PE (i, j) of a block holds the weight W[i][K - 1 - j]. The image row y + i
+ * streams along row i of the block, together with the partial sums, so that
+ * the last PE of the row gets the 1D correlation of the row with W[i]. The
+ * rows are then accumulated from north to south in the last column of the
+ * block and stored by the bottom right PE.
+ */
+
+#pragma once
+
+#include "systolic/systolic.h"
+
+typedef struct {
+  int32_t const *image;
+  int32_t const *weights;
+  int32_t *output;
+  uint32_t num_rows;
+  uint32_t num_cols;
+  uint32_t kernel_size;
+} systolic_conv2d_t;
+
+void systolic_conv2d_init(const uint32_t kernel_size) {
+  uint32_t num_blocks = NUM_CORES / (kernel_size * kernel_size);
+  systolic_init(kernel_size, num_blocks * kernel_size,
+                SYSTOLIC_LINK_HORZ | SYSTOLIC_LINK_VERT);
+}
+
+void systolic_conv2d_pe(systolic_pe_t *pe, void *args) {
+  systolic_conv2d_t const *conv = (systolic_conv2d_t const *)args;
+  uint32_t const k = conv->kernel_size;
+  uint32_t const num_cols = conv->num_cols;
+  uint32_t const num_rows_O = conv->num_rows - k + 1;
+  uint32_t const num_cols_O = num_cols - k + 1;
+  uint32_t const num_blocks = systolic_num_cols / k;
+  uint32_t const i = pe->row_idx;
+  uint32_t const j = pe->col_idx % k;
+  int32_t const weight = conv->weights[i * k + (k - 1 - j)];
+  int32_t const *row_I;
+  int32_t data_horz[2]; // pixel and partial sum
+  int32_t data_vert;
+  int32_t pixel;
+  int32_t prev_pixel = 0;
+  int32_t sum;
+
+  for (uint32_t y = pe->col_idx / k; y < num_rows_O; y += num_blocks) {
+    row_I = &conv->image[(y + i) * num_cols];
+    for (uint32_t x = 0; x < num_cols; ++x) {
+      // Get pixel and partial sum from the west
+      if (j == 0) {
+        pixel = row_I[x];
+        sum = 0;
+      } else {
+        systolic_pop(pe, SYSTOLIC_HORZ, &data_horz[0]);
+        systolic_pop(pe, SYSTOLIC_HORZ, &data_horz[1]);
+        pixel = data_horz[0];
+        sum = data_horz[1];
+      }
+      sum += weight * pixel;
+      if (j != k - 1) {
+        // Forward the pixel delayed by one step
+        data_horz[0] = prev_pixel;
+        data_horz[1] = sum;
+        systolic_push(pe, SYSTOLIC_HORZ, &data_horz[0]);
+        systolic_push(pe, SYSTOLIC_HORZ, &data_horz[1]);
+        prev_pixel = pixel;
+      } else {
+        // Accumulate the rows of the kernel
+        if (i != 0) {
+          systolic_pop(pe, SYSTOLIC_VERT, &data_vert);
+          sum += data_vert;
+        }
+        if (i != k - 1) {
+          systolic_push(pe, SYSTOLIC_VERT, &sum);
+        } else if (x >= k - 1) {
+          conv->output[y * num_cols_O + x - (k - 1)] = sum;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,86 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+/* This library implements a FIR filter
+ * on the generic systolic array of systolic.h
+ */
+
+/* y[n] = sum_{l < T} h[l] * x[n - l], with x[n] = 0 for n < 0
+ *
+ * The grid is a single row of P PEs, and PE p holds the taps
+ * h[p * T / P] ... h[(p + 1) * T / P - 1] with a delay line of as many
+ * samples. Each step, the sample leaving the delay line of a PE is forwarded
+ * to the east together with the partial sum, the last PE stores y[n].
+ * T / P must be an integer of at most SYSTOLIC_FIR_MAX_TAPS.
+ */
+
+#pragma once
+
+#include "systolic/systolic.h"
+
+// Maximum number of taps per PE
+#ifndef SYSTOLIC_FIR_MAX_TAPS
+#define SYSTOLIC_FIR_MAX_TAPS 16
+#endif
+
+typedef struct {
+  int32_t const *input;
+  int32_t const *taps;
+  int32_t *output;
+  uint32_t num_samples;
+  uint32_t num_taps;
+} systolic_fir_t;
+
+void systolic_fir_init(const uint32_t num_pe) {
+  systolic_init(1, num_pe, SYSTOLIC_LINK_HORZ);
+}
+
+void systolic_fir_pe(systolic_pe_t *pe, void *args) {
+  systolic_fir_t const *fir = (systolic_fir_t const *)args;
+  uint32_t const col_idx = pe->col_idx;
+  uint32_t const num_taps_pe = fir->num_taps / systolic_num_cols;
+  int32_t taps[SYSTOLIC_FIR_MAX_TAPS];
+  int32_t delay_line[SYSTOLIC_FIR_MAX_TAPS];
+  int32_t data[2]; // sample and partial sum
+  int32_t sample_out;
+  int32_t sum;
+  uint32_t l;
+
+  // Local copy of the taps
+  for (l = 0; l < num_taps_pe; ++l) {
+    taps[l] = fir->taps[col_idx * num_taps_pe + l];
+    delay_line[l] = 0;
+  }
+
+  for (uint32_t n = 0; n < fir->num_samples; ++n) {
+    // Get sample and partial sum from the west
+    if (col_idx == 0) {
+      data[0] = fir->input[n];
+      data[1] = 0;
+    } else {
+      systolic_pop(pe, SYSTOLIC_HORZ, &data[0]);
+      systolic_pop(pe, SYSTOLIC_HORZ, &data[1]);
+    }
+    // Shift the delay line and accumulate
+    sample_out = delay_line[num_taps_pe - 1];
+    sum = data[1];
+    for (l = num_taps_pe - 1; l > 0; --l) {
+      delay_line[l] = delay_line[l - 1];
+      sum += taps[l] * delay_line[l];
+    }
+    delay_line[0] = data[0];
+    sum += taps[0] * data[0];
+    // Forward to the east or store
+    if (col_idx != systolic_num_cols - 1) {
+      data[0] = sample_out;
+      data[1] = sum;
+      systolic_push(pe, SYSTOLIC_HORZ, &data[0]);
+      systolic_push(pe, SYSTOLIC_HORZ, &data[1]);
+    } else {
+      fir->output[n] = sum;
+    }
+  }
+}
@@ -8,7 +8,17 @@
  */
 
 // Concurrent single-producer single-consumer queue based on head and tail
-// Uses a single slot buffer for the full state to differentiate it from empty
+// Head and tail are free-running entry counters, the capacity is a power of
+// two and the buffer is indexed by masking, so that no slot is wasted to
+// differentiate the full state from empty. Unlike XQUEUE_SIZE of
+// queue_multi.h, the capacity is not a compile-time constant: the callers
+// size their queues at runtime (e.g. to a row of Smith-Waterman), so the size
+// is rounded up at creation and the mask is kept in the queue.
+//
+// With QUEUE_WFI defined, the blocking and counting pops put the consumer to
+// sleep while the queue is empty, and the next push wakes it up
+
+#pragma once
 
 #include "alloc.h"
 #include "runtime.h"
@@ -17,16 +27,36 @@ typedef struct {
   int32_t *array;
   uint32_t volatile head;
   uint32_t volatile tail;
-  uint32_t size;
+  uint32_t mask;
+#ifdef QUEUE_WFI
+  uint32_t volatile consumer;
+  uint32_t volatile sleeping;
+#endif
 } queue_t;
 
+// Round up to the next power of two
+static inline uint32_t queue_capacity(const uint32_t size) {
+  uint32_t capacity = 1;
+  while (capacity < size) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+// The capacity is size rounded up to the next power of two
 void queue_domain_create(alloc_t *alloc, queue_t **queue, const uint32_t size) {
+  uint32_t capacity = queue_capacity(size);
   queue_t *new_queue = (queue_t *)domain_malloc(alloc, sizeof(queue_t));
-  int32_t *array = (int32_t *)domain_malloc(alloc, size * sizeof(int32_t));
+  int32_t *array =
+      (int32_t *)domain_malloc(alloc, capacity * sizeof(int32_t));
   new_queue->array = array;
   new_queue->head = 0;
   new_queue->tail = 0;
-  new_queue->size = size;
+  new_queue->mask = capacity - 1;
+#ifdef QUEUE_WFI
+  new_queue->consumer = 0;
+  new_queue->sleeping = 0;
+#endif
   *queue = new_queue;
 }
 
@@ -43,6 +73,35 @@ void queue_destroy(queue_t *queue) {
   queue_domain_destroy(get_alloc_l1(), queue);
 }
 
+#ifdef QUEUE_WFI
+// Sleep until the producer pushes, the flag is claimed by exactly one side so
+// that no wake-up trigger is left pending for a later wfi (e.g. a barrier).
+// No other wake-up trigger may target the consumer while it waits.
+// Each side stores its variable and then loads the other's, the full fences
+// keep either side from reading a stale value, so that at least one of them
+// sees the other's store and the wake-up is not lost.
+static inline void queue_wait(queue_t *const queue, const uint32_t head) {
+  queue->consumer = mempool_get_core_id();
+  __atomic_store_n(&queue->sleeping, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (head == queue->tail) {
+    mempool_wfi();
+  } else if (__atomic_exchange_n(&queue->sleeping, 0, __ATOMIC_SEQ_CST) == 0) {
+    // The producer claimed the flag, consume its wake-up trigger
+    mempool_wfi();
+  }
+}
+
+static inline void queue_notify(queue_t *const queue) {
+  // Order the store of the tail before the load of the flag
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (queue->sleeping &&
+      __atomic_exchange_n(&queue->sleeping, 0, __ATOMIC_SEQ_CST)) {
+    wake_up(queue->consumer);
+  }
+}
+#endif
+
 int32_t queue_pop(queue_t *const queue, int32_t *data) {
   uint32_t current_head = queue->head;
   // Check if empty
@@ -50,29 +109,86 @@ int32_t queue_pop(queue_t *const queue, int32_t *data) {
     return 1;
   }
   // Read data
-  *data = queue->array[current_head];
+  *data = queue->array[current_head & queue->mask];
+  // Complete the loads before the producer can reuse the slots
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
   // Update head
-  queue->head = (current_head + 1) % queue->size;
+  queue->head = current_head + 1;
   return 0;
 }
 
 int32_t queue_push(queue_t *const queue, int32_t *data) {
   uint32_t current_tail = queue->tail;
-  uint32_t next_tail = (current_tail + 1) % queue->size;
-  // Check if full (with one slot constantly open)
-  if (next_tail == queue->head) {
+  // Check if full
+  if (current_tail - queue->head > queue->mask) {
     return 1;
   }
   // Write data
-  queue->array[current_tail] = *data;
-  __asm__ __volatile__("" : : : "memory");
+  queue->array[current_tail & queue->mask] = *data;
+  // Complete the stores before the consumer can see the new tail
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
   // Safely update tail
-  queue->tail = next_tail;
+  queue->tail = current_tail + 1;
+#ifdef QUEUE_WFI
+  queue_notify(queue);
+#endif
   return 0;
 }
 
+// Pop up to n entries with a single update of the head
+// Returns the number of entries read
+uint32_t queue_pop_n(queue_t *const queue, int32_t *data, const uint32_t n) {
+  uint32_t current_head = queue->head;
+  uint32_t mask = queue->mask;
+  uint32_t count = queue->tail - current_head;
+  if (count > n) {
+    count = n;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  // Read data
+  for (uint32_t i = 0; i < count; ++i) {
+    data[i] = queue->array[(current_head + i) & mask];
+  }
+  // Complete the loads before the producer can reuse the slots
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  // Update head
+  queue->head = current_head + count;
+  return count;
+}
+
+// Push up to n entries with a single update of the tail
+// Returns the number of entries written
+uint32_t queue_push_n(queue_t *const queue, int32_t *data, const uint32_t n) {
+  uint32_t current_tail = queue->tail;
+  uint32_t mask = queue->mask;
+  uint32_t count = mask + 1 - (current_tail - queue->head);
+  if (count > n) {
+    count = n;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  // Write data
+  for (uint32_t i = 0; i < count; ++i) {
+    queue->array[(current_tail + i) & mask] = data[i];
+  }
+  // Complete the stores before the consumer can see the new tail
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  // Safely update tail
+  queue->tail = current_tail + count;
+#ifdef QUEUE_WFI
+  queue_notify(queue);
+#endif
+  return count;
+}
+
 void blocking_queue_pop(queue_t *const queue, int32_t *data) {
   while (queue_pop(queue, data)) {
+#ifdef QUEUE_WFI
+    queue_wait(queue, queue->head);
+#endif
   };
 }
 
@@ -85,6 +201,9 @@ void counting_queue_pop(queue_t *const queue, int32_t *data,
                         uint32_t *counter) {
   while (queue_pop(queue, data)) {
     (*counter)++;
+#ifdef QUEUE_WFI
+    queue_wait(queue, queue->head);
+#endif
   };
 }
 
@@ -94,3 +213,55 @@ void counting_queue_push(queue_t *const queue, int32_t *data,
     (*counter)++;
   };
 }
+
+void blocking_queue_pop_n(queue_t *const queue, int32_t *data, uint32_t n) {
+  uint32_t count;
+  while (n) {
+    count = queue_pop_n(queue, data, n);
+#ifdef QUEUE_WFI
+    if (count == 0) {
+      queue_wait(queue, queue->head);
+    }
+#endif
+    data += count;
+    n -= count;
+  }
+}
+
+void blocking_queue_push_n(queue_t *const queue, int32_t *data, uint32_t n) {
+  uint32_t count;
+  while (n) {
+    count = queue_push_n(queue, data, n);
+    data += count;
+    n -= count;
+  }
+}
+
+void counting_queue_pop_n(queue_t *const queue, int32_t *data, uint32_t n,
+                          uint32_t *counter) {
+  uint32_t count;
+  while (n) {
+    count = queue_pop_n(queue, data, n);
+    if (count == 0) {
+      (*counter)++;
+#ifdef QUEUE_WFI
+      queue_wait(queue, queue->head);
+#endif
+    }
+    data += count;
+    n -= count;
+  }
+}
+
+void counting_queue_push_n(queue_t *const queue, int32_t *data, uint32_t n,
+                           uint32_t *counter) {
+  uint32_t count;
+  while (n) {
+    count = queue_push_n(queue, data, n);
+    if (count == 0) {
+      (*counter)++;
+    }
+    data += count;
+    n -= count;
+  }
+}
@@ -8,18 +8,37 @@
  */
 
 // Concurrent single-producer single-consumer queue based on head and tail
-// Uses a single slot buffer for the full state to differentiate it from empty
+// Head and tail are free-running entry counters written by a single side
+// each, so no atomic operation is needed. The capacity XQUEUE_SIZE is a power
+// of two and the buffer is indexed by masking.
+//
+// With QUEUE_WFI defined, the blocking and counting pops put the consumer to
+// sleep while the queue is empty, and the next push wakes it up
+
+#pragma once
 
 #include "alloc.h"
 #include "runtime.h"
 
+#ifndef DATA_SIZE
 #define DATA_SIZE 4 // number of words in a queue entry
+#endif
+
+#if (XQUEUE_SIZE == 0) || (XQUEUE_SIZE & (XQUEUE_SIZE - 1))
+#error XQUEUE_SIZE must be a power of two
+#endif
+
+// Word offset of an entry in the buffer
+#define QUEUE_OFFSET(idx) (((idx) & (XQUEUE_SIZE - 1)) * DATA_SIZE)
 
 typedef struct {
   int32_t *buffer;
-  uint32_t head;
-  uint32_t tail;
-  uint32_t volatile counter;
+  uint32_t volatile head;
+  uint32_t volatile tail;
+#ifdef QUEUE_WFI
+  uint32_t volatile consumer;
+  uint32_t volatile sleeping;
+#endif
 } queue_t;
 
 void queue_domain_create(alloc_t *alloc, queue_t **queue) {
@@ -29,7 +48,10 @@ void queue_domain_create(alloc_t *alloc, queue_t **queue) {
   new_queue->buffer = buffer;
   new_queue->head = 0;
   new_queue->tail = 0;
-  new_queue->counter = 0;
+#ifdef QUEUE_WFI
+  new_queue->consumer = 0;
+  new_queue->sleeping = 0;
+#endif
   *queue = new_queue;
 }
 
@@ -46,21 +68,75 @@ void queue_destroy(queue_t *queue) {
   queue_domain_destroy(get_alloc_l1(), queue);
 }
 
+#ifdef QUEUE_WFI
+// Sleep until the producer pushes, the flag is claimed by exactly one side so
+// that no wake-up trigger is left pending for a later wfi (e.g. a barrier).
+// No other wake-up trigger may target the consumer while it waits.
+// Each side stores its variable and then loads the other's, the full fences
+// keep either side from reading a stale value, so that at least one of them
+// sees the other's store and the wake-up is not lost.
+static inline void queue_wait(queue_t *const queue, const uint32_t head) {
+  queue->consumer = mempool_get_core_id();
+  __atomic_store_n(&queue->sleeping, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (head == queue->tail) {
+    mempool_wfi();
+  } else if (__atomic_exchange_n(&queue->sleeping, 0, __ATOMIC_SEQ_CST) == 0) {
+    // The producer claimed the flag, consume its wake-up trigger
+    mempool_wfi();
+  }
+}
+
+static inline void queue_notify(queue_t *const queue) {
+  // Order the store of the tail before the load of the flag
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (queue->sleeping &&
+      __atomic_exchange_n(&queue->sleeping, 0, __ATOMIC_SEQ_CST)) {
+    wake_up(queue->consumer);
+  }
+}
+#endif
+
+// Copy count entries out of the queue and update the head
+static inline void queue_read(queue_t *const queue, int32_t *data,
+                              const uint32_t head, const uint32_t count) {
+  for (uint32_t n = 0; n < count; ++n) {
+    int32_t *array = queue->buffer + QUEUE_OFFSET(head + n);
+    for (uint32_t i = 0; i < DATA_SIZE; ++i) {
+      data[i] = array[i];
+    }
+    data += DATA_SIZE;
+  }
+  // Complete the loads before the producer can reuse the slots
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  queue->head = head + count;
+}
+
+// Copy count entries into the queue and update the tail
+static inline void queue_write(queue_t *const queue, int32_t *data,
+                               const uint32_t tail, const uint32_t count) {
+  for (uint32_t n = 0; n < count; ++n) {
+    int32_t *array = queue->buffer + QUEUE_OFFSET(tail + n);
+    for (uint32_t i = 0; i < DATA_SIZE; ++i) {
+      array[i] = data[i];
+    }
+    data += DATA_SIZE;
+  }
+  // Complete the stores before the consumer can see the new tail
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  queue->tail = tail + count;
+#ifdef QUEUE_WFI
+  queue_notify(queue);
+#endif
+}
+
 int32_t queue_pop(queue_t *const queue, int32_t *data) {
   uint32_t current_head = queue->head;
   // Check if empty
-  if (queue->counter == 0) {
+  if (current_head == queue->tail) {
     return 1;
   }
-  // Copy data to data pointer
-  int32_t *array = queue->buffer + current_head;
-  for (uint32_t i = 0; i < DATA_SIZE; ++i) {
-    data[i] = array[i];
-  }
-  // Update head
-  queue->head = (current_head + DATA_SIZE) % (XQUEUE_SIZE * DATA_SIZE);
-  // Update counter
-  __atomic_fetch_sub(&(queue->counter), 1, __ATOMIC_SEQ_CST);
+  queue_read(queue, data, current_head, 1);
   // Return success
   return 0;
 }
@@ -68,86 +144,132 @@ int32_t queue_pop(queue_t *const queue, int32_t *data) {
 int32_t queue_push(queue_t *const queue, int32_t *data) {
   uint32_t current_tail = queue->tail;
   // Check if full
-  if (queue->counter == XQUEUE_SIZE) {
+  if (current_tail - queue->head == XQUEUE_SIZE) {
     return 1;
   }
-  // Copy data from data pointer
-  int32_t *array = queue->buffer + current_tail;
-  for (uint32_t i = 0; i < DATA_SIZE; ++i) {
-    array[i] = data[i];
-  }
-  // Update tail
-  queue->tail = (current_tail + DATA_SIZE) % (XQUEUE_SIZE * DATA_SIZE);
-  // Update counter
-  __atomic_fetch_add(&(queue->counter), 1, __ATOMIC_SEQ_CST);
+  queue_write(queue, data, current_tail, 1);
   // Return success
   return 0;
 }
 
+// Pop up to n entries (n * DATA_SIZE words) with a single update of the head
+// Returns the number of entries read
+uint32_t queue_pop_n(queue_t *const queue, int32_t *data, const uint32_t n) {
+  uint32_t current_head = queue->head;
+  uint32_t count = queue->tail - current_head;
+  if (count > n) {
+    count = n;
+  }
+  if (count) {
+    queue_read(queue, data, current_head, count);
+  }
+  return count;
+}
+
+// Push up to n entries (n * DATA_SIZE words) with a single update of the tail
+// Returns the number of entries written
+uint32_t queue_push_n(queue_t *const queue, int32_t *data, const uint32_t n) {
+  uint32_t current_tail = queue->tail;
+  uint32_t count = XQUEUE_SIZE - (current_tail - queue->head);
+  if (count > n) {
+    count = n;
+  }
+  if (count) {
+    queue_write(queue, data, current_tail, count);
+  }
+  return count;
+}
+
 void blocking_queue_pop(queue_t *const queue, int32_t *data) {
   uint32_t current_head = queue->head;
   // Wait until not empty
-  while (queue->counter == 0) {
-  }
-  // Copy data to data pointer
-  int32_t *array = queue->buffer + current_head;
-  for (uint32_t i = 0; i < DATA_SIZE; ++i) {
-    data[i] = array[i];
+  while (current_head == queue->tail) {
+#ifdef QUEUE_WFI
+    queue_wait(queue, current_head);
+#endif
   }
-  // Update head
-  queue->head = (current_head + DATA_SIZE) % (XQUEUE_SIZE * DATA_SIZE);
-  // Update counter
-  __atomic_fetch_sub(&(queue->counter), 1, __ATOMIC_SEQ_CST);
+  queue_read(queue, data, current_head, 1);
 }
 
 void blocking_queue_push(queue_t *const queue, int32_t *data) {
   uint32_t current_tail = queue->tail;
   // Wait until not full
-  while (queue->counter == XQUEUE_SIZE) {
-  }
-  // Copy data from data pointer
-  int32_t *array = queue->buffer + current_tail;
-  for (uint32_t i = 0; i < DATA_SIZE; ++i) {
-    array[i] = data[i];
+  while (current_tail - queue->head == XQUEUE_SIZE) {
   }
-  // Update tail
-  queue->tail = (current_tail + DATA_SIZE) % (XQUEUE_SIZE * DATA_SIZE);
-  // Update counter
-  __atomic_fetch_add(&(queue->counter), 1, __ATOMIC_SEQ_CST);
+  queue_write(queue, data, current_tail, 1);
 }
 
 void counting_queue_pop(queue_t *const queue, int32_t *data,
                         uint32_t *counter) {
   uint32_t current_head = queue->head;
   // Wait until not empty
-  while (queue->counter == 0) {
+  while (current_head == queue->tail) {
     (*counter)++;
+#ifdef QUEUE_WFI
+    queue_wait(queue, current_head);
+#endif
   }
-  // Copy data to data pointer
-  int32_t *array = queue->buffer + current_head;
-  for (uint32_t i = 0; i < DATA_SIZE; ++i) {
-    data[i] = array[i];
-  }
-  // Update head
-  queue->head = (current_head + DATA_SIZE) % (XQUEUE_SIZE * DATA_SIZE);
-  // Update counter
-  __atomic_fetch_sub(&(queue->counter), 1, __ATOMIC_SEQ_CST);
+  queue_read(queue, data, current_head, 1);
 }
 
 void counting_queue_push(queue_t *const queue, int32_t *data,
                          uint32_t *counter) {
   uint32_t current_tail = queue->tail;
   // Wait until not full
-  while (queue->counter == XQUEUE_SIZE) {
+  while (current_tail - queue->head == XQUEUE_SIZE) {
     (*counter)++;
   }
-  // Copy data from data pointer
-  int32_t *array = queue->buffer + current_tail;
-  for (uint32_t i = 0; i < DATA_SIZE; ++i) {
-    array[i] = data[i];
+  queue_write(queue, data, current_tail, 1);
+}
+
+void blocking_queue_pop_n(queue_t *const queue, int32_t *data, uint32_t n) {
+  uint32_t count;
+  while (n) {
+    count = queue_pop_n(queue, data, n);
+#ifdef QUEUE_WFI
+    if (count == 0) {
+      queue_wait(queue, queue->head);
+    }
+#endif
+    data += count * DATA_SIZE;
+    n -= count;
+  }
+}
+
+void blocking_queue_push_n(queue_t *const queue, int32_t *data, uint32_t n) {
+  uint32_t count;
+  while (n) {
+    count = queue_push_n(queue, data, n);
+    data += count * DATA_SIZE;
+    n -= count;
+  }
+}
+
+void counting_queue_pop_n(queue_t *const queue, int32_t *data, uint32_t n,
+                          uint32_t *counter) {
+  uint32_t count;
+  while (n) {
+    count = queue_pop_n(queue, data, n);
+    if (count == 0) {
+      (*counter)++;
+#ifdef QUEUE_WFI
+      queue_wait(queue, queue->head);
+#endif
+    }
+    data += count * DATA_SIZE;
+    n -= count;
+  }
+}
+
+void counting_queue_push_n(queue_t *const queue, int32_t *data, uint32_t n,
+                           uint32_t *counter) {
+  uint32_t count;
+  while (n) {
+    count = queue_push_n(queue, data, n);
+    if (count == 0) {
+      (*counter)++;
+    }
+    data += count * DATA_SIZE;
+    n -= count;
   }
-  // Update tail
-  queue->tail = (current_tail + DATA_SIZE) % (XQUEUE_SIZE * DATA_SIZE);
-  // Update counter
-  __atomic_fetch_add(&(queue->counter), 1, __ATOMIC_SEQ_CST);
 }
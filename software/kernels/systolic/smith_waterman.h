@@ -0,0 +1,107 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+/* This library implements the Smith-Waterman local alignment score
+ * as a wavefront on the generic systolic array of systolic.h
+ */
+
+/* H[i][j] = max(0, H[i-1][j-1] + s(a_i, b_j), H[i-1][j] - G, H[i][j-1] - G)
+ * with H[0][j] = H[i][0] = 0, and the score is the maximum of H.
+ *
+ * The grid is a single row of P PEs, PE p computes the rows i = p + 1,
+ * p + 1 + P, ... of H. The symbols of b stream to the east together with the
+ * row of H just computed, and a wrap-around queue closes the ring from the
+ * last to the first PE. The wrap-around queue holds a full row, so that it
+ * never stalls the last PE.
+ */
+
+#pragma once
+
+#include "systolic/systolic.h"
+
+#ifndef SYSTOLIC_SW_MATCH
+#define SYSTOLIC_SW_MATCH 2
+#endif
+#ifndef SYSTOLIC_SW_MISMATCH
+#define SYSTOLIC_SW_MISMATCH (-1)
+#endif
+#ifndef SYSTOLIC_SW_GAP
+#define SYSTOLIC_SW_GAP 1
+#endif
+
+typedef struct {
+  int32_t const *seq_a;
+  int32_t const *seq_b;
+  uint32_t len_a;
+  uint32_t len_b;
+  int32_t *max_score; // maximum of each PE
+  queue_t *queue_wrap;
+} systolic_sw_t;
+
+void systolic_sw_init(systolic_sw_t *sw, const uint32_t num_pe) {
+  systolic_init(1, num_pe, SYSTOLIC_LINK_HORZ);
+  // Symbol and score for each column
+  queue_create(&sw->queue_wrap, 2 * sw->len_b);
+}
+
+void systolic_sw_pe(systolic_pe_t *pe, void *args) {
+  systolic_sw_t const *sw = (systolic_sw_t const *)args;
+  uint32_t const num_pe = systolic_num_cols;
+  int32_t data[2]; // symbol of b and score of the previous row
+  int32_t symbol_a;
+  int32_t score_diag;
+  int32_t score_west;
+  int32_t score;
+  int32_t max_score = 0;
+
+  // Close the ring
+  if (pe->col_idx == 0) {
+    pe->queue_prev[SYSTOLIC_HORZ] = sw->queue_wrap;
+  }
+  if (pe->col_idx == num_pe - 1) {
+    pe->queue_next[SYSTOLIC_HORZ] = sw->queue_wrap;
+  }
+
+  for (uint32_t i = pe->col_idx + 1; i <= sw->len_a; i += num_pe) {
+    symbol_a = sw->seq_a[i - 1];
+    score_diag = 0;
+    score_west = 0;
+    for (uint32_t j = 1; j <= sw->len_b; ++j) {
+      // Get symbol and score of the row above
+      if (i == 1) {
+        data[0] = sw->seq_b[j - 1];
+        data[1] = 0;
+      } else {
+        systolic_pop(pe, SYSTOLIC_HORZ, &data[0]);
+        systolic_pop(pe, SYSTOLIC_HORZ, &data[1]);
+      }
+      // Compute score
+      score = score_diag + ((symbol_a == data[0]) ? SYSTOLIC_SW_MATCH
+                                                  : SYSTOLIC_SW_MISMATCH);
+      if (data[1] - SYSTOLIC_SW_GAP > score) {
+        score = data[1] - SYSTOLIC_SW_GAP;
+      }
+      if (score_west - SYSTOLIC_SW_GAP > score) {
+        score = score_west - SYSTOLIC_SW_GAP;
+      }
+      if (score < 0) {
+        score = 0;
+      }
+      if (score > max_score) {
+        max_score = score;
+      }
+      score_diag = data[1];
+      score_west = score;
+      // Forward to the next row
+      if (i != sw->len_a) {
+        data[1] = score;
+        systolic_push(pe, SYSTOLIC_HORZ, &data[0]);
+        systolic_push(pe, SYSTOLIC_HORZ, &data[1]);
+      }
+    }
+  }
+  sw->max_score[pe->col_idx] = max_score;
+}
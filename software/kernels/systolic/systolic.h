@@ -0,0 +1,225 @@
+// Copyright 2022 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Author: Gua Hao Khov, ETH Zurich
+
+/* This library implements a generic systolic architecture emulation
+ * on top of the single-producer single-consumer queues
+ */
+
+/* An application declares the shape of the grid and which links exist
+ * between neighbouring processing elements (PEs), and provides a compute
+ * callback for each role of PE. Each PE runs on one core, the PEs are mapped
+ * to the cores column by column, so that vertical neighbours (and horizontal
+ * neighbours of a single row grid) share a tile. The output queues of each PE
+ * are allocated in the sequential memory of its tile.
+ *
+ * Usage:
+ *   systolic_init(num_rows, num_cols, links);          // core 0
+ *   mempool_barrier(num_cores);
+ *   systolic_run(pe_fn, args);                         // all cores
+ */
+
+#pragma once
+
+#include "alloc.h"
+#include "printf.h"
+#include "systolic/queue.h"
+
+// Number of entries of each queue (power of two)
+#ifndef SYSTOLIC_QUEUE_SIZE
+#define SYSTOLIC_QUEUE_SIZE 8
+#endif
+
+// Directions of the links
+#define SYSTOLIC_HORZ 0 // west to east
+#define SYSTOLIC_VERT 1 // north to south
+#define SYSTOLIC_NUM_DIRS 2
+#define SYSTOLIC_LINK_HORZ (1 << SYSTOLIC_HORZ)
+#define SYSTOLIC_LINK_VERT (1 << SYSTOLIC_VERT)
+
+// Roles of the PEs, from their position in the grid
+#define SYSTOLIC_RCP 0 // top left corner, row and column producing
+#define SYSTOLIC_CP 1  // top row, column producing
+#define SYSTOLIC_RP 2  // leftmost column, row producing
+#define SYSTOLIC_NP 3  // remainder, non-producing
+#define SYSTOLIC_NUM_ROLES 4
+
+// Processing element
+typedef struct {
+  uint32_t row_idx;
+  uint32_t col_idx;
+  uint32_t pe_idx; // row-major position in the grid
+  queue_t *queue_prev[SYSTOLIC_NUM_DIRS];
+  queue_t *queue_next[SYSTOLIC_NUM_DIRS];
+  uint32_t pop_cnt[SYSTOLIC_NUM_DIRS];
+  uint32_t push_cnt[SYSTOLIC_NUM_DIRS];
+} systolic_pe_t;
+
+// Compute callback of a PE
+typedef void (*systolic_pe_fn_t)(systolic_pe_t *pe, void *args);
+
+// Dimensions of the systolic grid
+uint32_t systolic_num_rows;
+uint32_t systolic_num_cols;
+
+// Tile of each PE in row-major order
+uint32_t *systolic_grid_mapping;
+
+// Output queues of each PE in row-major order (NULL if no link)
+queue_t **systolic_queues[SYSTOLIC_NUM_DIRS];
+
+// Cycle counters for benchmark
+uint32_t *bm_pop_cnt[SYSTOLIC_NUM_DIRS];
+uint32_t *bm_push_cnt[SYSTOLIC_NUM_DIRS];
+
+// Define dump functions via CSR writes
+dump(horz_pop, 0x7D1);
+dump(vert_pop, 0x7D2);
+dump(horz_push, 0x7D3);
+dump(vert_push, 0x7D4);
+
+// Core running the PE at (row_idx, col_idx)
+static inline uint32_t systolic_pe_core(const uint32_t row_idx,
+                                        const uint32_t col_idx) {
+  return col_idx * systolic_num_rows + row_idx;
+}
+
+int32_t systolic_init(const uint32_t num_rows, const uint32_t num_cols,
+                      const uint32_t links) {
+  uint32_t num_pe = num_rows * num_cols;
+  if (num_pe > NUM_CORES) {
+    printf("Systolic grid %dx%d exceeds the core count!\n", num_rows,
+           num_cols);
+    return -1;
+  }
+  systolic_num_rows = num_rows;
+  systolic_num_cols = num_cols;
+
+  // Map the PEs to the tiles
+  systolic_grid_mapping = (uint32_t *)simple_malloc(num_pe * sizeof(uint32_t));
+  for (uint32_t y = 0; y < num_rows; ++y) {
+    for (uint32_t x = 0; x < num_cols; ++x) {
+      systolic_grid_mapping[y * num_cols + x] =
+          systolic_pe_core(y, x) / NUM_CORES_PER_TILE;
+    }
+  }
+
+  // Create systolic array via queues
+  alloc_t *alloc;
+  for (uint32_t d = 0; d < SYSTOLIC_NUM_DIRS; ++d) {
+    bm_pop_cnt[d] = (uint32_t *)simple_malloc(num_pe * sizeof(uint32_t));
+    bm_push_cnt[d] = (uint32_t *)simple_malloc(num_pe * sizeof(uint32_t));
+    for (uint32_t i = 0; i < num_pe; ++i) {
+      bm_pop_cnt[d][i] = 0;
+      bm_push_cnt[d][i] = 0;
+    }
+    if (!(links & (1U << d))) {
+      systolic_queues[d] = NULL;
+      continue;
+    }
+    systolic_queues[d] = (queue_t **)simple_malloc(num_pe * sizeof(queue_t *));
+    for (uint32_t y = 0; y < num_rows; ++y) {
+      for (uint32_t x = 0; x < num_cols; ++x) {
+        uint32_t grid_pos = y * num_cols + x;
+        systolic_queues[d][grid_pos] = NULL;
+        if ((d == SYSTOLIC_HORZ && x != num_cols - 1) ||
+            (d == SYSTOLIC_VERT && y != num_rows - 1)) {
+          alloc = get_alloc_tile(systolic_grid_mapping[grid_pos]);
+          queue_domain_create(alloc, &systolic_queues[d][grid_pos],
+                              SYSTOLIC_QUEUE_SIZE);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+static inline void systolic_pop(systolic_pe_t *pe, const uint32_t dir,
+                                int32_t *data) {
+  counting_queue_pop(pe->queue_prev[dir], data, &pe->pop_cnt[dir]);
+}
+
+// Pushing out of the grid is a no-op
+static inline void systolic_push(systolic_pe_t *pe, const uint32_t dir,
+                                 int32_t *data) {
+  if (pe->queue_next[dir]) {
+    counting_queue_push(pe->queue_next[dir], data, &pe->push_cnt[dir]);
+  }
+}
+
+// Run the calling core's PE, cores outside of the grid return immediately
+void systolic_run(systolic_pe_fn_t const *pe_fn, void *args) {
+  uint32_t core_id = mempool_get_core_id();
+  systolic_pe_t pe;
+  uint32_t role;
+
+  if (core_id >= systolic_num_rows * systolic_num_cols) {
+    return;
+  }
+
+  // Assign grid position (col wise)
+  pe.row_idx = core_id % systolic_num_rows;
+  pe.col_idx = core_id / systolic_num_rows;
+  pe.pe_idx = pe.row_idx * systolic_num_cols + pe.col_idx;
+
+  // Assign queues
+  for (uint32_t d = 0; d < SYSTOLIC_NUM_DIRS; ++d) {
+    pe.queue_prev[d] = NULL;
+    pe.queue_next[d] = NULL;
+    pe.pop_cnt[d] = 0;
+    pe.push_cnt[d] = 0;
+    if (systolic_queues[d]) {
+      pe.queue_next[d] = systolic_queues[d][pe.pe_idx];
+    }
+  }
+  if (systolic_queues[SYSTOLIC_HORZ] && pe.col_idx != 0) {
+    pe.queue_prev[SYSTOLIC_HORZ] =
+        systolic_queues[SYSTOLIC_HORZ][pe.pe_idx - 1];
+  }
+  if (systolic_queues[SYSTOLIC_VERT] && pe.row_idx != 0) {
+    pe.queue_prev[SYSTOLIC_VERT] =
+        systolic_queues[SYSTOLIC_VERT][pe.pe_idx - systolic_num_cols];
+  }
+
+  // Execute the callback of the role
+  role = (pe.row_idx != 0 ? SYSTOLIC_RP : SYSTOLIC_RCP) |
+         (pe.col_idx != 0 ? SYSTOLIC_CP : SYSTOLIC_RCP);
+  if (pe_fn[role]) {
+    pe_fn[role](&pe, args);
+  }
+
+  // Store benchmark results
+  for (uint32_t d = 0; d < SYSTOLIC_NUM_DIRS; ++d) {
+    bm_pop_cnt[d][pe.pe_idx] = pe.pop_cnt[d];
+    bm_push_cnt[d][pe.pe_idx] = pe.push_cnt[d];
+  }
+
+  // Dump benchmark results
+  dump_horz_pop(pe.pop_cnt[SYSTOLIC_HORZ]);
+  dump_vert_pop(pe.pop_cnt[SYSTOLIC_VERT]);
+  dump_horz_push(pe.push_cnt[SYSTOLIC_HORZ]);
+  dump_vert_push(pe.push_cnt[SYSTOLIC_VERT]);
+}
+
+void systolic_benchmark_print() {
+  const char *names[SYSTOLIC_NUM_DIRS] = {"horz", "vert"};
+  printf("Benchmark: Cycles blocked by queue\n");
+  for (uint32_t d = 0; d < SYSTOLIC_NUM_DIRS; ++d) {
+    printf("%s pop:\n", names[d]);
+    for (uint32_t y = 0; y < systolic_num_rows; ++y) {
+      for (uint32_t x = 0; x < systolic_num_cols; ++x) {
+        printf("%5d ", bm_pop_cnt[d][y * systolic_num_cols + x]);
+      }
+      printf("\n");
+    }
+    printf("%s push:\n", names[d]);
+    for (uint32_t y = 0; y < systolic_num_rows; ++y) {
+      for (uint32_t x = 0; x < systolic_num_cols; ++x) {
+        printf("%5d ", bm_push_cnt[d][y * systolic_num_cols + x]);
+      }
+      printf("\n");
+    }
+  }
+}
@@ -4,6 +4,7 @@
 
 // Author: Samuel Riedel, ETH Zurich
 
+#include "alloc.h"
 #include "halide_runtime.h"
 #include "printf.h"
 #include "runtime.h"
@@ -16,9 +17,93 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
-void *halide_malloc(void *user_context, size_t x) { return (void *)0x0000b000; }
+#define NUM_TILES (NUM_CORES / NUM_CORES_PER_TILE)
+// Size of the sequential heap of a tile, see mempool_init
+static uint32_t const halide_tile_heap_size =
+    NUM_CORES_PER_TILE * (SEQ_MEM_SIZE - STACK_SIZE) -
+    NUM_BANKS_PER_TILE * XQUEUE_SIZE * sizeof(uint32_t);
+
+// Parallel job dispatched by halide_do_par_for
+typedef struct {
+  halide_task_t task;
+  void *user_context;
+  int min;
+  int size;
+  uint8_t *closure;
+  int result;
+} halide_job_t;
+
+halide_job_t volatile halide_job __attribute__((section(".l1")));
+// Set while the cores execute a parallel job
+uint32_t volatile halide_parallel __attribute__((section(".l1")));
+// Set to return from halide_mempool_worker
+uint32_t volatile halide_release __attribute__((section(".l1")));
+// Locks of the tile allocators and of the L1 allocator (last)
+uint32_t volatile halide_alloc_lock[NUM_TILES + 1]
+    __attribute__((section(".l1")));
+
+static inline void halide_lock(uint32_t volatile *lock) {
+  while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+  }
+}
+
+static inline void halide_unlock(uint32_t volatile *lock) {
+  __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+void halide_mempool_init(uint32_t core_id) {
+  mempool_init(core_id);
+  if (core_id == 0) {
+    halide_parallel = 0;
+    halide_release = 0;
+    for (uint32_t i = 0; i < NUM_TILES + 1; ++i) {
+      halide_alloc_lock[i] = 0;
+    }
+  }
+}
+
+//////////////
+//  Memory  //
+//////////////
+
+// Inside of a parallel job, the intermediates (e.g., compute_at in a parallel
+// loop with store_in(MemoryType::Heap)) are allocated in the sequential
+// memory of the tile of the calling core, if there is any. The rest goes to
+// the interleaved L1 heap.
+void *halide_malloc(void *user_context, size_t x) {
+  void *ptr = NULL;
+  if (halide_parallel && x < halide_tile_heap_size) {
+    uint32_t tile_id = mempool_get_tile_id();
+    halide_lock(&halide_alloc_lock[tile_id]);
+    ptr = domain_malloc(get_alloc_tile(tile_id), (uint32_t)x);
+    halide_unlock(&halide_alloc_lock[tile_id]);
+  }
+  if (ptr == NULL) {
+    halide_lock(&halide_alloc_lock[NUM_TILES]);
+    ptr = domain_malloc(get_alloc_l1(), (uint32_t)x);
+    halide_unlock(&halide_alloc_lock[NUM_TILES]);
+  }
+  return ptr;
+}
 
-void halide_free(void *user_context, void *ptr) {}
+void halide_free(void *user_context, void *ptr) {
+  extern uint32_t __seq_start;
+  uint32_t offset = (uint32_t)ptr - (uint32_t)&__seq_start;
+  if (ptr == NULL) {
+    return;
+  }
+  if (offset < NUM_CORES * SEQ_MEM_SIZE) {
+    // Sequential memory of a tile
+    uint32_t tile_id = offset / (NUM_CORES_PER_TILE * SEQ_MEM_SIZE);
+    halide_lock(&halide_alloc_lock[tile_id]);
+    domain_free(get_alloc_tile(tile_id), ptr);
+    halide_unlock(&halide_alloc_lock[tile_id]);
+  } else {
+    halide_lock(&halide_alloc_lock[NUM_TILES]);
+    domain_free(get_alloc_l1(), ptr);
+    halide_unlock(&halide_alloc_lock[NUM_TILES]);
+  }
+}
 
 char *getenv(const char *name) { return NULL; };
 
@@ -67,15 +152,74 @@ void halide_print(void *user_context, const char *msg) { printf("%s\n", msg); }
 // Parallel //
 //////////////
 
+// Execute the tasks of the current job assigned to the core
+// The job starts and ends with a tree barrier over all cores, the workers wait
+// for the next job in the start barrier
+static void halide_run_job(uint32_t core_id) {
+  int const end = halide_job.min + halide_job.size;
+  for (int i = halide_job.min + (int)core_id; i < end; i += NUM_CORES) {
+    int result = halide_job.task(halide_job.user_context, i,
+                                 (uint8_t *)halide_job.closure);
+    if (result) {
+      halide_job.result = result;
+    }
+  }
+  mempool_log_barrier(2, core_id);
+}
+
 // Halide calls this function
+// Core 0 dispatches the loop to the cores sleeping in halide_mempool_worker.
+// Nested parallel loops, and loops called from other cores, are executed
+// serially by the calling core.
 int halide_do_par_for(void *user_context, halide_task_t task, int min, int size,
                       uint8_t *closure) {
-  for (uint32_t core_id = mempool_get_core_id(); core_id < (uint32_t)size;
-       core_id += mempool_get_core_count()) {
-    task(user_context, (int32_t)core_id, closure);
+  uint32_t core_id = mempool_get_core_id();
+  int result = 0;
+
+  if (core_id != 0 || halide_parallel) {
+    for (int i = min; i < min + size; ++i) {
+      int task_result = task(user_context, i, closure);
+      if (task_result) {
+        result = task_result;
+      }
+    }
+    return result;
   }
 
-  return 0;
+  // Publish the job and start the workers
+  halide_job.task = task;
+  halide_job.user_context = user_context;
+  halide_job.min = min;
+  halide_job.size = size;
+  halide_job.closure = closure;
+  halide_job.result = 0;
+  halide_parallel = 1;
+  mempool_log_barrier(2, core_id);
+
+  halide_run_job(core_id);
+  halide_parallel = 0;
+  return halide_job.result;
+}
+
+void halide_mempool_worker(uint32_t core_id) {
+  while (1) {
+    // Wait for the next job
+    mempool_log_barrier(2, core_id);
+    if (halide_release) {
+      break;
+    }
+    halide_run_job(core_id);
+  }
+  mempool_log_barrier(2, core_id);
+}
+
+void halide_mempool_release(void) {
+  uint32_t core_id = mempool_get_core_id();
+  halide_release = 1;
+  mempool_log_barrier(2, core_id);
+  // Wait for all workers to read the flag
+  mempool_log_barrier(2, core_id);
+  halide_release = 0;
 }
 
 #pragma GCC diagnostic pop
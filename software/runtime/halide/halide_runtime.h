@@ -23,4 +23,12 @@ void halide_print(void *user_context, const char *msg);
 int halide_do_par_for(void *user_context, halide_task_t task, int min, int size,
                       uint8_t *closure);
 
+// Initialize the allocators and the parallel runtime, called by all cores
+void halide_mempool_init(uint32_t core_id);
+
+// Execute the parallel loops of the pipelines called by core 0, until core 0
+// calls halide_mempool_release
+void halide_mempool_worker(uint32_t core_id);
+void halide_mempool_release(void);
+
 #endif // __HALIDE_RUNTIME_H__
@@ -423,10 +423,34 @@ typedef struct {
   std::vector<const arg_t*>& arg;
 } custom_fmt_t;
 
+const std::string& disassembler_t::cached(insn_t insn) const
+{
+  if (cache.empty())
+    cache.resize(CACHE_SIZE);
+  insn_bits_t bits = insn.bits();
+  cache_entry_t& entry = cache[(bits ^ bits >> 12 ^ bits >> 25) % CACHE_SIZE];
+  if (!entry.valid || entry.bits != bits) {
+    // Reuse the buffer of the entry
+    entry.text.clear();
+    const disasm_insn_t* disasm_insn = lookup(insn);
+    if (disasm_insn)
+      disasm_insn->append_to(entry.text, insn);
+    else
+      entry.text = "unknown";
+    entry.bits = bits;
+    entry.valid = true;
+  }
+  return entry.text;
+}
+
 std::string disassembler_t::disassemble(insn_t insn) const
 {
-  const disasm_insn_t* disasm_insn = lookup(insn);
-  return disasm_insn ? disasm_insn->to_string(insn) : "unknown";
+  return cached(insn);
+}
+
+void disassembler_t::disassemble(insn_t insn, std::string& s) const
+{
+  s += cached(insn);
 }
 
 disassembler_t::disassembler_t(int xlen)
@@ -1545,6 +1569,7 @@ void NOINLINE disassembler_t::add_insn(disasm_insn_t* insn)
   if (insn->get_mask() % HASH_SIZE == HASH_SIZE - 1)
     idx = insn->get_match() % HASH_SIZE;
   chain[idx].push_back(insn);
+  cache.clear();
 }
 
 disassembler_t::~disassembler_t()
@@ -163,6 +163,18 @@ const char* htif_t::get_symbol(uint64_t addr)
   return it->second.c_str();
 }
 
+const char* htif_t::get_nearest_symbol(uint64_t addr)
+{
+  auto it = addr2symbol.upper_bound(addr);
+  while (it != addr2symbol.begin()) {
+    --it;
+    if (!it->second.empty())
+      return it->second.c_str();
+  }
+
+  return nullptr;
+}
+
 void htif_t::stop()
 {
   if (!sig_file.empty() && sig_len) // print final torture test signature
@@ -240,6 +252,11 @@ bool htif_t::done()
   return stopped;
 }
 
+bool htif_t::signalled()
+{
+  return signal_exit;
+}
+
 int htif_t::exit_code()
 {
   return exitcode >> 1;
@@ -24,6 +24,10 @@ class htif_t : public chunked_memif_t
   int run();
   bool done();
   int exit_code();
+  // The target wrote its exit code to tohost
+  bool exited() { return exitcode != 0; }
+  // A signal, e.g. SIGINT or SIGTERM, asked the simulation to stop
+  static bool signalled();
 
   virtual memif_t& memif() { return mem; }
 
@@ -51,6 +55,12 @@ class htif_t : public chunked_memif_t
 
   // Given an address, return symbol from addr2symbol map
   const char* get_symbol(uint64_t addr);
+  // Given an address, return the closest symbol at or before it, e.g. the
+  // function of a PC
+  const char* get_nearest_symbol(uint64_t addr);
+
+  // Replace the target program and its arguments before start()
+  void set_target_args(const std::vector<std::string>& args) { targs = args; }
 
  private:
   void parse_arguments(int argc, char ** argv);
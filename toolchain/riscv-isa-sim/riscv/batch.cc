@@ -0,0 +1,176 @@
+// See LICENSE for license details.
+
+#include "sim.h"
+#include <cerrno>
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// The simulation is built once, with its memories, device tree and timing
+// models, but not started. Each program runs in a child forked from it, which
+// shares the pages of the simulation copy-on-write and only loads the ELF.
+
+// Result of a program, written by its child to memory shared with the parent
+struct batch_result_t
+{
+  bool done;
+  int exit_code;
+  uint64_t instret;
+  double wall_time;
+};
+
+static double wall_clock()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static std::string csv_field(const std::vector<std::string>& args)
+{
+  std::string field;
+  for (auto& arg : args)
+    field += (field.empty() ? "" : " ") + arg;
+  if (field.find_first_of(",\"") == std::string::npos)
+    return field;
+
+  std::string quoted = "\"";
+  for (char c : field)
+    quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+  return quoted + "\"";
+}
+
+int sim_t::run_batch(const char* list, const char* csv, size_t jobs)
+{
+  std::ifstream in(list);
+  if (!in.good()) {
+    fprintf(stderr, "can't open batch list %s\n", list);
+    exit(1);
+  }
+  std::vector<std::vector<std::string>> programs;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream words(line.substr(0, line.find('#')));
+    std::vector<std::string> args;
+    std::string word;
+    while (words >> word)
+      args.push_back(word);
+    if (!args.empty())
+      programs.push_back(args);
+  }
+
+  FILE* out = strcmp(csv, "-") == 0 ? stdout : fopen(csv, "w");
+  if (!out) {
+    fprintf(stderr, "can't open %s: %s\n", csv, strerror(errno));
+    exit(1);
+  }
+
+  size_t size = std::max<size_t>(programs.size(), 1) * sizeof(batch_result_t);
+  auto results = (batch_result_t*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (results == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+
+  // Ctrl-C or a signal such as SIGTERM stops the batch. The children forked
+  // afterwards would inherit the stop request and run nothing.
+  auto stopped = [] { return ctrlc_pressed || signalled(); };
+  bool forwarded = false;
+  // Let SIGTERM interrupt wait() to forward it to the children
+  struct sigaction term;
+  sigaction(SIGTERM, NULL, &term);
+  term.sa_flags &= ~SA_RESTART;
+  sigaction(SIGTERM, &term, NULL);
+
+  std::vector<double> start(programs.size());
+  std::map<pid_t, size_t> running;
+  size_t next = 0;
+  while (running.size() || (next < programs.size() && !stopped())) {
+    if (signalled() && !forwarded) {
+      // A SIGTERM sent to the parent only, e.g. by a CI timeout
+      for (auto& child : running)
+        kill(child.first, SIGTERM);
+      forwarded = true;
+    }
+
+    if (next < programs.size() && running.size() < jobs && !stopped()) {
+      fflush(NULL); // the children would write the buffered output again
+      start[next] = wall_clock();
+      pid_t pid = fork();
+      if (pid < 0) {
+        perror("fork");
+        exit(1);
+      }
+
+      if (pid == 0) {
+        // Ctrl-C stops the batch instead of debugging every child
+        signal(SIGINT, SIG_DFL);
+        batch_result_t* result = &results[next];
+        set_target_args(programs[next]);
+        int exit_code = run();
+        // A program stopped by a signal before its exit did not pass
+        if (!exited())
+          exit_code = 1;
+        result->wall_time = wall_clock() - start[next];
+        result->exit_code = exit_code;
+        for (auto p : procs)
+          result->instret += p->get_state()->minstret;
+        result->done = true;
+        // The child goes on as a plain run, e.g. to print its statistics
+        return exit_code;
+      }
+
+      running[pid] = next++;
+      continue;
+    }
+
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("wait");
+      exit(1);
+    }
+    auto it = running.find(pid);
+    if (it == running.end())
+      continue;
+
+    // A child that died before the end of its program reports its status
+    batch_result_t* result = &results[it->second];
+    if (!result->done) {
+      result->exit_code = WIFEXITED(status) ? WEXITSTATUS(status)
+                                            : 128 + WTERMSIG(status);
+      result->wall_time = wall_clock() - start[it->second];
+    }
+    running.erase(it);
+  }
+
+  size_t failed = 0;
+  fprintf(out, "program,exit_code,instret,wall_time\n");
+  for (size_t i = 0; i < next; i++) {
+    fprintf(out, "%s,%d,%" PRIu64 ",%.6f\n", csv_field(programs[i]).c_str(),
+            results[i].exit_code, results[i].instret, results[i].wall_time);
+    failed += results[i].exit_code != 0;
+  }
+  for (size_t i = next; i < programs.size(); i++)
+    fprintf(out, "%s,not run,,\n", csv_field(programs[i]).c_str());
+  if (out != stdout)
+    fclose(out);
+  munmap(results, size);
+
+  fprintf(stderr, "batch: %zu of %zu programs failed", failed, next);
+  if (next < programs.size())
+    fprintf(stderr, ", %zu not run", programs.size() - next);
+  fprintf(stderr, "\n");
+  return failed || next < programs.size();
+}
@@ -2,12 +2,15 @@
 
 #include "cachesim.h"
 #include "common.h"
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 cache_sim_t::cache_sim_t(size_t _sets, size_t _ways, size_t _linesz, const char* _name)
-: sets(_sets), ways(_ways), linesz(_linesz), name(_name), log(false)
+: sets(_sets), ways(_ways), linesz(_linesz), name(_name), log(false),
+  quiet(false)
 {
   init();
 }
@@ -62,7 +65,7 @@ void cache_sim_t::init()
 
 cache_sim_t::cache_sim_t(const cache_sim_t& rhs)
  : sets(rhs.sets), ways(rhs.ways), linesz(rhs.linesz),
-   idx_shift(rhs.idx_shift), name(rhs.name), log(false)
+   idx_shift(rhs.idx_shift), name(rhs.name), log(false), quiet(rhs.quiet)
 {
   tags = new uint64_t[sets*ways];
   memcpy(tags, rhs.tags, sets*ways*sizeof(uint64_t));
@@ -70,7 +73,8 @@ cache_sim_t::cache_sim_t(const cache_sim_t& rhs)
 
 cache_sim_t::~cache_sim_t()
 {
-  print_stats();
+  if (!quiet)
+    print_stats();
   delete [] tags;
 }
 
@@ -121,7 +125,7 @@ uint64_t cache_sim_t::victimize(uint64_t addr)
   return victim;
 }
 
-void cache_sim_t::access(uint64_t addr, size_t bytes, bool store)
+bool cache_sim_t::access(uint64_t addr, size_t bytes, bool store)
 {
   store ? write_accesses++ : read_accesses++;
   (store ? bytes_written : bytes_read) += bytes;
@@ -131,7 +135,7 @@ void cache_sim_t::access(uint64_t addr, size_t bytes, bool store)
   {
     if (store)
       *hit_way |= DIRTY;
-    return;
+    return true;
   }
 
   store ? write_misses++ : read_misses++;
@@ -157,29 +161,278 @@ void cache_sim_t::access(uint64_t addr, size_t bytes, bool store)
 
   if (store)
     *check_tag(addr) |= DIRTY;
+  return false;
 }
 
+const uint32_t fa_cache_sim_t::EMPTY;
+
 fa_cache_sim_t::fa_cache_sim_t(size_t ways, size_t linesz, const char* name)
-  : cache_sim_t(1, ways, linesz, name)
+  : cache_sim_t(1, ways, linesz, name), index_bits(1), used(0)
 {
+  // At most half full, to keep the probes short
+  while ((size_t(1) << index_bits) < 2 * ways)
+    index_bits++;
+  index.assign(size_t(1) << index_bits, EMPTY);
 }
 
 uint64_t* fa_cache_sim_t::check_tag(uint64_t addr)
 {
-  auto it = tags.find(addr >> idx_shift);
-  return it == tags.end() ? NULL : &it->second;
+  uint64_t tag = addr >> idx_shift;
+  size_t mask = index.size() - 1;
+  for (size_t i = slot(tag); index[i] != EMPTY; i = (i + 1) & mask)
+    if ((tags[index[i]] & ~(VALID | DIRTY)) == tag)
+      return &tags[index[i]];
+  return NULL;
+}
+
+void fa_cache_sim_t::unindex(size_t way)
+{
+  size_t mask = index.size() - 1;
+  size_t i = slot(tags[way] & ~(VALID | DIRTY));
+  while (index[i] != way)
+    i = (i + 1) & mask;
+
+  // Move the ways probed after it back, unless that would take them before
+  // their slot, so that no lookup stops early at the hole
+  for (size_t j = (i + 1) & mask; index[j] != EMPTY; j = (j + 1) & mask) {
+    size_t home = slot(tags[index[j]] & ~(VALID | DIRTY));
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      index[i] = index[j];
+      i = j;
+    }
+  }
+  index[i] = EMPTY;
 }
 
 uint64_t fa_cache_sim_t::victimize(uint64_t addr)
 {
-  uint64_t old_tag = 0;
-  if (tags.size() == ways)
-  {
-    auto it = tags.begin();
-    std::advance(it, lfsr.next() % ways);
-    old_tag = it->second;
-    tags.erase(it);
+  size_t way = used < ways ? used++ : lfsr.next() % ways;
+  uint64_t victim = tags[way];
+  if (victim & VALID)
+    unindex(way);
+
+  uint64_t tag = addr >> idx_shift;
+  tags[way] = tag | VALID;
+  size_t mask = index.size() - 1;
+  size_t i = slot(tag);
+  while (index[i] != EMPTY)
+    i = (i + 1) & mask;
+  index[i] = way;
+  return victim;
+}
+
+static void mempool_help()
+{
+  std::cerr << "MemPool cache configurations must be of the form" << std::endl;
+  std::cerr << "  key=value,key=value,..." << std::endl;
+  std::cerr << "or \"default\", with the keys" << std::endl;
+  std::cerr << "  num_cores, num_groups, cores_per_tile (hierarchy)," << std::endl;
+  std::cerr << "  icache_size, icache_ways, icache_line_width (cache of a tile)," << std::endl;
+  std::cerr << "  ro_size, ro_ways, ro_line_width, ro_start<i>, ro_end<i> for i" << std::endl;
+  std::cerr << "  in 0-3 (read-only cache of a group and the regions it caches)," << std::endl;
+  std::cerr << "  l2_base, l2_size." << std::endl;
+  std::cerr << "Sizes are in bytes and line widths in bits; the sets of both caches" << std::endl;
+  std::cerr << "and their lines must be powers of two, lines at least 64 bits." << std::endl;
+  exit(1);
+}
+
+mempool_cache_config_t::mempool_cache_config_t(const char* config)
+{
+  const std::pair<const char*, uint64_t*> keys[] = {
+    {"num_cores", &num_cores},
+    {"num_groups", &num_groups},
+    {"cores_per_tile", &cores_per_tile},
+    {"icache_size", &icache_size},
+    {"icache_ways", &icache_ways},
+    {"icache_line_width", &icache_line_width},
+    {"ro_size", &ro_size},
+    {"ro_ways", &ro_ways},
+    {"ro_line_width", &ro_line_width},
+    {"ro_start0", &ro_start[0]},
+    {"ro_end0", &ro_end[0]},
+    {"ro_start1", &ro_start[1]},
+    {"ro_end1", &ro_end[1]},
+    {"ro_start2", &ro_start[2]},
+    {"ro_end2", &ro_end[2]},
+    {"ro_start3", &ro_start[3]},
+    {"ro_end3", &ro_end[3]},
+    {"l2_base", &l2_base},
+    {"l2_size", &l2_size},
+  };
+
+  std::stringstream stream(config && strcmp(config, "default") ? config : "");
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    size_t eq = item.find('=');
+    if (eq == std::string::npos)
+      mempool_help();
+    std::string key = item.substr(0, eq);
+    std::string val = item.substr(eq + 1);
+    char* end;
+    uint64_t value = strtoull(val.c_str(), &end, 0);
+    if (val.empty() || *end)
+      mempool_help();
+    auto it = std::find_if(std::begin(keys), std::end(keys),
+      [&](const std::pair<const char*, uint64_t*>& k){ return key == k.first; });
+    if (it == std::end(keys))
+      mempool_help();
+    *it->second = value;
+  }
+
+  if (num_cores == 0 || cores_per_tile == 0 || num_groups == 0 ||
+      num_cores % (cores_per_tile * num_groups) ||
+      icache_ways == 0 || icache_line_width % 8 || ro_ways == 0 ||
+      ro_line_width % 8 ||
+      icache_size % (icache_ways * icache_line_width / 8) ||
+      ro_size % (ro_ways * ro_line_width / 8))
+    mempool_help();
+}
+
+// A set-associative cache of size bytes, or a fully-associative one if it
+// has a single set of many ways, as cache_sim_t::construct() builds them
+static cache_sim_t* mempool_cache(uint64_t size, uint64_t ways,
+                                  uint64_t line_width, const std::string& name)
+{
+  size_t linesz = line_width / 8;
+  size_t sets = size / (ways * linesz);
+  if (sets == 0 || (sets & (sets-1)) || linesz < 8 || (linesz & (linesz-1)))
+    mempool_help();
+
+  cache_sim_t* cache = ways > 4 && sets == 1
+    ? new fa_cache_sim_t(ways, linesz, name.c_str())
+    : new cache_sim_t(sets, ways, linesz, name.c_str());
+  cache->set_quiet(true);
+  return cache;
+}
+
+mempool_cache_sim_t::mempool_cache_sim_t(const mempool_cache_config_t& config)
+  : config(config), stats(config.num_tiles())
+{
+  for (size_t t = 0; t < config.num_tiles(); t++)
+    icaches.emplace_back(mempool_cache(config.icache_size, config.icache_ways,
+      config.icache_line_width, "tile" + std::to_string(t) + " I$"));
+  for (size_t g = 0; g < config.num_groups; g++)
+    ro_caches.emplace_back(mempool_cache(config.ro_size, config.ro_ways,
+      config.ro_line_width, "group" + std::to_string(g) + " RO$"));
+}
+
+mempool_cache_sim_t::~mempool_cache_sim_t()
+{
+  print_stats();
+}
+
+memtracer_t* mempool_cache_sim_t::tracer(uint64_t hartid)
+{
+  size_t tile = hartid / config.cores_per_tile % config.num_tiles();
+  tracers.emplace_back(new hart_tracer_t(this, tile));
+  return &*tracers.back();
+}
+
+// Read from L2 through the read-only cache of the group of the tile
+void mempool_cache_sim_t::read_l2(size_t tile, uint64_t addr, size_t bytes)
+{
+  tile_stats_t& s = stats[tile];
+  if (!in_ro(addr)) {
+    if (in_l2(addr, addr + bytes))
+      s.l2_bytes_read += bytes;
+    return;
+  }
+
+  // An access may span several lines of the read-only cache, e.g. the
+  // refill of a wider line of the instruction cache
+  cache_sim_t* ro = &*ro_caches[tile / config.tiles_per_group()];
+  size_t linesz = ro->get_linesz();
+  for (uint64_t line = addr & ~(linesz - 1); line < addr + bytes;
+       line += linesz) {
+    s.ro_reads++;
+    if (!ro->access(line, linesz, false)) {
+      s.ro_misses++;
+      if (in_l2(line, line + linesz))
+        s.l2_bytes_read += linesz;
+    }
+  }
+}
+
+void mempool_cache_sim_t::access(size_t tile, uint64_t addr, size_t bytes,
+                                 access_type type)
+{
+  tile_stats_t& s = stats[tile];
+  if (type == FETCH) {
+    s.fetches++;
+    cache_sim_t* ic = &*icaches[tile];
+    if (!ic->access(addr, bytes, false)) {
+      s.icache_misses++;
+      size_t linesz = ic->get_linesz();
+      read_l2(tile, addr & ~(linesz - 1), linesz);
+    }
+  } else if (type == LOAD) {
+    read_l2(tile, addr, bytes);
+  } else if (in_l2(addr, addr + bytes)) {
+    // Stores go around the read-only cache
+    s.l2_bytes_written += bytes;
+  }
+}
+
+void mempool_cache_sim_t::print_stats()
+{
+  tile_stats_t total = {};
+  for (auto& s : stats) {
+    total.fetches += s.fetches;
+    total.icache_misses += s.icache_misses;
+    total.ro_reads += s.ro_reads;
+    total.ro_misses += s.ro_misses;
+    total.l2_bytes_read += s.l2_bytes_read;
+    total.l2_bytes_written += s.l2_bytes_written;
+  }
+  if (total.fetches == 0)
+    return;
+
+  auto rate = [](uint64_t hits, uint64_t all) {
+    std::ostringstream s;
+    s << std::setprecision(3) << std::fixed;
+    if (all)
+      s << 100.0 * hits / all << '%';
+    else
+      s << '-';
+    return s.str();
+  };
+  // The bytes moved to and from L2 per instruction are the bandwidth to L2
+  // in bytes per cycle of each core that retires one instruction per cycle
+  auto print = [&](const std::string& name, const tile_stats_t& s) {
+    std::cout << std::setw(7) << name
+              << std::setw(13) << s.fetches
+              << std::setw(10) << rate(s.fetches - s.icache_misses, s.fetches)
+              << std::setw(12) << s.ro_reads
+              << std::setw(10) << rate(s.ro_reads - s.ro_misses, s.ro_reads)
+              << std::setw(13) << s.l2_bytes_read
+              << std::setw(13) << s.l2_bytes_written
+              << std::setw(11)
+              << double(s.l2_bytes_read + s.l2_bytes_written) / s.fetches
+              << std::endl;
+  };
+
+  std::cout << std::setprecision(3) << std::fixed;
+  std::cout << "MemPool I$:  " << config.icache_size << " B, "
+            << config.icache_ways << " ways, " << config.icache_line_width / 8
+            << " B lines, per tile of " << config.cores_per_tile << " cores"
+            << std::endl;
+  std::cout << "MemPool RO$: " << config.ro_size << " B, "
+            << config.ro_ways << " ways, " << config.ro_line_width / 8
+            << " B lines, per group of " << config.tiles_per_group()
+            << " tiles, for";
+  bool enabled = false;
+  for (size_t i = 0; i < config.ro_num_regions; i++) {
+    if (config.ro_start[i] < config.ro_end[i]) {
+      std::cout << " [0x" << std::hex << config.ro_start[i] << ", 0x"
+                << config.ro_end[i] << ")" << std::dec;
+      enabled = true;
+    }
   }
-  tags[addr >> idx_shift] = (addr >> idx_shift) | VALID;
-  return old_tag;
+  std::cout << (enabled ? "" : " nothing") << std::endl;
+  std::cout << "   Tile      Fetches  I$ Hits   RO$ Reads RO$ Hits"
+            << "  L2 Bytes Rd  L2 Bytes Wr  L2 B/Insn" << std::endl;
+  for (size_t t = 0; t < stats.size(); t++)
+    if (stats[t].fetches)
+      print(std::to_string(t), stats[t]);
+  print("Total", total);
 }
@@ -6,7 +6,8 @@
 #include "memtracer.h"
 #include <cstring>
 #include <string>
-#include <map>
+#include <memory>
+#include <vector>
 #include <cstdint>
 
 class lfsr_t
@@ -26,10 +27,14 @@ class cache_sim_t
   cache_sim_t(const cache_sim_t& rhs);
   virtual ~cache_sim_t();
 
-  void access(uint64_t addr, size_t bytes, bool store);
+  // Return whether the access hit
+  bool access(uint64_t addr, size_t bytes, bool store);
   void print_stats();
   void set_miss_handler(cache_sim_t* mh) { miss_handler = mh; }
   void set_log(bool _log) { log = _log; }
+  // Leave the statistics to the owner instead of printing them at the end
+  void set_quiet(bool _quiet) { quiet = _quiet; }
+  size_t get_linesz() const { return linesz; }
 
   static cache_sim_t* construct(const char* config, const char* name);
 
@@ -60,6 +65,7 @@ class cache_sim_t
 
   std::string name;
   bool log;
+  bool quiet;
 
   void init();
 };
@@ -71,8 +77,19 @@ class fa_cache_sim_t : public cache_sim_t
   uint64_t* check_tag(uint64_t addr);
   uint64_t victimize(uint64_t addr);
  private:
-  static bool cmp(uint64_t a, uint64_t b);
-  std::map<uint64_t, uint64_t> tags;
+  // The ways are the tags of cache_sim_t, found through a hash table with
+  // linear probing from each tag to its way
+  static const uint32_t EMPTY = UINT32_MAX;
+
+  size_t slot(uint64_t tag) const
+  {
+    return (tag * 0x9e3779b97f4a7c15ULL) >> (64 - index_bits);
+  }
+  void unindex(size_t way);
+
+  std::vector<uint32_t> index;
+  size_t index_bits;
+  size_t used;
 };
 
 class cache_memtracer_t : public memtracer_t
@@ -127,4 +144,107 @@ class dcache_sim_t : public cache_memtracer_t
   }
 };
 
+// Parameters of the instruction caches of MemPool, one shared by the cores of
+// each tile, and of its read-only caches in front of L2. The hardware has a
+// read-only cache at every level of the AXI tree of a group
+// (axi_hier_interco); the model has a single one per group, shared by all its
+// tiles. The defaults match mempool_pkg.sv, config/mempool.mk and the reset
+// values of ctrl_registers.sv; each one can be overridden with a
+// "key=value,..." string, e.g. --mempool-cache=ro_line_width=256.
+struct mempool_cache_config_t
+{
+  mempool_cache_config_t(const char* config);
+
+  uint64_t num_cores = 256;
+  uint64_t num_groups = 4;
+  uint64_t cores_per_tile = 4;
+
+  // Instruction cache of a tile, ICacheSizeByte, ICacheSets (its ways) and
+  // ICacheLineWidth in bits, for 4 cores per tile
+  uint64_t icache_size = 2048;
+  uint64_t icache_ways = 2;
+  uint64_t icache_line_width = 256;
+
+  // Read-only cache of a group, ROCacheSizeByte, ROCacheSets (its ways) and
+  // ro_line_width in bits
+  uint64_t ro_size = 8192;
+  uint64_t ro_ways = 2;
+  uint64_t ro_line_width = 512;
+  // Regions it caches, set with the RO_CACHE_START_<i> and RO_CACHE_END_<i>
+  // control registers on the hardware; empty regions cache nothing. At reset,
+  // the first 4 KiB of L2, the boot ROM, and the words at 0x8 and 0xC.
+  static const size_t ro_num_regions = 4;
+  uint64_t ro_start[ro_num_regions] = {0x80000000, 0xA0000000, 0x8, 0xC};
+  uint64_t ro_end[ro_num_regions] = {0x80001000, 0xA0001000, 0xC, 0x10};
+
+  uint64_t l2_base = 0x80000000;
+  uint64_t l2_size = 0x400000;
+
+  uint64_t num_tiles() const { return num_cores / cores_per_tile; }
+  uint64_t tiles_per_group() const { return num_tiles() / num_groups; }
+};
+
+// The instruction caches and read-only caches of MemPool. Each hart traces
+// its fetches and its accesses to L2 with its tracer(); the refills of the
+// instruction caches go through the read-only caches as well. The hit rates
+// and the traffic to L2 are reported per tile at the end.
+class mempool_cache_sim_t
+{
+ public:
+  mempool_cache_sim_t(const mempool_cache_config_t& config);
+  ~mempool_cache_sim_t();
+
+  memtracer_t* tracer(uint64_t hartid);
+  void print_stats();
+
+ private:
+  class hart_tracer_t : public memtracer_t
+  {
+   public:
+    hart_tracer_t(mempool_cache_sim_t* sim, size_t tile)
+      : sim(sim), tile(tile) {}
+    bool interested_in_range(uint64_t begin, uint64_t end, access_type type)
+    {
+      return type == FETCH || sim->in_l2(begin, end);
+    }
+    void trace(uint64_t addr, size_t bytes, access_type type)
+    {
+      sim->access(tile, addr, bytes, type);
+    }
+   private:
+    mempool_cache_sim_t* sim;
+    size_t tile;
+  };
+
+  struct tile_stats_t
+  {
+    uint64_t fetches;
+    uint64_t icache_misses;
+    uint64_t ro_reads;
+    uint64_t ro_misses;
+    uint64_t l2_bytes_read;
+    uint64_t l2_bytes_written;
+  };
+
+  bool in_l2(uint64_t begin, uint64_t end) const
+  {
+    return end > config.l2_base && begin < config.l2_base + config.l2_size;
+  }
+  bool in_ro(uint64_t addr) const
+  {
+    for (size_t i = 0; i < config.ro_num_regions; i++)
+      if (addr >= config.ro_start[i] && addr < config.ro_end[i])
+        return true;
+    return false;
+  }
+  void access(size_t tile, uint64_t addr, size_t bytes, access_type type);
+  void read_l2(size_t tile, uint64_t addr, size_t bytes);
+
+  const mempool_cache_config_t config;
+  std::vector<std::unique_ptr<cache_sim_t>> icaches;
+  std::vector<std::unique_ptr<cache_sim_t>> ro_caches;
+  std::vector<tile_stats_t> stats;
+  std::vector<std::unique_ptr<hart_tracer_t>> tracers;
+};
+
 #endif
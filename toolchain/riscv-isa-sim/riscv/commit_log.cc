@@ -0,0 +1,418 @@
+// See LICENSE for license details.
+
+#include "commit_log.h"
+#include "processor.h"
+#include "disasm.h"
+#include "byteorder.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+static const char COMMIT_LOG_MAGIC[8] = {'S', 'P', 'I', 'K', 'E', 'C', 'L', '1'};
+
+enum {
+  FLAG_RV64 = 1 << 2,
+  FLAG_FLEN_SHIFT = 3,
+  FLAG_SEQUENTIAL = 1 << 5,
+  FLAG_VECTOR = 1 << 6,
+};
+
+void commit_log_print_value(FILE *log_file, int width, const void *data)
+{
+  assert(log_file);
+
+  switch (width) {
+    case 8:
+      fprintf(log_file, "0x%01" PRIx8, *(const uint8_t *)data);
+      break;
+    case 16:
+      fprintf(log_file, "0x%04" PRIx16, *(const uint16_t *)data);
+      break;
+    case 32:
+      fprintf(log_file, "0x%08" PRIx32, *(const uint32_t *)data);
+      break;
+    case 64:
+      fprintf(log_file, "0x%016" PRIx64, *(const uint64_t *)data);
+      break;
+    default:
+      // max lengh of vector
+      if (((width - 1) & width) == 0) {
+        const uint64_t *arr = (const uint64_t *)data;
+
+        fprintf(log_file, "0x");
+        for (int idx = width / 64 - 1; idx >= 0; --idx) {
+          fprintf(log_file, "%016" PRIx64, arr[idx]);
+        }
+      } else {
+        abort();
+      }
+      break;
+  }
+}
+
+commit_log_buffer_t::commit_log_buffer_t(commit_log_writer_t* writer,
+                                         uint32_t hartid, size_t size)
+  : writer(writer), hartid(hartid), data(size), mask(size - 1), head(0),
+    committed(0), tail(0), next_pc(0)
+{
+  assert((size & mask) == 0);
+}
+
+void commit_log_buffer_t::put(const void* bytes, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+    put(((const uint8_t*)bytes)[i]);
+}
+
+void commit_log_buffer_t::put_varint(uint64_t val)
+{
+  while (val >= 0x80) {
+    put(uint8_t(val | 0x80));
+    val >>= 7;
+  }
+  put(uint8_t(val));
+}
+
+#ifdef RISCV_ENABLE_COMMITLOG
+void commit_log_buffer_t::log(processor_t* p, reg_t pc, insn_t insn)
+{
+  state_t* state = p->get_state();
+  auto& reg = state->log_reg_write;
+  auto& load = state->log_mem_read;
+  auto& store = state->log_mem_write;
+  int xlen = state->last_inst_xlen;
+  int flen = state->last_inst_flen;
+  reg_t xmask = xlen == 64 ? reg_t(-1) : reg_t(0xffffffff);
+  size_t vlenb = p->VU.VLEN / 8;
+
+  size_t regs = 0;
+  bool vector = false;
+  for (auto& item : reg) {
+    regs += item.first != 0;
+    vector |= item.first != 0 && ((item.first & 0xf) == 2 || (item.first & 0xf) == 3);
+  }
+
+  // Make room for the longest record these writes and accesses could take
+  writer->begin_record(this, 64 + regs * (10 + std::max<size_t>(16, vlenb)) +
+                       (load.size() + store.size()) * 32);
+
+  uint8_t flags = state->last_inst_priv | (xlen == 64 ? FLAG_RV64 : 0) |
+                  (flen == 128 ? 3 : flen / 32) << FLAG_FLEN_SHIFT |
+                  (pc == next_pc ? FLAG_SEQUENTIAL : 0) |
+                  (vector ? FLAG_VECTOR : 0);
+  put(flags);
+  if (pc != next_pc) {
+    sreg_t delta = pc - next_pc;
+    put_varint(uint64_t(delta) << 1 ^ uint64_t(delta >> 63));
+  }
+  uint64_t bits = to_le(uint64_t(insn.bits()));
+  put(uint8_t(insn.length()));
+  put(&bits, insn.length());
+  next_pc = pc + insn.length();
+
+  if (vector) {
+    put_varint(p->VU.vsew);
+    put(uint8_t(p->VU.vflmul < 1));
+    put_varint(p->VU.vflmul < 1 ? (reg_t)(1 / p->VU.vflmul) : (reg_t)p->VU.vflmul);
+    put_varint(p->VU.vl);
+    put_varint(vlenb);
+  }
+
+  put_varint(regs);
+  for (auto& item : reg) {
+    if (item.first == 0)
+      continue;
+
+    put_varint(item.first);
+    switch (item.first & 0xf) {
+      case 0:
+      case 4:
+        put_varint(item.second.v[0] & xmask);
+        break;
+      case 1:
+        put(item.second.v, flen / 8);
+        break;
+      case 2:
+        put(&p->VU.elt<uint8_t>(item.first >> 4, 0), vlenb);
+        break;
+    }
+  }
+
+  put_varint(load.size());
+  for (auto& item : load)
+    put_varint(std::get<0>(item) & xmask);
+
+  put_varint(store.size());
+  for (auto& item : store) {
+    put_varint(std::get<0>(item) & xmask);
+    put(std::get<2>(item));
+    put_varint(std::get<1>(item));
+  }
+}
+#endif
+
+commit_log_writer_t::commit_log_writer_t(const char* path)
+  : current(NULL), done(false)
+{
+  file = fopen(path, "wb");
+  if (!file)
+    throw std::runtime_error(std::string("can't open commit log ") + path +
+                             ": " + strerror(errno));
+  fwrite(COMMIT_LOG_MAGIC, 1, sizeof(COMMIT_LOG_MAGIC), file);
+}
+
+commit_log_writer_t::~commit_log_writer_t()
+{
+  if (current)
+    commit(current);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+  }
+  chunk_ready.notify_one();
+  if (thread.joinable())
+    thread.join();
+
+  fclose(file);
+  for (auto buffer : buffers)
+    delete buffer;
+}
+
+commit_log_buffer_t* commit_log_writer_t::add_hart(uint32_t hartid)
+{
+  buffers.push_back(new commit_log_buffer_t(this, hartid, BUFFER_SIZE));
+  return buffers.back();
+}
+
+void commit_log_writer_t::begin_record(commit_log_buffer_t* buffer,
+                                       size_t max_len)
+{
+  if (unlikely(current != buffer)) {
+    if (current)
+      commit(current);
+    current = buffer;
+  }
+
+  assert(max_len <= buffer->data.size());
+  auto fits = [=]() {
+    return buffer->head - buffer->tail.load() + max_len <= buffer->data.size();
+  };
+  if (unlikely(!fits())) {
+    commit(buffer);
+    std::unique_lock<std::mutex> guard(lock);
+    space_ready.wait(guard, fits);
+  }
+}
+
+void commit_log_writer_t::commit(commit_log_buffer_t* buffer)
+{
+  if (buffer->head == buffer->committed)
+    return;
+
+  if (!thread.joinable())
+    thread = std::thread(&commit_log_writer_t::main, this);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    chunks.push_back({buffer, buffer->committed, buffer->head});
+  }
+  buffer->committed = buffer->head;
+  chunk_ready.notify_one();
+}
+
+void commit_log_writer_t::main()
+{
+  while (true) {
+    chunk_t chunk;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      chunk_ready.wait(guard, [this]() { return done || !chunks.empty(); });
+      if (chunks.empty())
+        return;
+      chunk = chunks.front();
+      chunks.pop_front();
+    }
+
+    commit_log_buffer_t* buffer = chunk.buffer;
+    size_t len = chunk.end - chunk.begin;
+    size_t begin = chunk.begin & buffer->mask;
+    size_t first = std::min(len, buffer->data.size() - begin);
+    uint32_t header[2] = {to_le(buffer->hartid), to_le(uint32_t(len))};
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(&buffer->data[begin], 1, first, file);
+    fwrite(&buffer->data[0], 1, len - first, file);
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      buffer->tail.store(chunk.end);
+    }
+    space_ready.notify_one();
+  }
+}
+
+// Reads the records of a chunk, failing past its end
+struct commit_log_reader_t
+{
+  const uint8_t* pos;
+  const uint8_t* end;
+  bool error;
+
+  uint8_t get()
+  {
+    if (pos == end) {
+      error = true;
+      return 0;
+    }
+    return *pos++;
+  }
+
+  void get(void* bytes, size_t len)
+  {
+    for (size_t i = 0; i < len; i++)
+      ((uint8_t*)bytes)[i] = get();
+  }
+
+  uint64_t get_varint()
+  {
+    uint64_t val = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte = get();
+      val |= uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        break;
+    }
+    return val;
+  }
+};
+
+static void commit_log_print_value(FILE* out, int width, uint64_t val)
+{
+  commit_log_print_value(out, width, &val);
+}
+
+static bool commit_log_decode_insn(commit_log_reader_t& in, FILE* out,
+                                   uint32_t hartid, reg_t& next_pc)
+{
+  uint8_t flags = in.get();
+  int priv = flags & 3;
+  int xlen = flags & FLAG_RV64 ? 64 : 32;
+  int flen_code = (flags >> FLAG_FLEN_SHIFT) & 3;
+  int flen = flen_code ? 16 << flen_code : 0;
+
+  reg_t pc = next_pc;
+  if (!(flags & FLAG_SEQUENTIAL)) {
+    uint64_t zigzag = in.get_varint();
+    pc += (zigzag >> 1) ^ -(zigzag & 1);
+  }
+  size_t len = in.get();
+  uint64_t bits = 0;
+  if (len > sizeof(bits))
+    return false;
+  in.get(&bits, len);
+  bits = from_le(bits);
+  next_pc = pc + len;
+
+  fprintf(out, "core%4" PRId64 ": ", (int64_t)hartid);
+  fprintf(out, "%1d ", priv);
+  commit_log_print_value(out, xlen, pc);
+  fprintf(out, " (");
+  commit_log_print_value(out, len * 8, bits);
+  fprintf(out, ")");
+
+  reg_t vsew = 0, mf = 0, lmul = 0, vl = 0, vlenb = 0;
+  if (flags & FLAG_VECTOR) {
+    vsew = in.get_varint();
+    mf = in.get();
+    lmul = in.get_varint();
+    vl = in.get_varint();
+    vlenb = in.get_varint();
+  }
+  bool show_vec = false;
+
+  for (uint64_t n = in.get_varint(); n > 0 && !in.error; n--) {
+    reg_t key = in.get_varint();
+    int rd = key >> 4;
+    int type = key & 0xf;
+
+    if (!show_vec && (type == 2 || type == 3)) {
+      fprintf(out, " e%" PRIu64 " %s%" PRIu64 " l%" PRIu64, vsew,
+              mf ? "mf" : "m", lmul, vl);
+      show_vec = true;
+    }
+
+    switch (type) {
+      case 0:
+        fprintf(out, " %c%2d ", 'x', rd);
+        commit_log_print_value(out, xlen, in.get_varint());
+        break;
+      case 4:
+        fprintf(out, " c%d_%s ", rd, csr_name(rd));
+        commit_log_print_value(out, xlen, in.get_varint());
+        break;
+      case 1: {
+        uint64_t val[2] = {0, 0};
+        in.get(val, flen / 8);
+        fprintf(out, " %c%2d ", 'f', rd);
+        commit_log_print_value(out, flen, val);
+        break;
+      }
+      case 2: {
+        std::vector<uint64_t> val((vlenb + 7) / 8);
+        in.get(val.data(), vlenb);
+        fprintf(out, " %c%2d ", 'v', rd);
+        commit_log_print_value(out, vlenb * 8, val.data());
+        break;
+      }
+      case 3:
+        break;
+      default:
+        return false;
+    }
+  }
+
+  for (uint64_t n = in.get_varint(); n > 0 && !in.error; n--) {
+    fprintf(out, " mem ");
+    commit_log_print_value(out, xlen, in.get_varint());
+  }
+
+  for (uint64_t n = in.get_varint(); n > 0 && !in.error; n--) {
+    reg_t addr = in.get_varint();
+    int size = in.get();
+    uint64_t val = in.get_varint();
+    fprintf(out, " mem ");
+    commit_log_print_value(out, xlen, addr);
+    fprintf(out, " ");
+    commit_log_print_value(out, size << 3, val);
+  }
+  fprintf(out, "\n");
+
+  return !in.error;
+}
+
+bool commit_log_decode(FILE* in, FILE* out)
+{
+  char magic[sizeof(COMMIT_LOG_MAGIC)];
+  if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) ||
+      memcmp(magic, COMMIT_LOG_MAGIC, sizeof(magic)) != 0)
+    return false;
+
+  std::map<uint32_t, reg_t> next_pcs;
+  std::vector<uint8_t> chunk;
+  uint32_t header[2];
+  while (fread(header, sizeof(header), 1, in) == 1) {
+    uint32_t hartid = from_le(header[0]);
+    chunk.resize(from_le(header[1]));
+    if (fread(chunk.data(), 1, chunk.size(), in) != chunk.size())
+      return false;
+
+    commit_log_reader_t reader = {chunk.data(), chunk.data() + chunk.size(), false};
+    while (reader.pos != reader.end)
+      if (!commit_log_decode_insn(reader, out, hartid, next_pcs[hartid]))
+        return false;
+  }
+
+  return feof(in);
+}
@@ -0,0 +1,114 @@
+// See LICENSE for license details.
+
+#ifndef _RISCV_COMMIT_LOG_H
+#define _RISCV_COMMIT_LOG_H
+
+#include "decode.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class processor_t;
+class commit_log_writer_t;
+
+// Binary commit log. The file starts with "SPIKECL1" and holds chunks
+// of the records of one hart: its mhartid and the length of the records, as
+// 32-bit little-endian words, then the records. Each retired instruction is
+// a record, with varints for the numbers:
+//   flags: privilege in bits 1:0, rv64 in bit 2, the FLEN of 0, 32, 64 or
+//          128 bits as 0 to 3 in bits 4:3, a PC that follows the previous
+//          instruction of the hart in bit 5, a vector configuration in bit 6
+//   the distance of the PC from the end of the previous instruction, as a
+//          zigzag varint, unless bit 5 is set
+//   the length of the instruction in bytes, then its bytes
+//   vsew, a fractional LMUL flag byte, LMUL, vl and VLEN/8, if bit 6 is set
+//   the count of register writes, each the key of state_t::log_reg_write
+//          and the value: a varint for integer registers and CSRs, FLEN/8
+//          bytes for floating-point registers, VLEN/8 for vector registers
+//   the count of loads, each the address
+//   the count of stores, each the address, the size byte and the value
+// The records of a chunk follow each other in the order of execution, and
+// the chunks of the harts are in the order they were interleaved.
+
+// Records of one hart, in a ring drained by the writer thread
+class commit_log_buffer_t
+{
+ public:
+  commit_log_buffer_t(commit_log_writer_t* writer, uint32_t hartid,
+                      size_t size);
+
+#ifdef RISCV_ENABLE_COMMITLOG
+  // Append the record of the instruction at pc, just retired by p
+  void log(processor_t* p, reg_t pc, insn_t insn);
+#endif
+
+ private:
+  void put(uint8_t byte) { data[head++ & mask] = byte; }
+  void put(const void* bytes, size_t len);
+  void put_varint(uint64_t val);
+
+  commit_log_writer_t* writer;
+  uint32_t hartid;
+  std::vector<uint8_t> data;
+  size_t mask;
+  size_t head; // end of the records, only moved by the hart
+  size_t committed; // end of the records handed to the writer
+  std::atomic<size_t> tail; // end of the records written out
+  reg_t next_pc;
+
+  friend class commit_log_writer_t;
+};
+
+// The writer thread, with a buffer per hart. A hart hands its records over
+// when another hart starts logging, so the chunks keep the interleaving of
+// the harts, or when its buffer runs full.
+class commit_log_writer_t
+{
+ public:
+  commit_log_writer_t(const char* path);
+  ~commit_log_writer_t();
+
+  // The buffer of a new hart, to log its instructions to
+  commit_log_buffer_t* add_hart(uint32_t hartid);
+
+ private:
+  static const size_t BUFFER_SIZE = 1 << 20;
+
+  struct chunk_t
+  {
+    commit_log_buffer_t* buffer;
+    size_t begin;
+    size_t end;
+  };
+
+  // Called by the harts
+  void begin_record(commit_log_buffer_t* buffer, size_t max_len);
+  void commit(commit_log_buffer_t* buffer);
+
+  void main();
+
+  FILE* file;
+  std::vector<commit_log_buffer_t*> buffers;
+  commit_log_buffer_t* current; // the buffer of the hart logging now
+  std::mutex lock;
+  std::condition_variable chunk_ready;
+  std::condition_variable space_ready;
+  std::deque<chunk_t> chunks;
+  bool done;
+  std::thread thread; // started with the first chunk
+
+  friend class commit_log_buffer_t;
+};
+
+// Print a value of width bits as the text commit log does
+void commit_log_print_value(FILE *log_file, int width, const void *data);
+
+// Write the text commit log of the binary one read from in, as --log-commits
+// would have
+bool commit_log_decode(FILE* in, FILE* out);
+
+#endif
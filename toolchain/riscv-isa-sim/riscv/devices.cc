@@ -49,6 +49,12 @@ std::pair<reg_t, abstract_device_t*> bus_t::find_device(reg_t addr)
   return std::make_pair(it->first, it->second);
 }
 
+reg_t bus_t::next_device_base(reg_t addr)
+{
+  auto it = devices.upper_bound(addr);
+  return it == devices.end() ? 0 : it->first;
+}
+
 // Type for holding all registered MMIO plugins by name.
 using mmio_plugin_map_t = std::map<std::string, mmio_plugin_t>;
 
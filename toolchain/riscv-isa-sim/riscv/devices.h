@@ -8,6 +8,7 @@
 #include <map>
 #include <vector>
 #include <stdexcept>
+#include <sys/mman.h>
 
 class processor_t;
 
@@ -25,6 +26,8 @@ class bus_t : public abstract_device_t {
   void add_device(reg_t addr, abstract_device_t* dev);
 
   std::pair<reg_t, abstract_device_t*> find_device(reg_t addr);
+  // Base address of the first device above addr, or 0 if there is none
+  reg_t next_device_base(reg_t addr);
 
  private:
   std::map<reg_t, abstract_device_t*> devices;
@@ -40,17 +43,20 @@ class rom_device_t : public abstract_device_t {
   std::vector<char> data;
 };
 
+// The contents are mapped page-aligned, so that a snapshot of the memory can
+// be mapped over them copy-on-write
 class mem_t : public abstract_device_t {
  public:
   mem_t(size_t size) : len(size) {
     if (!size)
       throw std::runtime_error("zero bytes of target memory requested");
-    data = (char*)calloc(1, size);
-    if (!data)
+    data = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED)
       throw std::runtime_error("couldn't allocate " + std::to_string(size) + " bytes of target memory");
   }
   mem_t(const mem_t& that) = delete;
-  ~mem_t() { free(data); }
+  ~mem_t() { munmap(data, len); }
 
   bool load(reg_t addr, size_t len, uint8_t* bytes) { return false; }
   bool store(reg_t addr, size_t len, const uint8_t* bytes) { return false; }
@@ -69,6 +75,11 @@ class clint_t : public abstract_device_t {
   bool store(reg_t addr, size_t len, const uint8_t* bytes);
   size_t size() { return CLINT_SIZE; }
   void increment(reg_t inc);
+  // Timer state, saved and restored with the snapshots of the simulation
+  uint64_t get_mtime() { return mtime; }
+  void set_mtime(uint64_t val) { mtime = val; }
+  uint64_t get_mtimecmp(size_t i) { return mtimecmp[i]; }
+  void set_mtimecmp(size_t i, uint64_t val) { mtimecmp[i] = val; }
  private:
   typedef uint64_t mtime_t;
   typedef uint64_t mtimecmp_t;
@@ -47,15 +47,22 @@ class disasm_insn_t
 
   std::string to_string(insn_t insn) const
   {
-    std::stringstream s;
+    std::string s;
+    append_to(s, insn);
+    return s;
+  }
+
+  // Append the disassembly of insn to s, without a stream
+  void append_to(std::string& s, insn_t insn) const
+  {
     int len;
     for (len = 0; name[len]; len++)
-      s << (name[len] == '_' ? '.' : name[len]);
+      s += name[len] == '_' ? '.' : name[len];
 
     if (args.size())
     {
       bool next_arg_optional  = false;
-      s << std::string(std::max(1, 8 - len), ' ');
+      s.append(std::max(1, 8 - len), ' ');
       for (size_t i = 0; i < args.size(); i++) {
         if (args[i] == &opt) {
           next_arg_optional = true;
@@ -66,11 +73,10 @@ class disasm_insn_t
           next_arg_optional = false;
           if (argString.empty()) continue;
         }
-        if (i != 0) s << ", ";
-        s << argString;
+        if (i != 0) s += ", ";
+        s += argString;
       }
     }
-    return s.str();
   }
 
   uint32_t get_match() const { return match; }
@@ -90,6 +96,8 @@ class disassembler_t
   ~disassembler_t();
 
   std::string disassemble(insn_t insn) const;
+  // Append the disassembly of insn to s
+  void disassemble(insn_t insn, std::string& s) const;
   const disasm_insn_t* lookup(insn_t insn) const;
 
   void add_insn(disasm_insn_t* insn);
@@ -97,6 +105,20 @@ class disassembler_t
  private:
   static const int HASH_SIZE = 256;
   std::vector<const disasm_insn_t*> chain[HASH_SIZE+1];
+
+  // Disassembly of the instruction words seen last, direct mapped by their
+  // bits, as traces repeat the same words many times. disassemble() fills
+  // it, so it must not be called from several threads at once. It is
+  // allocated with the first instruction and dropped by add_insn().
+  static const size_t CACHE_SIZE = 4096;
+  struct cache_entry_t
+  {
+    insn_bits_t bits = 0;
+    bool valid = false;
+    std::string text;
+  };
+  const std::string& cached(insn_t insn) const;
+  mutable std::vector<cache_entry_t> cache;
 };
 
 #endif
@@ -3,6 +3,8 @@
 #include "processor.h"
 #include "mmu.h"
 #include "disasm.h"
+#include "timing.h"
+#include "commit_log.h"
 #include <cassert>
 
 #ifdef RISCV_ENABLE_COMMITLOG
@@ -21,39 +23,6 @@ static void commit_log_stash_privilege(processor_t* p)
   state->last_inst_flen = p->get_flen();
 }
 
-static void commit_log_print_value(FILE *log_file, int width, const void *data)
-{
-  assert(log_file);
-
-  switch (width) {
-    case 8:
-      fprintf(log_file, "0x%01" PRIx8, *(const uint8_t *)data);
-      break;
-    case 16:
-      fprintf(log_file, "0x%04" PRIx16, *(const uint16_t *)data);
-      break;
-    case 32:
-      fprintf(log_file, "0x%08" PRIx32, *(const uint32_t *)data);
-      break;
-    case 64:
-      fprintf(log_file, "0x%016" PRIx64, *(const uint64_t *)data);
-      break;
-    default:
-      // max lengh of vector
-      if (((width - 1) & width) == 0) {
-        const uint64_t *arr = (const uint64_t *)data;
-
-        fprintf(log_file, "0x");
-        for (int idx = width / 64 - 1; idx >= 0; --idx) {
-          fprintf(log_file, "%016" PRIx64, arr[idx]);
-        }
-      } else {
-        abort();
-      }
-      break;
-  }
-}
-
 static void commit_log_print_value(FILE *log_file, int width, uint64_t val)
 {
   commit_log_print_value(log_file, width, &val);
@@ -66,6 +35,11 @@ const char* processor_t::get_symbol(uint64_t addr)
 
 static void commit_log_print_insn(processor_t *p, reg_t pc, insn_t insn)
 {
+  if (p->get_commit_log()) {
+    p->get_commit_log()->log(p, pc, insn);
+    return;
+  }
+
   FILE *log_file = p->get_log_file();
 
   auto& reg = p->get_state()->log_reg_write;
@@ -164,7 +138,13 @@ static void commit_log_print_insn(processor_t* p, reg_t pc, insn_t insn) {}
 inline void processor_t::update_histogram(reg_t pc)
 {
 #ifdef RISCV_ENABLE_HISTOGRAM
-  pc_histogram[pc]++;
+  if (!histogram_enabled)
+    return;
+  reg_t idx = (pc - pc_histogram_base) / 2;
+  if (likely(idx < pc_histogram.size()))
+    pc_histogram[idx]++;
+  else
+    grow_histogram(pc);
 #endif
 }
 
@@ -180,6 +160,8 @@ static reg_t execute_insn(processor_t* p, reg_t pc, insn_fetch_t fetch)
   try {
     npc = fetch.func(p, fetch.insn, pc);
     if (npc != PC_SERIALIZE_BEFORE) {
+      if (unlikely(p->get_timing() != NULL))
+        p->get_timing()->retire(fetch.insn, pc, npc);
 
 #ifdef RISCV_ENABLE_COMMITLOG
       if (p->get_log_commits_enabled()) {
@@ -209,6 +191,122 @@ static reg_t execute_insn(processor_t* p, reg_t pc, insn_fetch_t fetch)
   return npc;
 }
 
+// The other instructions of a block call their insn_func_t, out of line to
+// keep execute_bb() small
+static NOINLINE reg_t execute_bb_call(processor_t* p, reg_t pc, bb_insn_t* i)
+{
+  return execute_insn(p, pc, i->fetch);
+}
+
+// Run the instructions of a block from insn up to end, or up to the first one
+// that does not fall through to the next, and leave the last one to
+// advance_pc(). The instructions that bb_decode() recognized run here with
+// the semantics of their rv32 insn_func_t. Each of them jumps to the next one
+// on its own, which the host predicts better than a jump shared by all of
+// them, as the Duff's device of the icache does. On a trap, pc is the PC of
+// the instruction that took it.
+static void execute_bb(processor_t* p, reg_t& pc_ref, bb_insn_t* insn,
+                       bb_insn_t* end, size_t& instret_ref)
+{
+  // In the order of bb_op_t
+  static void* const ops[] = {
+    &&bb_call, &&bb_li, &&bb_addi, &&bb_slti, &&bb_sltiu, &&bb_xori,
+    &&bb_ori, &&bb_andi, &&bb_slli, &&bb_srli, &&bb_srai, &&bb_add, &&bb_sub,
+    &&bb_sll, &&bb_slt, &&bb_sltu, &&bb_xor, &&bb_srl, &&bb_sra, &&bb_or,
+    &&bb_and, &&bb_lb, &&bb_lh, &&bb_lw, &&bb_lbu, &&bb_lhu, &&bb_sb,
+    &&bb_sh, &&bb_sw, &&bb_beq, &&bb_bne, &&bb_blt, &&bb_bge, &&bb_bltu,
+    &&bb_bgeu, &&bb_jal,
+  };
+  static_assert(sizeof(ops) / sizeof(ops[0]) == BB_JAL + 1, "bb_op_t");
+
+  reg_t pc = pc_ref;
+  size_t instret = instret_ref;
+
+  #define BB_X(r) (STATE.XPR[r])
+  #define BB_WRITE(val) STATE.XPR.write(insn->rd, (int32_t)(val))
+  #define BB_NEXT() \
+    if (++insn == end) \
+      goto done; \
+    instret++; \
+    STATE.pc = pc; \
+    goto *ops[insn->op];
+  #define BB_OP(stmt) \
+    stmt; \
+    pc = int32_t(pc + 4); \
+    BB_NEXT()
+  #define BB_BRANCH(cond) \
+    if (cond) { \
+      p->check_pc_alignment(insn->imm); \
+      pc = insn->imm; \
+      goto done; \
+    } \
+    pc = int32_t(pc + 4); \
+    BB_NEXT()
+
+  try {
+    goto *ops[insn->op];
+    bb_call: {
+      reg_t fallthrough = pc + insn->fetch.insn.length();
+      pc = execute_bb_call(p, pc, insn);
+      if (unlikely(pc != fallthrough))
+        goto done;
+      BB_NEXT()
+    }
+    bb_li: BB_OP(STATE.XPR.write(insn->rd, insn->imm))
+    bb_addi: BB_OP(BB_WRITE(BB_X(insn->rs1) + insn->imm))
+    bb_slti: BB_OP(BB_WRITE(sreg_t(BB_X(insn->rs1)) < sreg_t(insn->imm)))
+    bb_sltiu: BB_OP(BB_WRITE(BB_X(insn->rs1) < insn->imm))
+    bb_xori: BB_OP(BB_WRITE(BB_X(insn->rs1) ^ insn->imm))
+    bb_ori: BB_OP(BB_WRITE(BB_X(insn->rs1) | insn->imm))
+    bb_andi: BB_OP(BB_WRITE(BB_X(insn->rs1) & insn->imm))
+    bb_slli: BB_OP(BB_WRITE(BB_X(insn->rs1) << insn->imm))
+    bb_srli: BB_OP(BB_WRITE(uint32_t(BB_X(insn->rs1)) >> insn->imm))
+    bb_srai: BB_OP(BB_WRITE(int32_t(BB_X(insn->rs1)) >> insn->imm))
+    bb_add: BB_OP(BB_WRITE(BB_X(insn->rs1) + BB_X(insn->rs2)))
+    bb_sub: BB_OP(BB_WRITE(BB_X(insn->rs1) - BB_X(insn->rs2)))
+    bb_sll: BB_OP(BB_WRITE(BB_X(insn->rs1) << (BB_X(insn->rs2) & 31)))
+    bb_slt: BB_OP(BB_WRITE(sreg_t(BB_X(insn->rs1)) < sreg_t(BB_X(insn->rs2))))
+    bb_sltu: BB_OP(BB_WRITE(BB_X(insn->rs1) < BB_X(insn->rs2)))
+    bb_xor: BB_OP(BB_WRITE(BB_X(insn->rs1) ^ BB_X(insn->rs2)))
+    bb_srl: BB_OP(BB_WRITE(uint32_t(BB_X(insn->rs1)) >> (BB_X(insn->rs2) & 31)))
+    bb_sra: BB_OP(BB_WRITE(int32_t(BB_X(insn->rs1)) >> (BB_X(insn->rs2) & 31)))
+    bb_or: BB_OP(BB_WRITE(BB_X(insn->rs1) | BB_X(insn->rs2)))
+    bb_and: BB_OP(BB_WRITE(BB_X(insn->rs1) & BB_X(insn->rs2)))
+    bb_lb: BB_OP(BB_WRITE(MMU.load_int8(BB_X(insn->rs1) + insn->imm)))
+    bb_lh: BB_OP(BB_WRITE(MMU.load_int16(BB_X(insn->rs1) + insn->imm)))
+    bb_lw: BB_OP(BB_WRITE(MMU.load_int32(BB_X(insn->rs1) + insn->imm)))
+    bb_lbu: BB_OP(BB_WRITE(MMU.load_uint8(BB_X(insn->rs1) + insn->imm)))
+    bb_lhu: BB_OP(BB_WRITE(MMU.load_uint16(BB_X(insn->rs1) + insn->imm)))
+    bb_sb: BB_OP(MMU.store_uint8(BB_X(insn->rs1) + insn->imm, BB_X(insn->rs2)))
+    bb_sh: BB_OP(MMU.store_uint16(BB_X(insn->rs1) + insn->imm, BB_X(insn->rs2)))
+    bb_sw: BB_OP(MMU.store_uint32(BB_X(insn->rs1) + insn->imm, BB_X(insn->rs2)))
+    bb_beq: BB_BRANCH(BB_X(insn->rs1) == BB_X(insn->rs2))
+    bb_bne: BB_BRANCH(BB_X(insn->rs1) != BB_X(insn->rs2))
+    bb_blt: BB_BRANCH(sreg_t(BB_X(insn->rs1)) < sreg_t(BB_X(insn->rs2)))
+    bb_bge: BB_BRANCH(sreg_t(BB_X(insn->rs1)) >= sreg_t(BB_X(insn->rs2)))
+    bb_bltu: BB_BRANCH(BB_X(insn->rs1) < BB_X(insn->rs2))
+    bb_bgeu: BB_BRANCH(BB_X(insn->rs1) >= BB_X(insn->rs2))
+    bb_jal:
+      p->check_pc_alignment(insn->imm);
+      BB_WRITE(pc + 4);
+      pc = insn->imm;
+  } catch (...) {
+    pc_ref = pc;
+    instret_ref = instret;
+    throw;
+  }
+
+done:
+  pc_ref = pc;
+  instret_ref = instret;
+
+  #undef BB_X
+  #undef BB_WRITE
+  #undef BB_NEXT
+  #undef BB_OP
+  #undef BB_BRANCH
+}
+
 bool processor_t::slow_path()
 {
   return debug || state.single_step != state.STEP_NONE || state.debug_mode;
@@ -276,6 +374,31 @@ void processor_t::step(size_t n)
           advance_pc();
         }
       }
+      else if (_mmu->bbcache_enabled())
+      {
+        // Each block is decoded once into an array of instructions, which run
+        // back to back until one of them does not fall through to the next.
+        // A block is chained to the block that followed it last time, so
+        // that loops and straight-line code skip the lookup.
+        bb_entry_t* bb = NULL;
+        while (instret < n)
+        {
+          bb_entry_t* next = bb ? bb->chain : NULL;
+          if (unlikely(!next || next->tag != pc)) {
+            next = _mmu->access_bbcache(pc);
+            if (bb)
+              bb->chain = next;
+          }
+          bb = next;
+
+          // Up to the end of the block or the n-th instruction
+          execute_bb(this, pc, bb->insns,
+                     bb->insns + std::min<size_t>(bb->size, n - instret),
+                     instret);
+
+          advance_pc();
+        }
+      }
       else while (instret < n)
       {
         // This code uses a modified Duff's Device to improve the performance
@@ -4,25 +4,216 @@
 #include "simif.h"
 #include "processor.h"
 
+#include <algorithm>
+
+std::vector<mmu_t*> mmu_t::mmus;
+std::unordered_map<reg_t, uint64_t> mmu_t::code_chunks;
+
 mmu_t::mmu_t(simif_t* sim, processor_t* proc)
- : sim(sim), proc(proc),
+ : sim(sim), proc(proc), bb_used(0), bbcache_on(true), n_flat(0), flat_mask(-1),
   check_triggers_fetch(false),
   check_triggers_load(false),
   check_triggers_store(false),
   matched_trigger(NULL)
 {
+  mmus.push_back(this);
   flush_tlb();
   yield_load_reservation();
 }
 
 mmu_t::~mmu_t()
 {
+  mmus.erase(std::find(mmus.begin(), mmus.end(), this));
 }
 
 void mmu_t::flush_icache()
 {
   for (size_t i = 0; i < ICACHE_ENTRIES; i++)
     icache[i].tag = -1;
+  flush_bbcache();
+}
+
+void mmu_t::flush_bbcache()
+{
+  for (size_t i = 0; i < BBCACHE_ENTRIES; i++)
+    bbcache[i].tag = -1;
+  bb_used = 0;
+}
+
+static bool insn_ends_block(insn_t insn)
+{
+  insn_bits_t bits = insn.bits();
+  if (insn.length() == 2) {
+    // c.jal, c.j, c.beqz, c.bnez, and quadrant 2 funct3 4, which holds c.jr,
+    // c.jalr and c.ebreak
+    insn_bits_t funct3 = (bits >> 13) & 7;
+    return ((bits & 3) == 1 && (funct3 == 1 || funct3 >= 5)) ||
+           ((bits & 3) == 2 && funct3 == 4);
+  }
+  // Branches, jumps, system instructions and fences
+  switch (bits & 0x7f) {
+    case 0x63: case 0x67: case 0x6f: case 0x73: case 0x0f:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void bb_decode(bb_insn_t* i, reg_t pc, bool fast)
+{
+  static const struct { insn_bits_t mask, match; uint8_t op; } ops[] = {
+    {MASK_LUI, MATCH_LUI, BB_LI}, {MASK_AUIPC, MATCH_AUIPC, BB_LI},
+    {MASK_ADDI, MATCH_ADDI, BB_ADDI}, {MASK_SLTI, MATCH_SLTI, BB_SLTI},
+    {MASK_SLTIU, MATCH_SLTIU, BB_SLTIU}, {MASK_XORI, MATCH_XORI, BB_XORI},
+    {MASK_ORI, MATCH_ORI, BB_ORI}, {MASK_ANDI, MATCH_ANDI, BB_ANDI},
+    {MASK_SLLI, MATCH_SLLI, BB_SLLI}, {MASK_SRLI, MATCH_SRLI, BB_SRLI},
+    {MASK_SRAI, MATCH_SRAI, BB_SRAI},
+    {MASK_ADD, MATCH_ADD, BB_ADD}, {MASK_SUB, MATCH_SUB, BB_SUB},
+    {MASK_SLL, MATCH_SLL, BB_SLL}, {MASK_SLT, MATCH_SLT, BB_SLT},
+    {MASK_SLTU, MATCH_SLTU, BB_SLTU}, {MASK_XOR, MATCH_XOR, BB_XOR},
+    {MASK_SRL, MATCH_SRL, BB_SRL}, {MASK_SRA, MATCH_SRA, BB_SRA},
+    {MASK_OR, MATCH_OR, BB_OR}, {MASK_AND, MATCH_AND, BB_AND},
+    {MASK_LB, MATCH_LB, BB_LB}, {MASK_LH, MATCH_LH, BB_LH},
+    {MASK_LW, MATCH_LW, BB_LW}, {MASK_LBU, MATCH_LBU, BB_LBU},
+    {MASK_LHU, MATCH_LHU, BB_LHU}, {MASK_SB, MATCH_SB, BB_SB},
+    {MASK_SH, MATCH_SH, BB_SH}, {MASK_SW, MATCH_SW, BB_SW},
+    {MASK_BEQ, MATCH_BEQ, BB_BEQ}, {MASK_BNE, MATCH_BNE, BB_BNE},
+    {MASK_BLT, MATCH_BLT, BB_BLT}, {MASK_BGE, MATCH_BGE, BB_BGE},
+    {MASK_BLTU, MATCH_BLTU, BB_BLTU}, {MASK_BGEU, MATCH_BGEU, BB_BGEU},
+    {MASK_JAL, MATCH_JAL, BB_JAL},
+  };
+
+  insn_t insn = i->fetch.insn;
+  insn_bits_t bits = insn.bits();
+  i->op = BB_CALL;
+  i->rd = insn.rd();
+  i->rs1 = insn.rs1();
+  i->rs2 = insn.rs2();
+  i->imm = insn.i_imm();
+  if (!fast || insn.length() != 4)
+    return;
+
+  for (auto& o : ops) {
+    if ((bits & o.mask) == o.match) {
+      i->op = o.op;
+      break;
+    }
+  }
+
+  // Values are sign-extended from 32 bits, as in rv32 instructions
+  switch (i->op) {
+    case BB_LI:
+      i->imm = (int32_t)(insn.u_imm() + ((bits & 0x7f) == MATCH_AUIPC ? pc : 0));
+      break;
+    case BB_SLLI: case BB_SRLI: case BB_SRAI:
+      i->imm = insn.shamt();
+      if (i->imm >= 32)
+        i->op = BB_CALL;
+      break;
+    case BB_SB: case BB_SH: case BB_SW:
+      i->imm = insn.s_imm();
+      break;
+    case BB_BEQ: case BB_BNE: case BB_BLT: case BB_BGE: case BB_BLTU:
+    case BB_BGEU:
+      i->imm = (int32_t)(pc + insn.sb_imm());
+      break;
+    case BB_JAL:
+      i->imm = (int32_t)(pc + insn.uj_imm());
+      break;
+  }
+}
+
+bb_entry_t* mmu_t::refill_bbcache(reg_t addr, bb_entry_t* entry)
+{
+  if (bb_insns.empty())
+    bb_insns.resize(BB_ARENA_INSNS);
+  if (bb_used + BB_MAX_INSNS > bb_insns.size())
+    flush_bbcache();
+
+  // The instructions of rv32 harts run without calling their insn_func_t,
+  // unless something has to observe each of them
+  bool fast = proc && proc->get_max_xlen() == 32 && !proc->get_extension() &&
+              !proc->get_timing();
+#ifdef RISCV_ENABLE_COMMITLOG
+  fast = fast && !proc->get_log_commits_enabled();
+#endif
+#ifdef RISCV_ENABLE_HISTOGRAM
+  fast = fast && !proc->histogram_enabled;
+#endif
+
+  // A fault on the first instruction is taken, a fault on the following ones
+  // ends the block before them. Blocks do not cross pages.
+  bb_insn_t* insns = &bb_insns[bb_used];
+  icache_entry_t fetch;
+  reg_t pc = addr;
+  size_t size = 0;
+  do {
+    try {
+      refill_icache(pc, &fetch);
+    } catch (trap_t& t) {
+      if (size == 0)
+        throw;
+      break;
+    }
+    insns[size].fetch = fetch.data;
+    bb_decode(&insns[size++], pc, fast);
+    pc += fetch.data.insn.length();
+  } while (size < BB_MAX_INSNS && !insn_ends_block(fetch.data.insn) &&
+           ((pc ^ addr) & ~(PGSIZE - 1)) == 0);
+
+  add_code(translate_insn_addr(addr).target_offset + addr, pc - addr);
+
+  bb_used += size;
+  entry->tag = addr;
+  entry->size = size;
+  entry->insns = insns;
+  entry->chain = NULL;
+  return entry;
+}
+
+void mmu_t::add_code(reg_t paddr, reg_t len)
+{
+  for (reg_t a = paddr & ~(CODE_CHUNK - 1); a < paddr + len; a += CODE_CHUNK) {
+    uint64_t& chunks = code_chunks[a >> PGSHIFT];
+    if (!chunks) {
+      for (auto mmu : mmus)
+        mmu->evict_store(a >> PGSHIFT);
+    }
+    chunks |= uint64_t(1) << ((a % PGSIZE) / CODE_CHUNK);
+  }
+}
+
+void mmu_t::evict_store(reg_t ppn)
+{
+  for (size_t i = 0; i < n_flat; i++) {
+    if ((ppn << PGSHIFT) - flat[i].base < flat[i].size)
+      flat[i].writable = false;
+  }
+
+  for (size_t i = 0; i < TLB_ENTRIES; i++) {
+    if (tlb_store_tag[i] == (reg_t)-1)
+      continue;
+    reg_t vpn = tlb_store_tag[i] & ~TLB_CHECK_TRIGGERS;
+    if ((tlb_data[i].target_offset + (vpn << PGSHIFT)) >> PGSHIFT == ppn)
+      tlb_store_tag[i] = -1;
+  }
+}
+
+void mmu_t::store_to_code(reg_t paddr, reg_t len)
+{
+  auto it = code_chunks.find(paddr >> PGSHIFT);
+  if (it == code_chunks.end())
+    return;
+  reg_t first = (paddr % PGSIZE) / CODE_CHUNK;
+  reg_t last = std::min((paddr % PGSIZE + len - 1) / CODE_CHUNK, reg_t(63));
+  uint64_t mask = (uint64_t(2) << last) - (uint64_t(1) << first);
+  if (!(it->second & mask))
+    return;
+
+  // No block is left, so no page holds code anymore
+  for (auto mmu : mmus)
+    mmu->flush_bbcache();
+  code_chunks.clear();
 }
 
 void mmu_t::flush_tlb()
@@ -30,10 +221,50 @@ void mmu_t::flush_tlb()
   memset(tlb_insn_tag, -1, sizeof(tlb_insn_tag));
   memset(tlb_load_tag, -1, sizeof(tlb_load_tag));
   memset(tlb_store_tag, -1, sizeof(tlb_store_tag));
+  n_flat = 0;
 
   flush_icache();
 }
 
+void mmu_t::refill_flat(reg_t paddr)
+{
+  // Only accesses of M-mode are not translated
+  if (!proc || proc->state.v || proc->state.prv != PRV_M ||
+      get_field(proc->state.mstatus, MSTATUS_MPRV))
+    return;
+  if (check_triggers_load || check_triggers_store || n_flat == FLAT_REGIONS)
+    return;
+
+  for (size_t i = 0; i < n_flat; i++) {
+    if (paddr - flat[i].base < flat[i].size)
+      return;
+  }
+  mem_region_t region;
+  if (!sim->addr_to_region(paddr, &region))
+    return;
+
+  // Only locked PMP entries apply to M-mode, they are not checked on the way
+  for (size_t i = 0; i < proc->n_pmp; i++) {
+    if ((proc->state.pmpcfg[i] & PMP_A) && (proc->state.pmpcfg[i] & PMP_L))
+      return;
+  }
+
+  reg_t end = region.base + region.size;
+  if (tracer.interested_in_range(region.base, end, LOAD))
+    return;
+
+  // Stores to pages with cached blocks must take the slow path
+  region.writable = region.writable &&
+    !tracer.interested_in_range(region.base, end, STORE);
+  for (auto& code : code_chunks) {
+    if ((code.first << PGSHIFT) - region.base < region.size)
+      region.writable = false;
+  }
+
+  flat_mask = (reg_t(2) << (proc->get_xlen() - 1)) - 1;
+  flat[n_flat++] = region;
+}
+
 static void throw_access_exception(reg_t addr, access_type type)
 {
   switch (type) {
@@ -141,6 +372,8 @@ bool mmu_t::mmio_store(reg_t addr, size_t len, const uint8_t* bytes)
 void mmu_t::load_slow_path(reg_t addr, reg_t len, uint8_t* bytes, uint32_t xlate_flags)
 {
   reg_t paddr = translate(addr, len, LOAD, xlate_flags);
+  if (!xlate_flags)
+    refill_flat(paddr);
 
   if (auto host_addr = sim->addr_to_mem(paddr)) {
     memcpy(bytes, host_addr, len);
@@ -163,6 +396,8 @@ void mmu_t::load_slow_path(reg_t addr, reg_t len, uint8_t* bytes, uint32_t xlate
 void mmu_t::store_slow_path(reg_t addr, reg_t len, const uint8_t* bytes, uint32_t xlate_flags)
 {
   reg_t paddr = translate(addr, len, STORE, xlate_flags);
+  if (!xlate_flags)
+    refill_flat(paddr);
 
   if (!matched_trigger) {
     reg_t data = reg_from_bytes(len, bytes);
@@ -173,6 +408,8 @@ void mmu_t::store_slow_path(reg_t addr, reg_t len, const uint8_t* bytes, uint32_
 
   if (auto host_addr = sim->addr_to_mem(paddr)) {
     memcpy(host_addr, bytes, len);
+    if (unlikely(!code_chunks.empty()))
+      store_to_code(paddr, len);
     if (tracer.interested_in_range(paddr, paddr + PGSIZE, STORE))
       tracer.trace(paddr, len, STORE);
     else
@@ -201,7 +438,11 @@ tlb_entry_t mmu_t::refill_tlb(reg_t vaddr, reg_t paddr, char* host_addr, access_
 
   if (pmp_homogeneous(paddr & ~reg_t(PGSIZE - 1), PGSIZE)) {
     if (type == FETCH) tlb_insn_tag[idx] = expected_tag;
-    else if (type == STORE) tlb_store_tag[idx] = expected_tag;
+    else if (type == STORE) {
+      // Stores to pages with cached blocks must take the slow path
+      if (!code_chunks.count(paddr >> PGSHIFT))
+        tlb_store_tag[idx] = expected_tag;
+    }
     else tlb_load_tag[idx] = expected_tag;
   }
 
@@ -441,4 +682,6 @@ void mmu_t::register_memtracer(memtracer_t* t)
 {
   flush_tlb();
   tracer.hook(t);
+  if (t->interested_in_range(0, -1, FETCH))
+    bbcache_on = false;
 }
@@ -13,6 +13,7 @@
 #include "byteorder.h"
 #include <stdlib.h>
 #include <vector>
+#include <unordered_map>
 
 // virtual memory configuration
 #define PGSHIFT 12
@@ -32,6 +33,33 @@ struct icache_entry_t {
   insn_fetch_t data;
 };
 
+// Instructions of the blocks that run without calling their insn_func_t,
+// with their operands extracted when the block is decoded
+enum bb_op_t {
+  BB_CALL, // call fetch.func
+  BB_LI, BB_ADDI, BB_SLTI, BB_SLTIU, BB_XORI, BB_ORI, BB_ANDI,
+  BB_SLLI, BB_SRLI, BB_SRAI,
+  BB_ADD, BB_SUB, BB_SLL, BB_SLT, BB_SLTU, BB_XOR, BB_SRL, BB_SRA, BB_OR,
+  BB_AND,
+  BB_LB, BB_LH, BB_LW, BB_LBU, BB_LHU, BB_SB, BB_SH, BB_SW,
+  BB_BEQ, BB_BNE, BB_BLT, BB_BGE, BB_BLTU, BB_BGEU, BB_JAL,
+};
+
+struct bb_insn_t {
+  insn_fetch_t fetch;
+  reg_t imm; // immediate, value of lui and auipc, or target of the jumps
+  uint8_t op, rd, rs1, rs2;
+};
+
+// A straight-line block of decoded instructions, which ends with the first
+// control-flow instruction, chained to the block that followed it last time
+struct bb_entry_t {
+  reg_t tag;
+  size_t size;
+  bb_insn_t* insns;
+  struct bb_entry_t* chain;
+};
+
 struct tlb_entry_t {
   char* host_offset;
   reg_t target_offset;
@@ -97,6 +125,16 @@ public:
         flush_tlb(); \
       if (unlikely(addr & (sizeof(type##_t)-1))) \
         return misaligned_load(addr, sizeof(type##_t)); \
+      if (!(xlate_flags)) { \
+        for (size_t i = 0; i < n_flat; i++) { \
+          reg_t offset = (addr & flat_mask) - flat[i].base; \
+          if (offset < flat[i].size && \
+              flat[i].size - offset >= sizeof(type##_t)) { \
+            if (proc) READ_MEM(addr, sizeof(type##_t)); \
+            return from_le(*(type##_t*)(flat[i].host + offset)); \
+          } \
+        } \
+      } \
       reg_t vpn = addr >> PGSHIFT; \
       size_t size = sizeof(type##_t); \
       if (likely(tlb_load_tag[vpn % TLB_ENTRIES] == vpn)) { \
@@ -161,6 +199,17 @@ public:
         flush_tlb(); \
       if (unlikely(addr & (sizeof(type##_t)-1))) \
         return misaligned_store(addr, val, sizeof(type##_t)); \
+      if (!(xlate_flags)) { \
+        for (size_t i = 0; i < n_flat; i++) { \
+          reg_t offset = (addr & flat_mask) - flat[i].base; \
+          if (offset < flat[i].size && \
+              flat[i].size - offset >= sizeof(type##_t) && flat[i].writable) { \
+            if (proc) WRITE_MEM(addr, val, sizeof(type##_t)); \
+            *(type##_t*)(flat[i].host + offset) = to_le(val); \
+            return; \
+          } \
+        } \
+      } \
       reg_t vpn = addr >> PGSHIFT; \
       size_t size = sizeof(type##_t); \
       if (likely(tlb_store_tag[vpn % TLB_ENTRIES] == vpn)) { \
@@ -319,8 +368,25 @@ public:
     return refill_icache(addr, &entry)->data;
   }
 
+  static const reg_t BBCACHE_ENTRIES = 1024;
+  static const size_t BB_MAX_INSNS = 64;
+  static const size_t BB_ARENA_INSNS = 16384;
+
+  // The block cache cannot be used when every fetch has to be traced or
+  // checked for triggers
+  bool bbcache_enabled() { return bbcache_on && !check_triggers_fetch; }
+
+  inline bb_entry_t* access_bbcache(reg_t addr)
+  {
+    bb_entry_t* entry = &bbcache[(addr / PC_ALIGN) % BBCACHE_ENTRIES];
+    if (likely(entry->tag == addr))
+      return entry;
+    return refill_bbcache(addr, entry);
+  }
+
   void flush_tlb();
   void flush_icache();
+  void flush_bbcache();
 
   void register_memtracer(memtracer_t*);
 
@@ -352,6 +418,34 @@ private:
   // implement an instruction cache for simulator performance
   icache_entry_t icache[ICACHE_ENTRIES];
 
+  // implement a cache of decoded blocks for simulator performance, the
+  // instructions of the blocks are allocated in bb_insns
+  bb_entry_t bbcache[BBCACHE_ENTRIES];
+  std::vector<bb_insn_t> bb_insns;
+  size_t bb_used;
+  bool bbcache_on;
+  bb_entry_t* refill_bbcache(reg_t addr, bb_entry_t* entry);
+
+  // Physical pages holding cached blocks, with a bitmap of their CODE_CHUNK
+  // byte chunks. Stores to these pages take the slow path, and a store to a
+  // chunk with code flushes the blocks of all the harts.
+  static const reg_t CODE_CHUNK = PGSIZE / 64;
+  static std::vector<mmu_t*> mmus;
+  static std::unordered_map<reg_t, uint64_t> code_chunks;
+  void add_code(reg_t paddr, reg_t len);
+  void evict_store(reg_t ppn);
+  static void store_to_code(reg_t paddr, reg_t len);
+
+  // Regions of host memory that loads and stores of bare M-mode access
+  // directly, before looking up the TLB. The regions are added by the slow
+  // paths of the accesses to them and are dropped with the TLB. flat_mask
+  // zero-extends the addresses from XLEN, like the walk of bare mode.
+  static const size_t FLAT_REGIONS = 4;
+  mem_region_t flat[FLAT_REGIONS];
+  size_t n_flat;
+  reg_t flat_mask;
+  void refill_flat(reg_t paddr);
+
   // implement a TLB for simulator performance
   static const reg_t TLB_ENTRIES = 256;
   // If a TLB tag has TLB_CHECK_TRIGGERS set, then the MMU must check for a
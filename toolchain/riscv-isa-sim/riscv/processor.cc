@@ -8,6 +8,7 @@
 #include "simif.h"
 #include "mmu.h"
 #include "disasm.h"
+#include "timing.h"
 #include <cinttypes>
 #include <cmath>
 #include <cstdlib>
@@ -26,8 +27,9 @@ processor_t::processor_t(const char* isa, const char* priv, const char* varch,
                          FILE* log_file)
   : debug(false), halt_request(HR_NONE), sim(sim), ext(NULL), id(id), xlen(0),
   histogram_enabled(false), log_commits_enabled(false),
-  log_file(log_file), halt_on_reset(halt_on_reset),
-  extension_table(256, false), last_pc(1), executions(1)
+  log_file(log_file), commit_log(NULL), timing(NULL), snapshot_csr(-1),
+  halt_on_reset(halt_on_reset),
+  extension_table(256, false), pc_histogram_base(0), last_pc(1), executions(1)
 {
   VU.p = this;
 
@@ -50,15 +52,6 @@ processor_t::processor_t(const char* isa, const char* priv, const char* varch,
 
 processor_t::~processor_t()
 {
-#ifdef RISCV_ENABLE_HISTOGRAM
-  if (histogram_enabled)
-  {
-    fprintf(stderr, "PC Histogram size:%zu\n", pc_histogram.size());
-    for (auto it : pc_histogram)
-      fprintf(stderr, "%0" PRIx64 " %" PRIu64 "\n", it.first, it.second);
-  }
-#endif
-
   delete mmu;
   delete disassembler;
 }
@@ -320,6 +313,7 @@ void state_t::reset(reg_t max_isa)
   stvec = 0;
   satp = 0;
   scause = 0;
+  trace = 0;
   mtval2 = 0;
   mtinst = 0;
   hstatus = 0;
@@ -438,6 +432,33 @@ void processor_t::set_histogram(bool value)
 #endif
 }
 
+void processor_t::grow_histogram(reg_t pc)
+{
+  reg_t end = pc_histogram_base + 2 * pc_histogram.size();
+  reg_t new_base = std::min(pc, pc_histogram_base) & ~reg_t(PGSIZE - 1);
+  reg_t new_end = (std::max(pc + 2, end) + PGSIZE - 1) & ~reg_t(PGSIZE - 1);
+  if (new_end - new_base > HISTOGRAM_SPAN) {
+    pc_histogram_far[pc]++;
+    return;
+  }
+
+  std::vector<uint64_t> window((new_end - new_base) / 2);
+  std::copy(pc_histogram.begin(), pc_histogram.end(),
+            window.begin() + (pc_histogram_base - new_base) / 2);
+  window[(pc - new_base) / 2]++;
+  pc_histogram.swap(window);
+  pc_histogram_base = new_base;
+}
+
+std::map<reg_t, uint64_t> processor_t::get_histogram() const
+{
+  std::map<reg_t, uint64_t> histogram(pc_histogram_far);
+  for (size_t i = 0; i < pc_histogram.size(); i++)
+    if (pc_histogram[i])
+      histogram[pc_histogram_base + 2 * i] = pc_histogram[i];
+  return histogram;
+}
+
 #ifdef RISCV_ENABLE_COMMITLOG
 void processor_t::enable_log_commits()
 {
@@ -772,6 +793,12 @@ int processor_t::paddr_bits()
   return max_xlen == 64 ? 50 : 34;
 }
 
+reg_t processor_t::get_cycles()
+{
+  // Without a timing model, every instruction takes one cycle
+  return timing ? timing->get_mcycle() : state.minstret;
+}
+
 void processor_t::set_csr(int which, reg_t val)
 {
 #if defined(RISCV_ENABLE_COMMITLOG)
@@ -782,6 +809,11 @@ void processor_t::set_csr(int which, reg_t val)
 #endif
 
   val = zext_xlen(val);
+  if (unlikely(which == snapshot_csr && val != 0)) {
+    // Saved by the simulation once the quantum of the hart is over
+    snapshot_csr = -1;
+    sim->request_snapshot();
+  }
   reg_t supervisor_ints = supports_extension('S') ? MIP_SSIP | MIP_STIP | MIP_SEIP : 0;
   reg_t vssip_int = supports_extension('H') ? MIP_VSSIP : 0;
   reg_t hypervisor_ints = supports_extension('H') ? MIP_HS_MASK : 0;
@@ -917,8 +949,17 @@ void processor_t::set_csr(int which, reg_t val)
       state.medeleg = (state.medeleg & ~mask) | (val & mask);
       break;
     }
-    case CSR_MINSTRET:
     case CSR_MCYCLE:
+      if (timing) {
+        reg_t cycle = timing->get_mcycle();
+        if (xlen == 32)
+          timing->set_mcycle((cycle >> 32 << 32) | (val & 0xffffffffU));
+        else
+          timing->set_mcycle(val);
+        break;
+      }
+      // fallthrough
+    case CSR_MINSTRET:
       if (xlen == 32)
         state.minstret = (state.minstret >> 32 << 32) | (val & 0xffffffffU);
       else
@@ -929,8 +970,14 @@ void processor_t::set_csr(int which, reg_t val)
       // Correct for this artifact by decrementing instret here.
       state.minstret--;
       break;
-    case CSR_MINSTRETH:
     case CSR_MCYCLEH:
+      if (timing) {
+        reg_t cycle = timing->get_mcycle();
+        timing->set_mcycle((val << 32) | (cycle << 32 >> 32));
+        break;
+      }
+      // fallthrough
+    case CSR_MINSTRETH:
       state.minstret = (val << 32) | (state.minstret << 32 >> 32);
       state.minstret--; // See comment above.
       break;
@@ -1017,6 +1064,7 @@ void processor_t::set_csr(int which, reg_t val)
     case CSR_MEPC: state.mepc = val & ~(reg_t)1; break;
     case CSR_MTVEC: state.mtvec = val & ~(reg_t)2; break;
     case CSR_MSCRATCH: state.mscratch = val; break;
+    case CSR_TRACE: state.trace = val; break;
     case CSR_MCAUSE: state.mcause = val; break;
     case CSR_MTVAL: state.mtval = val; break;
     case CSR_MTVAL2: state.mtval2 = val; break;
@@ -1383,7 +1431,7 @@ reg_t processor_t::get_csr(int which, insn_t insn, bool write, bool peek)
     case CSR_INSTRET:
     case CSR_CYCLE:
       if (ctr_ok)
-        ret(state.minstret);
+        ret(which == CSR_CYCLE ? get_cycles() : state.minstret);
       if (state.v &&
           ((state.mcounteren >> (which & 31)) & 1) &&
           !((state.hcounteren >> (which & 31)) & 1)) {
@@ -1391,12 +1439,13 @@ reg_t processor_t::get_csr(int which, insn_t insn, bool write, bool peek)
       }
       break;
     case CSR_MINSTRET:
-    case CSR_MCYCLE:
       ret(state.minstret);
+    case CSR_MCYCLE:
+      ret(get_cycles());
     case CSR_INSTRETH:
     case CSR_CYCLEH:
       if (ctr_ok && xlen == 32)
-        ret(state.minstret >> 32);
+        ret((which == CSR_CYCLEH ? get_cycles() : state.minstret) >> 32);
       if (state.v &&
           ((state.mcounteren >> (which & 31)) & 1) &&
           !((state.hcounteren >> (which & 31)) & 1)) {
@@ -1406,7 +1455,7 @@ reg_t processor_t::get_csr(int which, insn_t insn, bool write, bool peek)
     case CSR_MINSTRETH:
     case CSR_MCYCLEH:
       if (xlen == 32)
-        ret(state.minstret >> 32);
+        ret((which == CSR_MCYCLEH ? get_cycles() : state.minstret) >> 32);
       break;
     case CSR_SCOUNTEREN: ret(state.scounteren);
     case CSR_MCOUNTEREN:
@@ -1493,6 +1542,7 @@ reg_t processor_t::get_csr(int which, insn_t insn, bool write, bool peek)
     case CSR_MIE: ret(state.mie);
     case CSR_MEPC: ret(state.mepc & pc_alignment_mask());
     case CSR_MSCRATCH: ret(state.mscratch);
+    case CSR_TRACE: ret(state.trace);
     case CSR_MCAUSE: ret(state.mcause);
     case CSR_MTVAL: ret(state.mtval);
     case CSR_MTVAL2:
@@ -14,6 +14,8 @@
 #include "debug_rom_defines.h"
 
 class processor_t;
+class timing_model_t;
+class commit_log_buffer_t;
 class mmu_t;
 typedef reg_t (*insn_func_t)(processor_t*, insn_t, reg_t);
 class simif_t;
@@ -181,6 +183,7 @@ struct state_t
   reg_t stvec;
   reg_t satp;
   reg_t scause;
+  reg_t trace; // MemPool's trace CSR, set around the benchmarked region
 
   reg_t mtval2;
   reg_t mtinst;
@@ -265,10 +268,19 @@ public:
 
   void set_debug(bool value);
   void set_histogram(bool value);
+  // Anchor the histogram at the program, e.g. at its entry point
+  void set_histogram_base(reg_t pc) {
+    pc_histogram_base = max_xlen == 32 ? (reg_t)(int32_t)pc : pc;
+  }
+  // The instructions executed at each PC
+  std::map<reg_t, uint64_t> get_histogram() const;
 #ifdef RISCV_ENABLE_COMMITLOG
   void enable_log_commits();
   bool get_log_commits_enabled() const { return log_commits_enabled; }
 #endif
+  // Log the commits in binary to the buffer instead of in text to the log file
+  void set_commit_log(commit_log_buffer_t* log) { commit_log = log; }
+  commit_log_buffer_t* get_commit_log() { return commit_log; }
   void reset();
   void step(size_t n); // run for n cycles
   void set_csr(int which, reg_t val);
@@ -306,6 +318,11 @@ public:
 
   FILE *get_log_file() { return log_file; }
 
+  void set_timing(timing_model_t* t) { timing = t; }
+  timing_model_t* get_timing() { return timing; }
+  // Ask the simulation for a snapshot at the first non-zero write to csr
+  void set_snapshot_csr(int csr) { snapshot_csr = csr; }
+
   void register_insn(insn_desc_t);
   void register_extension(extension_t*);
 
@@ -425,12 +442,22 @@ private:
   bool histogram_enabled;
   bool log_commits_enabled;
   FILE *log_file;
+  commit_log_buffer_t* commit_log;
+  timing_model_t* timing; // optional cycle-approximate timing model
+  int snapshot_csr;
   bool halt_on_reset;
   std::vector<bool> extension_table;
   
 
   std::vector<insn_desc_t> instructions;
-  std::map<reg_t,uint64_t> pc_histogram;
+  // Instructions executed at each PC: a flat window of 2-byte parcels around
+  // the program, grown on demand up to HISTOGRAM_SPAN bytes, and a map of the
+  // PCs outside of it, e.g. the boot ROM
+  static const reg_t HISTOGRAM_SPAN = 16 << 20;
+  std::vector<uint64_t> pc_histogram;
+  reg_t pc_histogram_base;
+  std::map<reg_t,uint64_t> pc_histogram_far;
+  void grow_histogram(reg_t pc);
 
   static const size_t OPCODE_CACHE_SIZE = 8191;
   insn_desc_t opcode_cache[OPCODE_CACHE_SIZE];
@@ -440,6 +467,7 @@ private:
   void take_trap(trap_t& t, reg_t epc); // take an exception
   void disasm(insn_t insn); // disassemble and print an instruction
   int paddr_bits();
+  reg_t get_cycles(); // mcycle, from the timing model if there is one
 
   reg_t pmp_tor_mask() { return -(reg_t(1) << (lg_pmp_granularity - PMP_SHIFT)); }
 
@@ -2,6 +2,7 @@
 
 #include "sim.h"
 #include "mmu.h"
+#include "timing.h"
 #include "dts.h"
 #include "remote_bitbang.h"
 #include "byteorder.h"
@@ -10,6 +11,8 @@
 #include <iostream>
 #include <sstream>
 #include <climits>
+#include <cinttypes>
+#include <algorithm>
 #include <cstdlib>
 #include <cassert>
 #include <signal.h>
@@ -49,10 +52,12 @@ sim_t::sim_t(const char* isa, const char* priv, const char* varch,
     log_file(log_path),
     current_step(0),
     current_proc(0),
+    timing_cycle(0),
     debug(false),
     histogram_enabled(false),
     log(false),
     remote_bitbang(NULL),
+    snapshot_pending(false),
     debug_module(this, dm_config)
 {
   signal(SIGINT, &handle_signal);
@@ -103,6 +108,8 @@ sim_t::sim_t(const char* isa, const char* priv, const char* varch,
 
 sim_t::~sim_t()
 {
+  if (histogram_enabled)
+    print_histogram();
   for (size_t i = 0; i < procs.size(); i++)
     delete procs[i];
   delete debug_mmu;
@@ -139,13 +146,17 @@ int sim_t::run()
 
 void sim_t::step(size_t n)
 {
+  if (procs[0]->get_timing())
+    return step_timed(n);
+
   for (size_t i = 0, steps = 0; i < n; i += steps)
   {
     steps = std::min(n - i, INTERLEAVE - current_step);
     procs[current_proc]->step(steps);
 
     current_step += steps;
-    if (current_step == INTERLEAVE)
+    bool yield = current_step == INTERLEAVE;
+    if (yield)
     {
       current_step = 0;
       procs[current_proc]->get_mmu()->yield_load_reservation();
@@ -153,10 +164,48 @@ void sim_t::step(size_t n)
         current_proc = 0;
         clint->increment(INTERLEAVE / INSNS_PER_RTC_TICK);
       }
+    }
 
+    // Once the interleaving has moved past the quantum of the write of the
+    // CSR, so that a restored run continues it the same way
+    if (unlikely(snapshot_pending))
+      save_snapshot();
+    if (yield)
       host->switch_to();
+  }
+}
+
+void sim_t::step_timed(size_t n)
+{
+  // Every hart runs up to the end of the quantum before the next one starts,
+  // so that the accesses of all the harts to the shared L1 banks are
+  // arbitrated in the same window of cycles. The first hart of each quantum
+  // rotates, so that it does not always win the arbitration.
+  for (size_t i = 0; i < n; i += TIMING_QUANTUM)
+  {
+    size_t first = (timing_cycle / TIMING_QUANTUM) % procs.size();
+    timing_cycle += TIMING_QUANTUM;
+    for (size_t j = 0; j < procs.size(); j++)
+    {
+      processor_t* p = procs[(first + j) % procs.size()];
+      timing_model_t* timing = p->get_timing();
+      while (timing->get_cycle() < timing_cycle)
+      {
+        // Each instruction takes at least one cycle
+        uint64_t cycle = timing->get_cycle();
+        p->step(timing_cycle - cycle);
+        if (timing->get_cycle() == cycle)
+          timing->stall_until(cycle + 1);
+      }
+      p->get_mmu()->yield_load_reservation();
     }
   }
+
+  clint->increment(n / INSNS_PER_RTC_TICK);
+  // At the end of the quanta, where a restored run starts the next ones
+  if (unlikely(snapshot_pending))
+    save_snapshot();
+  host->switch_to();
 }
 
 void sim_t::set_debug(bool value)
@@ -172,6 +221,60 @@ void sim_t::set_histogram(bool value)
   }
 }
 
+static void print_profile(const std::string& title,
+                          const std::map<std::string, uint64_t>& profile)
+{
+  std::vector<std::pair<uint64_t, std::string>> functions;
+  uint64_t total = 0;
+  for (auto& it : profile) {
+    functions.emplace_back(it.second, it.first);
+    total += it.second;
+  }
+  std::sort(functions.rbegin(), functions.rend());
+
+  fprintf(stderr, "%s: %" PRIu64 " instructions\n", title.c_str(), total);
+  for (auto& it : functions)
+    fprintf(stderr, "%16" PRIu64 " %6.2f%%  %s\n", it.first,
+            100.0 * it.first / total, it.second.c_str());
+}
+
+void sim_t::print_histogram()
+{
+  // The instructions of each function, named after the closest symbol at or
+  // before their PCs
+  std::vector<std::map<std::string, uint64_t>> profiles(procs.size());
+  std::map<std::string, uint64_t> profile;
+  for (size_t i = 0; i < procs.size(); i++) {
+    // The PCs of rv32 harts are sign-extended, unlike the ELF symbols
+    reg_t mask = procs[i]->get_max_xlen() == 32 ? 0xffffffff : -1;
+    for (auto& it : procs[i]->get_histogram()) {
+      const char* symbol = get_nearest_symbol(it.first & mask);
+      std::string function = symbol ? symbol : "[unknown]";
+      profiles[i][function] += it.second;
+      profile[function] += it.second;
+    }
+  }
+
+  print_profile("PC histogram", profile);
+  for (size_t i = 0; procs.size() > 1 && i < procs.size(); i++)
+    print_profile("PC histogram of hart " +
+                  std::to_string(procs[i]->get_csr(CSR_MHARTID)), profiles[i]);
+
+  if (histogram_folded.empty())
+    return;
+  FILE* folded = fopen(histogram_folded.c_str(), "w");
+  if (!folded) {
+    fprintf(stderr, "can't open %s\n", histogram_folded.c_str());
+    return;
+  }
+  for (size_t i = 0; i < procs.size(); i++)
+    for (auto& it : profiles[i])
+      fprintf(folded, "hart%" PRIu64 ";%s %" PRIu64 "\n",
+              (uint64_t)procs[i]->get_csr(CSR_MHARTID), it.first.c_str(),
+              it.second);
+  fclose(folded);
+}
+
 void sim_t::configure_log(bool enable_log, bool enable_commitlog)
 {
   log = enable_log;
@@ -259,29 +362,17 @@ void sim_t::set_rom()
 
   std::vector<char> rom((char*)reset_vec, (char*)reset_vec + sizeof(reset_vec));
 
-  std::string dtb;
-  if (!dtb_file.empty()) {
-    std::ifstream fin(dtb_file.c_str(), std::ios::binary);
-    if (!fin.good()) {
-      std::cerr << "can't find dtb file: " << dtb_file << std::endl;
-      exit(-1);
-    }
-
-    std::stringstream strstream;
-    strstream << fin.rdbuf();
-
-    dtb = strstream.str();
-  } else {
-    dts = make_dts(INSNS_PER_RTC_TICK, CPU_HZ, initrd_start, initrd_end, bootargs, procs, mems);
-    dtb = dts_compile(dts);
-  }
-
+  // The device tree blob was compiled once by make_dtb()
   rom.insert(rom.end(), dtb.begin(), dtb.end());
   const int align = 0x1000;
   rom.resize((rom.size() + align - 1) / align * align);
 
   boot_rom.reset(new rom_device_t(rom));
   bus.add_device(DEFAULT_RSTVEC, boot_rom.get());
+
+  // The MMUs may still access the previous boot ROM directly
+  for (auto p : procs)
+    p->get_mmu()->flush_tlb();
 }
 
 char* sim_t::addr_to_mem(reg_t addr) {
@@ -294,6 +385,31 @@ char* sim_t::addr_to_mem(reg_t addr) {
   return NULL;
 }
 
+bool sim_t::addr_to_region(reg_t addr, mem_region_t* region) {
+  if (!paddr_ok(addr))
+    return false;
+  auto desc = bus.find_device(addr);
+  if (auto mem = dynamic_cast<mem_t*>(desc.second)) {
+    *region = {desc.first, mem->size(), mem->contents(), true};
+  } else if (desc.second && desc.second == boot_rom.get()) {
+    auto& rom = boot_rom->contents();
+    *region = {desc.first, rom.size(), (char*)rom.data(), false};
+  } else {
+    return false;
+  }
+
+  // A device mapped inside the region, or the end of the physical address
+  // space, cuts the region short
+  reg_t end = region->base + region->size;
+  reg_t next = bus.next_device_base(addr);
+  if (next && next < end)
+    end = next;
+  if (!paddr_ok(end - 1))
+    end = reg_t(1) << MAX_PADDR_BITS;
+  region->size = end - region->base;
+  return addr - region->base < region->size;
+}
+
 const char* sim_t::get_symbol(uint64_t addr)
 {
   return htif_t::get_symbol(addr);
@@ -303,8 +419,13 @@ const char* sim_t::get_symbol(uint64_t addr)
 
 void sim_t::reset()
 {
+  if (histogram_enabled)
+    for (auto p : procs)
+      p->set_histogram_base(start_pc == reg_t(-1) ? get_entry_point() : start_pc);
   if (dtb_enabled)
     set_rom();
+  if (!restore_path.empty())
+    restore_snapshot();
 }
 
 void sim_t::idle()
@@ -331,3 +452,10 @@ void sim_t::proc_reset(unsigned id)
 {
   debug_module.proc_reset(id);
 }
+
+void sim_t::set_snapshot(const char* path, int csr)
+{
+  snapshot_path = path;
+  for (auto p : procs)
+    p->set_snapshot_csr(csr);
+}
@@ -35,8 +35,15 @@ public:
 
   // run the simulation to completion
   int run();
+  // Run each program of the list file, one per line with its arguments, in a
+  // copy-on-write fork of this simulation, up to jobs at a time. Write the
+  // exit code, instructions and wall time of each one to csv ("-": stdout).
+  // implemented in batch.cc
+  int run_batch(const char* list, const char* csv, size_t jobs);
   void set_debug(bool value);
   void set_histogram(bool value);
+  // Write the PC histogram as folded stacks "hart;function count" to path
+  void set_histogram_folded(const char* path) { histogram_folded = path; }
 
   // Configure logging
   //
@@ -57,6 +64,16 @@ public:
   // Callback for processors to let the simulation know they were reset.
   void proc_reset(unsigned id);
 
+  // Save the whole simulation to path at the first non-zero write of any
+  // hart to csr, e.g. when mempool_start_benchmark() sets the trace CSR.
+  // It is saved at the end of the quantum of the write (of the quanta under
+  // the timing models), so that a restored run interleaves the harts as an
+  // uninterrupted one does.
+  void set_snapshot(const char* path, int csr);
+  // Start from the snapshot at path instead of from reset
+  void set_restore(const char* path) { restore_path = path; }
+  void request_snapshot() { snapshot_pending = true; }
+
 private:
   std::vector<std::pair<reg_t, mem_t*>> mems;
   std::vector<std::pair<reg_t, abstract_device_t*>> plugin_devices;
@@ -77,22 +94,35 @@ private:
 
   processor_t* get_core(const std::string& i);
   void step(size_t n); // step through simulation
+  void step_timed(size_t n); // step through n cycles of the timing models
   static const size_t INTERLEAVE = 5000;
+  static const size_t TIMING_QUANTUM = 32; // cycles between hart switches
   static const size_t INSNS_PER_RTC_TICK = 100; // 10 MHz clock for 1 BIPS core
   static const size_t CPU_HZ = 1000000000; // 1GHz CPU
   size_t current_step;
   size_t current_proc;
+  uint64_t timing_cycle; // end of the current quantum of the timing models
   bool debug;
   bool histogram_enabled; // provide a histogram of PCs
+  std::string histogram_folded;
   bool log;
   remote_bitbang_t* remote_bitbang;
+  std::string snapshot_path;
+  bool snapshot_pending;
+  std::string restore_path;
+
+  // implemented in snapshot.cc
+  void save_snapshot();
+  void restore_snapshot();
 
   // memory-mapped I/O routines
   char* addr_to_mem(reg_t addr);
+  bool addr_to_region(reg_t addr, mem_region_t* region);
   bool mmio_load(reg_t addr, size_t len, uint8_t* bytes);
   bool mmio_store(reg_t addr, size_t len, const uint8_t* bytes);
   void make_dtb();
   void set_rom();
+  void print_histogram();
 
   const char* get_symbol(uint64_t addr);
 
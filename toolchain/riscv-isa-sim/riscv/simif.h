@@ -5,17 +5,29 @@
 
 #include "decode.h"
 
+// a range of physical addresses backed by host memory
+struct mem_region_t {
+  reg_t base;
+  reg_t size;
+  char* host;
+  bool writable;
+};
+
 // this is the interface to the simulator used by the processors and memory
 class simif_t
 {
 public:
   // should return NULL for MMIO addresses
   virtual char* addr_to_mem(reg_t addr) = 0;
+  // should return false for MMIO addresses, else the region holding addr
+  virtual bool addr_to_region(reg_t addr, mem_region_t* region) = 0;
   // used for MMIO addresses
   virtual bool mmio_load(reg_t addr, size_t len, uint8_t* bytes) = 0;
   virtual bool mmio_store(reg_t addr, size_t len, const uint8_t* bytes) = 0;
   // Callback for processors to let the simulation know they were reset.
   virtual void proc_reset(unsigned id) = 0;
+  // Callback for processors to have the simulation saved after their step.
+  virtual void request_snapshot() = 0;
 
   virtual const char* get_symbol(uint64_t addr) = 0;
 
@@ -0,0 +1,237 @@
+// See LICENSE for license details.
+
+#include "sim.h"
+#include "mmu.h"
+#include "timing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// A snapshot holds a header, the state of the harts and of their timing
+// models, of the CLINT, of the interleaving of the harts and of the bank
+// arbiter, a table of the memories, and the page-aligned images of the
+// memories. The images are mapped copy-on-write at restore, so that many runs
+// can start from the same snapshot without reading it.
+static const char SNAPSHOT_MAGIC[8] = {'S', 'P', 'I', 'K', 'E', 'S', 'N', '2'};
+
+// The architectural state of a hart that the snapshots hold
+#define SNAPSHOT_STATE(F) \
+  F(pc) F(XPR) F(FPR) F(prv) F(v) F(misa) F(mstatus) F(mepc) F(mtval) \
+  F(mscratch) F(mtvec) F(mcause) F(minstret) F(mie) F(mip) F(medeleg) \
+  F(mideleg) F(mcounteren) F(scounteren) F(sepc) F(stval) F(sscratch) \
+  F(stvec) F(satp) F(scause) F(trace) F(mtval2) F(mtinst) F(hstatus) \
+  F(hideleg) F(hedeleg) F(hcounteren) F(htval) F(htinst) F(hgatp) \
+  F(vsstatus) F(vstvec) F(vsscratch) F(vsepc) F(vscause) F(vstval) \
+  F(vsatp) F(dpc) F(dscratch0) F(dscratch1) F(dcsr) F(tselect) \
+  F(mcontrol) F(tdata2) F(debug_mode) F(pmpcfg) F(pmpaddr) F(fflags) \
+  F(frm) F(serialized) F(single_step)
+
+// The state of the timing model of a hart that the snapshots hold
+#define SNAPSHOT_TIMING(F) \
+  F(cycle) F(mcycle_offset) F(ready) F(div_free) F(fdiv_free) F(instret) \
+  F(raw_stalls) F(unit_stalls) F(bank_conflicts) F(branch_cycles) \
+  F(idle_cycles)
+
+static void snapshot_error(const std::string& path, const char* what)
+{
+  fprintf(stderr, "snapshot %s: %s\n", path.c_str(), what);
+  exit(1);
+}
+
+static void put(std::vector<char>& buf, const void* data, size_t len)
+{
+  buf.insert(buf.end(), (const char*)data, (const char*)data + len);
+}
+
+static void put64(std::vector<char>& buf, uint64_t val)
+{
+  put(buf, &val, sizeof(val));
+}
+
+// Reads the header of a snapshot back, in the order it was put
+struct snapshot_reader_t
+{
+  const std::vector<char>& buf;
+  const std::string& path;
+  size_t pos;
+
+  void get(void* data, size_t len)
+  {
+    if (pos + len > buf.size())
+      snapshot_error(path, "truncated");
+    memcpy(data, &buf[pos], len);
+    pos += len;
+  }
+
+  uint64_t get64()
+  {
+    uint64_t val;
+    get(&val, sizeof(val));
+    return val;
+  }
+};
+
+static size_t page_align(size_t offset)
+{
+  return (offset + PGSIZE - 1) & ~size_t(PGSIZE - 1);
+}
+
+void sim_t::save_snapshot()
+{
+  // Only the first write of any hart to the CSR
+  snapshot_pending = false;
+  for (auto p : procs)
+    p->set_snapshot_csr(-1);
+
+  timing_model_t* timed = procs[0]->get_timing();
+  std::vector<char> header;
+  put(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  put64(header, procs.size());
+  put64(header, mems.size());
+  put64(header, timed != NULL);
+
+  for (size_t i = 0; i < procs.size(); i++) {
+    processor_t* p = procs[i];
+    state_t* state = p->get_state();
+    #define SAVE_FIELD(field) put(header, &state->field, sizeof(state->field));
+    SNAPSHOT_STATE(SAVE_FIELD)
+    #undef SAVE_FIELD
+    if (timing_model_t* timing = p->get_timing()) {
+      #define SAVE_TIMING(field) put(header, &timing->field, sizeof(timing->field));
+      SNAPSHOT_TIMING(SAVE_TIMING)
+      #undef SAVE_TIMING
+    }
+    put64(header, clint->get_mtimecmp(i));
+  }
+  put64(header, clint->get_mtime());
+  put64(header, current_step);
+  put64(header, current_proc);
+  put64(header, timing_cycle);
+  if (timed) {
+    std::vector<uint64_t>& granted = timed->arbiter->granted;
+    put64(header, granted.size());
+    put(header, granted.data(), granted.size() * sizeof(granted[0]));
+  }
+
+  // The images follow the table of the memories, each one page-aligned
+  size_t offset = page_align(header.size() + mems.size() * 3 * sizeof(uint64_t));
+  std::vector<size_t> offsets;
+  for (auto& m : mems) {
+    put64(header, m.first);
+    put64(header, m.second->size());
+    put64(header, offset);
+    offsets.push_back(offset);
+    offset = page_align(offset + m.second->size());
+  }
+
+  int fd = open(snapshot_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    snapshot_error(snapshot_path, strerror(errno));
+  bool ok = pwrite(fd, header.data(), header.size(), 0) == (ssize_t)header.size();
+
+  // Pages of zeros are left as holes of the file
+  for (size_t i = 0; i < mems.size() && ok; i++) {
+    const char* data = mems[i].second->contents();
+    size_t size = mems[i].second->size();
+    static const char zeros[PGSIZE] = {};
+    for (size_t p = 0; p < size && ok; p += PGSIZE) {
+      size_t len = std::min(size - p, size_t(PGSIZE));
+      if (memcmp(data + p, zeros, len) != 0)
+        ok = pwrite(fd, data + p, len, offsets[i] + p) == (ssize_t)len;
+    }
+  }
+  ok = ok && ftruncate(fd, offset) == 0;
+  if (close(fd) != 0 || !ok)
+    snapshot_error(snapshot_path, strerror(errno));
+
+  fprintf(stderr, "Saved snapshot %s after %" PRIu64 " instructions of hart 0\n",
+          snapshot_path.c_str(), (uint64_t)procs[0]->get_state()->minstret);
+}
+
+void sim_t::restore_snapshot()
+{
+  int fd = open(restore_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    snapshot_error(restore_path, strerror(errno));
+  off_t file_size = lseek(fd, 0, SEEK_END);
+  size_t state_size = 0;
+  #define STATE_SIZE(field) state_size += sizeof(((state_t*)0)->field);
+  SNAPSHOT_STATE(STATE_SIZE)
+  #undef STATE_SIZE
+  timing_model_t* timed = procs[0]->get_timing();
+  size_t timing_size = 0;
+  size_t arbiter_size = 0;
+  if (timed) {
+    #define TIMING_SIZE(field) timing_size += sizeof(((timing_model_t*)0)->field);
+    SNAPSHOT_TIMING(TIMING_SIZE)
+    #undef TIMING_SIZE
+    arbiter_size = (1 + timed->arbiter->granted.size()) * sizeof(uint64_t);
+  }
+  size_t header_size = sizeof(SNAPSHOT_MAGIC) + 3 * sizeof(uint64_t) +
+    procs.size() * (state_size + timing_size + sizeof(uint64_t)) +
+    4 * sizeof(uint64_t) + arbiter_size + mems.size() * 3 * sizeof(uint64_t);
+  std::vector<char> header(std::min<size_t>(header_size, file_size));
+  if (pread(fd, header.data(), header.size(), 0) != (ssize_t)header.size())
+    snapshot_error(restore_path, strerror(errno));
+
+  snapshot_reader_t in = {header, restore_path, 0};
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  in.get(magic, sizeof(magic));
+  if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0)
+    snapshot_error(restore_path, "not a snapshot of this version of Spike");
+  if (in.get64() != procs.size() || in.get64() != mems.size())
+    snapshot_error(restore_path, "taken with another number of harts or memories");
+  if (in.get64() != (timed != NULL))
+    snapshot_error(restore_path, timed ? "taken without the timing model"
+                                       : "taken with the timing model");
+
+  for (size_t i = 0; i < procs.size(); i++) {
+    processor_t* p = procs[i];
+    state_t* state = p->get_state();
+    #define RESTORE_FIELD(field) in.get(&state->field, sizeof(state->field));
+    SNAPSHOT_STATE(RESTORE_FIELD)
+    #undef RESTORE_FIELD
+    if (timing_model_t* timing = p->get_timing()) {
+      #define RESTORE_TIMING(field) in.get(&timing->field, sizeof(timing->field));
+      SNAPSHOT_TIMING(RESTORE_TIMING)
+      #undef RESTORE_TIMING
+    }
+    clint->set_mtimecmp(i, in.get64());
+    p->get_mmu()->yield_load_reservation();
+  }
+  clint->set_mtime(in.get64());
+  current_step = in.get64();
+  current_proc = in.get64();
+  timing_cycle = in.get64();
+  if (timed) {
+    std::vector<uint64_t>& granted = timed->arbiter->granted;
+    if (in.get64() != granted.size())
+      snapshot_error(restore_path, "taken with another number of banks");
+    in.get(granted.data(), granted.size() * sizeof(granted[0]));
+  }
+
+  for (auto& m : mems) {
+    reg_t base = in.get64();
+    reg_t size = in.get64();
+    reg_t offset = in.get64();
+    if (base != m.first || size != m.second->size())
+      snapshot_error(restore_path, "taken with another memory map");
+    if (offset + size > (reg_t)file_size)
+      snapshot_error(restore_path, "truncated");
+    void* data = mmap(m.second->contents(), size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_FIXED, fd, offset);
+    if (data == MAP_FAILED)
+      snapshot_error(restore_path, strerror(errno));
+  }
+  close(fd);
+
+  // The translations and the decoded instructions are stale
+  for (auto p : procs)
+    p->get_mmu()->flush_tlb();
+}
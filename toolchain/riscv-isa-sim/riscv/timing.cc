@@ -0,0 +1,375 @@
+// See LICENSE for license details.
+
+#include "timing.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+
+static void help()
+{
+  std::cerr << "Timing configurations must be of the form" << std::endl;
+  std::cerr << "  key=value,key=value,..." << std::endl;
+  std::cerr << "or \"default\", with the keys" << std::endl;
+  std::cerr << "  l1_base, num_cores, num_groups, cores_per_tile, banking_factor," << std::endl;
+  std::cerr << "  l1_bank_size, seq_mem_size (memory map of the L1)," << std::endl;
+  std::cerr << "  tile, group, remote_group, l2 (load latencies)," << std::endl;
+  std::cerr << "  alu, mul, div, fpu, fconv, fdiv (result latencies)," << std::endl;
+  std::cerr << "  branch (penalty of taken branches and jumps)." << std::endl;
+  exit(1);
+}
+
+timing_config_t::timing_config_t(const char* config)
+{
+  const std::pair<const char*, reg_t*> keys[] = {
+    {"l1_base", &l1_base},
+    {"num_cores", &num_cores},
+    {"num_groups", &num_groups},
+    {"cores_per_tile", &cores_per_tile},
+    {"banking_factor", &banking_factor},
+    {"l1_bank_size", &l1_bank_size},
+    {"seq_mem_size", &seq_mem_size},
+    {"tile", &tile},
+    {"group", &group},
+    {"remote_group", &remote_group},
+    {"l2", &l2},
+    {"alu", &alu},
+    {"mul", &mul},
+    {"div", &div},
+    {"fpu", &fpu},
+    {"fconv", &fconv},
+    {"fdiv", &fdiv},
+    {"branch", &branch},
+  };
+
+  std::stringstream stream(config && strcmp(config, "default") ? config : "");
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    size_t eq = item.find('=');
+    if (eq == std::string::npos)
+      help();
+    std::string key = item.substr(0, eq);
+    std::string val = item.substr(eq + 1);
+    char* end;
+    reg_t value = strtoull(val.c_str(), &end, 0);
+    if (val.empty() || *end)
+      help();
+    auto it = std::find_if(std::begin(keys), std::end(keys),
+      [&](const std::pair<const char*, reg_t*>& k){ return key == k.first; });
+    if (it == std::end(keys))
+      help();
+    *it->second = value;
+  }
+
+  if (num_cores == 0 || cores_per_tile == 0 || banking_factor == 0 ||
+      num_groups == 0 || num_cores % (cores_per_tile * num_groups))
+    help();
+}
+
+reg_t timing_config_t::bank(reg_t addr) const
+{
+  reg_t offset = addr - l1_base;
+  if (addr < l1_base || offset >= l1_size())
+    return num_banks();
+
+  // The first seq_mem_size bytes of each core are interleaved over the banks
+  // of its tile, the rest of the L1 over all the banks
+  reg_t tile_banks = cores_per_tile * banking_factor;
+  reg_t tile_seq = seq_mem_size * cores_per_tile;
+  if (offset < seq_mem_size * num_cores)
+    return offset / tile_seq * tile_banks + (offset >> 2) % tile_banks;
+  return (offset >> 2) % num_banks();
+}
+
+bank_arbiter_t::bank_arbiter_t(size_t num_banks)
+  : granted(num_banks * WINDOW, UINT64_MAX)
+{
+}
+
+uint64_t bank_arbiter_t::grant(size_t bank, uint64_t t)
+{
+  uint64_t* slots = &granted[bank * WINDOW];
+  for (uint64_t s = t; s < t + WINDOW; s++) {
+    if (slots[s % WINDOW] != s) {
+      slots[s % WINDOW] = s;
+      return s;
+    }
+  }
+  return t + WINDOW;
+}
+
+timing_model_t::timing_model_t(const timing_config_t& config,
+                               bank_arbiter_t* arbiter, reg_t hartid)
+  : config(config), arbiter(arbiter), hartid(hartid),
+    tile(hartid / config.cores_per_tile),
+    group(hartid / (config.num_cores / config.num_groups)),
+    cycle(0), mcycle_offset(0), ready(), div_free(0), fdiv_free(0),
+    access_addr(0), access_valid(false), instret(0), raw_stalls(0),
+    unit_stalls(0), bank_conflicts(0), branch_cycles(0), idle_cycles(0)
+{
+}
+
+timing_model_t::~timing_model_t()
+{
+  print_stats();
+}
+
+void timing_model_t::print_stats()
+{
+  if (instret == 0)
+    return;
+
+  std::string name = "hart" + std::to_string(hartid);
+  std::cout << std::setprecision(3) << std::fixed;
+  std::cout << name << " ";
+  std::cout << "Cycles:                " << cycle << std::endl;
+  std::cout << name << " ";
+  std::cout << "Instructions:          " << instret << std::endl;
+  std::cout << name << " ";
+  std::cout << "IPC:                   " << float(instret) / cycle << std::endl;
+  std::cout << name << " ";
+  std::cout << "RAW Stalls:            " << raw_stalls << std::endl;
+  std::cout << name << " ";
+  std::cout << "Unit Stalls:           " << unit_stalls << std::endl;
+  std::cout << name << " ";
+  std::cout << "Bank Conflicts:        " << bank_conflicts << std::endl;
+  std::cout << name << " ";
+  std::cout << "Branch Penalties:      " << branch_cycles << std::endl;
+  std::cout << name << " ";
+  std::cout << "Idle Cycles:           " << idle_cycles << std::endl;
+}
+
+reg_t timing_model_t::mem_latency(reg_t addr, uint64_t issue)
+{
+  reg_t bank = config.bank(addr);
+  if (bank == config.num_banks())
+    return config.l2;
+
+  reg_t bank_tile = config.bank_tile(bank);
+  reg_t tiles_per_group = config.num_cores / config.cores_per_tile /
+                          config.num_groups;
+  reg_t latency = bank_tile == tile ? config.tile :
+                  bank_tile / tiles_per_group == group ? config.group :
+                  config.remote_group;
+
+  // The request reaches the bank halfway through the round trip
+  uint64_t arrival = issue + latency / 2;
+  uint64_t conflict = arbiter->grant(bank, arrival) - arrival;
+  bank_conflicts += conflict;
+  return latency + conflict;
+}
+
+void timing_model_t::retire(insn_t insn, reg_t pc, reg_t npc)
+{
+  // Registers read and written by the instruction, FREG + i is register fi
+  size_t src[4];
+  size_t nsrc = 0;
+  size_t rd = 0;
+  bool writes_rs1 = false;
+  bool mem = false;
+  bool store = false;
+  uint64_t* unit = NULL;
+  reg_t latency = config.alu;
+
+  uint64_t bits = insn.bits();
+  uint64_t funct3 = (bits >> 12) & 7;
+  uint64_t funct7 = bits >> 25;
+
+  // MemPool's cores do not implement the C extension, so compressed
+  // instructions are charged one cycle without tracking their operands
+  if (insn.length() == 4) {
+    switch (bits & 0x7f) {
+      case 0x37: // lui
+      case 0x17: // auipc
+      case 0x6f: // jal
+        rd = insn.rd();
+        break;
+      case 0x67: // jalr
+      case 0x13: // op-imm
+      case 0x1b: // op-imm-32
+        rd = insn.rd();
+        src[nsrc++] = insn.rs1();
+        break;
+      case 0x73: // system
+        rd = insn.rd();
+        if (funct3 == 1 || funct3 == 2 || funct3 == 3)
+          src[nsrc++] = insn.rs1();
+        break;
+      case 0x63: // branches, p.beqimm and p.bneimm compare with an immediate
+        src[nsrc++] = insn.rs1();
+        if (funct3 != 2 && funct3 != 3)
+          src[nsrc++] = insn.rs2();
+        break;
+      case 0x0b: // post-increment loads
+        writes_rs1 = true;
+        // fallthrough
+      case 0x03: // loads, funct3 7 is register-register
+        rd = insn.rd();
+        src[nsrc++] = insn.rs1();
+        if (funct3 == 7)
+          src[nsrc++] = insn.rs2();
+        mem = true;
+        break;
+      case 0x2b: // post-increment stores
+        writes_rs1 = true;
+        // fallthrough
+      case 0x23: // stores, funct3 4 to 6 are register-register
+        src[nsrc++] = insn.rs1();
+        src[nsrc++] = insn.rs2();
+        if (funct3 >= 4)
+          src[nsrc++] = insn.rd();
+        mem = store = true;
+        break;
+      case 0x2f: // atomics
+        rd = insn.rd();
+        src[nsrc++] = insn.rs1();
+        src[nsrc++] = insn.rs2();
+        mem = true;
+        break;
+      case 0x33: // op, with the Xpulpimg multiply-accumulate and insert
+      case 0x3b: // op-32
+        rd = insn.rd();
+        src[nsrc++] = insn.rs1();
+        src[nsrc++] = insn.rs2();
+        if (funct7 == 1 && funct3 >= 4) {
+          latency = config.div;
+          unit = &div_free;
+        } else if (funct7 == 1) {
+          latency = config.mul;
+        } else if (funct7 == 0x21) {
+          latency = config.mul;
+          src[nsrc++] = insn.rd();
+        } else if ((funct7 == 0x40 || funct7 == 0x60) && funct3 == 2) {
+          src[nsrc++] = insn.rd();
+        }
+        break;
+      case 0x5b: // p.addn and p.subn
+        rd = insn.rd();
+        src[nsrc++] = insn.rs1();
+        src[nsrc++] = insn.rs2();
+        break;
+      case 0x57: { // Xpulpimg SIMD, dot-products run on the multiplier
+        uint64_t funct6 = bits >> 26;
+        rd = insn.rd();
+        src[nsrc++] = insn.rs1();
+        src[nsrc++] = insn.rs2();
+        if (funct6 == 0x20 || funct6 == 0x22 || funct6 == 0x26) {
+          latency = config.mul;
+        } else if (funct6 == 0x28 || funct6 == 0x2a || funct6 == 0x2e) {
+          latency = config.mul;
+          src[nsrc++] = insn.rd();
+        } else if (funct6 == 0x2c || funct6 == 0x32 || funct6 == 0x36 ||
+                   funct6 == 0x38) {
+          // pv.insert, pv.shuffle2, pv.packhi and pv.packlo keep parts of rd
+          src[nsrc++] = insn.rd();
+        }
+        break;
+      }
+      case 0x07: // fp loads
+        rd = FREG + insn.rd();
+        src[nsrc++] = insn.rs1();
+        mem = true;
+        break;
+      case 0x27: // fp stores
+        src[nsrc++] = insn.rs1();
+        src[nsrc++] = FREG + insn.rs2();
+        mem = store = true;
+        break;
+      case 0x43: // fused multiply-add
+      case 0x47:
+      case 0x4b:
+      case 0x4f:
+        rd = FREG + insn.rd();
+        src[nsrc++] = FREG + insn.rs1();
+        src[nsrc++] = FREG + insn.rs2();
+        src[nsrc++] = FREG + insn.rs3();
+        latency = config.fpu;
+        break;
+      case 0x53: // fp operations, a few of them move from or to x registers
+        // For fsqrt, fcvt, fmv and fclass, rs2 selects the format or the
+        // operation and is not a source
+        switch (bits >> 27) {
+          case 0x03: // fdiv
+            src[nsrc++] = FREG + insn.rs2();
+            // fallthrough
+          case 0x0b: // fsqrt
+            rd = FREG + insn.rd();
+            src[nsrc++] = FREG + insn.rs1();
+            latency = config.fdiv;
+            unit = &fdiv_free;
+            break;
+          case 0x04: // fsgnj
+          case 0x05: // fmin, fmax
+            src[nsrc++] = FREG + insn.rs2();
+            // fallthrough
+          case 0x08: // fcvt between fp formats
+            rd = FREG + insn.rd();
+            src[nsrc++] = FREG + insn.rs1();
+            latency = config.fconv;
+            break;
+          case 0x14: // fcmp
+            src[nsrc++] = FREG + insn.rs2();
+            // fallthrough
+          case 0x18: // fcvt to integer
+          case 0x1c: // fmv to x, fclass
+            rd = insn.rd();
+            src[nsrc++] = FREG + insn.rs1();
+            latency = config.fconv;
+            break;
+          case 0x1a: // fcvt from integer
+          case 0x1e: // fmv from x
+            rd = FREG + insn.rd();
+            src[nsrc++] = insn.rs1();
+            latency = config.fconv;
+            break;
+          default: // fadd, fsub, fmul
+            rd = FREG + insn.rd();
+            src[nsrc++] = FREG + insn.rs1();
+            src[nsrc++] = FREG + insn.rs2();
+            latency = config.fpu;
+            break;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Issue once the operands are ready and the functional unit is free
+  uint64_t issue = cycle;
+  for (size_t i = 0; i < nsrc; i++)
+    issue = std::max(issue, ready[src[i]]);
+  raw_stalls += issue - cycle;
+  if (unit) {
+    if (*unit > issue) {
+      unit_stalls += *unit - issue;
+      issue = *unit;
+    }
+    // The dividers are not pipelined
+    *unit = issue + latency;
+  }
+
+  // MMIO accesses are not traced, they are charged the L2 latency
+  if (mem) {
+    reg_t mem_lat = access_valid ? mem_latency(access_addr, issue) : config.l2;
+    if (!store)
+      latency = 1 + mem_lat;
+  }
+
+  if (rd != 0)
+    ready[rd] = issue + latency;
+  if (writes_rs1 && insn.rs1() != 0)
+    ready[insn.rs1()] = issue + config.alu;
+
+  cycle = issue + 1;
+  if (!invalid_pc(npc) && npc != pc + insn.length()) {
+    cycle += config.branch;
+    branch_cycles += config.branch;
+  }
+
+  instret++;
+  access_valid = false;
+}
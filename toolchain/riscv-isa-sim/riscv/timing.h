@@ -0,0 +1,139 @@
+// See LICENSE for license details.
+
+#ifndef _RISCV_TIMING_H
+#define _RISCV_TIMING_H
+
+#include "memtracer.h"
+#include "decode.h"
+#include <cstdint>
+#include <vector>
+
+// Parameters of the cycle-approximate timing model of the Snitch cores of a
+// MemPool cluster. The defaults match config/mempool.mk and config/config.mk;
+// each one can be overridden with a "key=value,..." string, e.g.
+// --timing=remote_group=9.
+struct timing_config_t
+{
+  timing_config_t(const char* config);
+
+  // L1 scratchpad memory map
+  reg_t l1_base = 0;
+  reg_t num_cores = 256;
+  reg_t num_groups = 4;
+  reg_t cores_per_tile = 4;
+  reg_t banking_factor = 4;
+  reg_t l1_bank_size = 1024;
+  reg_t seq_mem_size = 512;
+
+  // Load latencies, from the issue of the load to the response
+  reg_t tile = 1;
+  reg_t group = 3;
+  // remote_group_latency_cycles, RemoteGroupLatencyCycle of mempool_pkg.sv
+  reg_t remote_group = 7;
+  reg_t l2 = 12;
+
+  // Result latencies of the functional units, in cycles
+  reg_t alu = 1;
+  reg_t mul = 2;
+  reg_t div = 32;
+  reg_t fpu = 3;
+  reg_t fconv = 2;
+  reg_t fdiv = 16;
+  // Penalty of taken branches and jumps
+  reg_t branch = 1;
+
+  reg_t num_banks() const { return num_cores * banking_factor; }
+  reg_t l1_size() const { return num_banks() * l1_bank_size; }
+  // L1 bank of addr, or num_banks() outside of the L1
+  reg_t bank(reg_t addr) const;
+  reg_t bank_tile(reg_t bank) const
+  {
+    return bank / (cores_per_tile * banking_factor);
+  }
+};
+
+// Arbitration of the L1 banks shared by all the harts. Each bank serves one
+// access per cycle. The grants of the last WINDOW cycles are kept, so harts
+// simulated one after the other in the same quantum see each other.
+class bank_arbiter_t
+{
+ public:
+  bank_arbiter_t(size_t num_banks);
+  // Return the first cycle from t on in which the bank is free, and take it
+  uint64_t grant(size_t bank, uint64_t t);
+
+ private:
+  static const size_t WINDOW = 64;
+  std::vector<uint64_t> granted;
+
+  friend class sim_t; // for the snapshots
+};
+
+// Timing model of one hart. The memory tracer records the address of the
+// access of the current instruction, and retire() charges the instruction
+// with an in-order scoreboard: it issues once its operands are ready and the
+// functional unit is free, and its result is ready after the unit latency.
+class timing_model_t : public memtracer_t
+{
+ public:
+  timing_model_t(const timing_config_t& config, bank_arbiter_t* arbiter,
+                 reg_t hartid);
+  ~timing_model_t();
+
+  bool interested_in_range(uint64_t begin, uint64_t end, access_type type)
+  {
+    return type == LOAD || type == STORE;
+  }
+  void trace(uint64_t addr, size_t bytes, access_type type)
+  {
+    access_addr = addr;
+    access_valid = true;
+  }
+
+  void retire(insn_t insn, reg_t pc, reg_t npc);
+  uint64_t get_cycle() const { return cycle; }
+  // The mcycle CSR, writes do not move the hart in time
+  reg_t get_mcycle() const { return cycle + mcycle_offset; }
+  void set_mcycle(reg_t val) { mcycle_offset = val - cycle; }
+  // Idle until cycle t, e.g., when the hart made no progress in a quantum
+  void stall_until(uint64_t t)
+  {
+    if (cycle < t) {
+      idle_cycles += t - cycle;
+      cycle = t;
+    }
+  }
+  void print_stats();
+
+ private:
+  // Scoreboard entries of the integer and of the floating-point registers
+  static const size_t NUM_REGS = 64;
+  static const size_t FREG = 32;
+
+  reg_t mem_latency(reg_t addr, uint64_t issue);
+
+  const timing_config_t config;
+  bank_arbiter_t* arbiter;
+  reg_t hartid;
+  reg_t tile;
+  reg_t group;
+
+  uint64_t cycle;
+  reg_t mcycle_offset;
+  uint64_t ready[NUM_REGS];
+  uint64_t div_free;
+  uint64_t fdiv_free;
+  reg_t access_addr;
+  bool access_valid;
+
+  uint64_t instret;
+  uint64_t raw_stalls;
+  uint64_t unit_stalls;
+  uint64_t bank_conflicts;
+  uint64_t branch_cycles;
+  uint64_t idle_cycles;
+
+  friend class sim_t; // for the snapshots
+};
+
+#endif
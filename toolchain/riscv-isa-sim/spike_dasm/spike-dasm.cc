@@ -8,15 +8,17 @@
 
 #include "disasm.h"
 #include "extension.h"
-#include <iostream>
-#include <string>
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
 #include <fesvr/option_parser.h>
 using namespace std;
 
 int main(int argc, char** argv)
 {
-  string s;
   const char* isa = DEFAULT_ISA;
 
   std::function<extension_t*()> extension;
@@ -48,35 +50,73 @@ int main(int argc, char** argv)
     }
   }
 
-  while (getline(cin, s))
-  {
-    for (size_t pos = 0; (pos = s.find("DASM(", pos)) != string::npos; )
-    {
-      size_t start = pos;
-
-      pos += strlen("DASM(");
-
-      if (s[pos] == '0' && (s[pos+1] == 'x' || s[pos+1] == 'X'))
-        pos += 2;
-
-      if (!isxdigit(s[pos]))
-        continue;
-
-      char* endp;
-      int64_t bits = strtoull(&s[pos], &endp, 16);
-      if (*endp != ')')
-        continue;
-
-      size_t nbits = 4 * (endp - &s[pos]);
-      if (nbits < 64)
-        bits = bits << (64 - nbits) >> (64 - nbits);
+  // The input is read in large blocks, and the output built in a buffer
+  // that is written out once it is as large, so that each line is only
+  // copied to the output, with its DASM(...) replaced in place
+  const size_t BLOCK_SIZE = 1 << 20;
+  std::vector<char> in(BLOCK_SIZE + 1);
+  std::string out;
+  out.reserve(2 * BLOCK_SIZE);
+  size_t len = 0;
+  while (true) {
+    if (len == in.size() - 1)
+      in.resize(2 * in.size() - 1); // a line longer than the buffer
+    size_t n = fread(&in[len], 1, in.size() - 1 - len, stdin);
+    bool eof = n == 0;
+    len += n;
+    in[len] = '\0'; // stops strtoull at the end of the data
+
+    // The complete lines of the buffer, and the last one at the end of input
+    const char* data = &in[0];
+    const char* end = (const char*)memrchr(data, '\n', len);
+    end = eof ? data + len : end ? end + 1 : data;
+
+    for (const char* line = data; line < end; ) {
+      const char* eol = (const char*)memchr(line, '\n', end - line);
+      if (!eol)
+        eol = end;
+
+      const char* copied = line;
+      for (const char* pos = line;
+           (pos = (const char*)memmem(pos, eol - pos, "DASM(", 5)); ) {
+        const char* start = pos;
+
+        pos += strlen("DASM(");
+
+        if (pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X'))
+          pos += 2;
+
+        if (!isxdigit(*pos))
+          continue;
+
+        char* endp;
+        int64_t bits = strtoull(pos, &endp, 16);
+        if (*endp != ')')
+          continue;
+
+        size_t nbits = 4 * (endp - pos);
+        if (nbits < 64)
+          bits = bits << (64 - nbits) >> (64 - nbits);
+
+        out.append(copied, start - copied);
+        disassembler->disassemble(bits, out);
+        copied = pos = endp + 1;
+      }
+      out.append(copied, eol - copied);
+      out += '\n';
+      line = eol + 1;
+    }
 
-      string dis = disassembler->disassemble(bits);
-      s = s.substr(0, start) + dis + s.substr(endp - &s[0] + 1);
-      pos = start + dis.length();
+    if (out.size() >= BLOCK_SIZE || eof) {
+      fwrite(out.data(), 1, out.size(), stdout);
+      out.clear();
     }
+    if (eof)
+      break;
 
-    cout << s << '\n';
+    // Keep the incomplete last line for the next block
+    len -= end - data;
+    memmove(&in[0], end, len);
   }
 
   return 0;
@@ -0,0 +1,362 @@
+// See LICENSE for license details.
+
+// This program counts the instructions of a trace of
+//   spike -l    or    spike --log-commits
+// by class, per hart and in total, and prints the counts as CSV. A load or
+// store is local if its address, from the commit log, is in an L1 bank of the
+// tile of the hart, with the memory map of --timing; the others, and those of
+// a trace without addresses, are remote. If a trace has both kinds of lines,
+// the commit log lines are counted.
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "fesvr/option_parser.h"
+
+#include "disasm.h"
+#include "extension.h"
+#include "timing.h"
+
+enum insn_class_t {
+  ALU,
+  LOAD_LOCAL,
+  LOAD_REMOTE,
+  STORE_LOCAL,
+  STORE_REMOTE,
+  SIMD,
+  FP,
+  BRANCH,
+  WFI,
+  OTHER,
+  NUM_CLASSES
+};
+
+static const char* class_names[NUM_CLASSES] = {
+  "alu", "load_local", "load_remote", "store_local", "store_remote",
+  "simd", "fp", "branch", "wfi", "other"
+};
+
+typedef std::array<uint64_t, NUM_CLASSES> insn_counts_t;
+
+static bool starts_with(const std::string& s, const char* prefix)
+{
+  return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Class of an instruction by its mnemonic, all loads and stores remote
+static insn_class_t classify(const disasm_insn_t* insn)
+{
+  if (!insn)
+    return OTHER;
+
+  std::string name = insn->get_name();
+  std::replace(name.begin(), name.end(), '_', '.');
+
+  static const char* loads[] = {
+    "lb", "lbu", "lh", "lhu", "lw", "lwu", "ld", "flh", "flw", "fld", "flq",
+    "c.lw", "c.lwsp", "c.ld", "c.ldsp", "c.flw", "c.flwsp", "c.fld",
+    "c.fldsp", "lr.w", "lr.d"
+  };
+  static const char* stores[] = {
+    "sb", "sh", "sw", "sd", "fsh", "fsw", "fsd", "fsq", "c.sw", "c.swsp",
+    "c.sd", "c.sdsp", "c.fsw", "c.fswsp", "c.fsd", "c.fsdsp", "sc.w", "sc.d"
+  };
+  // Branches and jumps, with the pseudo-instructions of the disassembler
+  static const char* branches[] = {
+    "beq", "bne", "blt", "bge", "bltu", "bgeu", "beqz", "bnez", "bltz",
+    "bgez", "j", "jal", "jr", "jalr", "ret", "c.beqz", "c.bnez", "c.j",
+    "c.jal", "c.jr", "c.jalr", "p.beqimm", "p.bneimm"
+  };
+  for (const char* load : loads)
+    if (name == load)
+      return LOAD_REMOTE;
+  for (const char* store : stores)
+    if (name == store)
+      return STORE_REMOTE;
+  if (starts_with(name, "p.lb") || starts_with(name, "p.lh") ||
+      starts_with(name, "p.lw"))
+    return LOAD_REMOTE;
+  if (starts_with(name, "p.sb.") || starts_with(name, "p.sh.") ||
+      starts_with(name, "p.sw.") || starts_with(name, "amo"))
+    return STORE_REMOTE;
+
+  if (name == "wfi")
+    return WFI;
+  if (starts_with(name, "pv."))
+    return SIMD;
+  for (const char* branch : branches)
+    if (name == branch)
+      return BRANCH;
+  if (starts_with(name, "fence"))
+    return OTHER;
+  if (name[0] == 'f')
+    return FP;
+  if (starts_with(name, "csr") || name == "ecall" || name == "ebreak" ||
+      name == "mret" || name == "sret" || name == "uret" || name == "dret" ||
+      starts_with(name, "sfence") || starts_with(name, "hfence"))
+    return OTHER;
+  return ALU;
+}
+
+// Classes of the instruction words seen by one thread, direct mapped, so
+// that each word is looked up in the disassembler about once
+class class_memo_t
+{
+ public:
+  class_memo_t(const disassembler_t* disasm)
+    : disasm(disasm), bits(SIZE), classes(SIZE, NUM_CLASSES) {}
+
+  insn_class_t get(uint64_t insn)
+  {
+    size_t idx = (insn * 0x9e3779b97f4a7c15ULL) >> (64 - SIZE_BITS);
+    if (classes[idx] == NUM_CLASSES || bits[idx] != insn) {
+      bits[idx] = insn;
+      classes[idx] = classify(disasm->lookup(insn));
+    }
+    return insn_class_t(classes[idx]);
+  }
+
+ private:
+  static const size_t SIZE_BITS = 16;
+  static const size_t SIZE = size_t(1) << SIZE_BITS;
+
+  const disassembler_t* disasm;
+  std::vector<uint64_t> bits;
+  std::vector<uint8_t> classes;
+};
+
+static const char* skip_spaces(const char* p, const char* end)
+{
+  while (p < end && *p == ' ')
+    p++;
+  return p;
+}
+
+// Parse the hexadecimal number at p, after its "0x"
+static const char* parse_hex(const char* p, const char* end, uint64_t* val)
+{
+  if (end - p < 3 || p[0] != '0' || p[1] != 'x')
+    return NULL;
+  p += 2;
+  const char* begin = p;
+  uint64_t v = 0;
+  for (; p < end; p++) {
+    char c = *p;
+    if (c >= '0' && c <= '9')
+      v = v << 4 | (c - '0');
+    else if (c >= 'a' && c <= 'f')
+      v = v << 4 | (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      v = v << 4 | (c - 'A' + 10);
+    else
+      break;
+  }
+  *val = v;
+  return p == begin ? NULL : p;
+}
+
+// Counts of the harts in the lines of spike -l (0) and --log-commits (1)
+struct mix_t
+{
+  std::vector<insn_counts_t> harts[2];
+
+  void count(bool commit, size_t hart, insn_class_t cls)
+  {
+    std::vector<insn_counts_t>& h = harts[commit];
+    if (hart >= h.size())
+      h.resize(hart + 1, insn_counts_t());
+    h[hart][cls]++;
+  }
+
+  void add(const mix_t& other)
+  {
+    for (int commit = 0; commit < 2; commit++) {
+      std::vector<insn_counts_t>& h = harts[commit];
+      const std::vector<insn_counts_t>& o = other.harts[commit];
+      if (o.size() > h.size())
+        h.resize(o.size(), insn_counts_t());
+      for (size_t hart = 0; hart < o.size(); hart++)
+        for (int cls = 0; cls < NUM_CLASSES; cls++)
+          h[hart][cls] += o[hart][cls];
+    }
+  }
+};
+
+// Count the lines of the trace that start in [begin, end)
+static void scan(const char* begin, const char* end, const char* trace_end,
+                 const disassembler_t* disasm, const timing_config_t* config,
+                 mix_t* mix)
+{
+  class_memo_t memo(disasm);
+  const char* line = begin;
+  while (line < end) {
+    const char* eol = (const char*)memchr(line, '\n', trace_end - line);
+    if (!eol)
+      eol = trace_end;
+    const char* p = line;
+    line = eol + 1;
+
+    //   core   0: 0x0000000080000000 (0x00000297) auipc   t0, 0x0
+    //   core   0: 3 0x0000000080000000 (0x00000297) x5  0x80000000
+    if (eol - p < 4 || memcmp(p, "core", 4) != 0)
+      continue;
+    p = skip_spaces(p + 4, eol);
+    size_t hart = 0;
+    const char* digits = p;
+    for (; p < eol && *p >= '0' && *p <= '9'; p++)
+      hart = hart * 10 + (*p - '0');
+    if (p == digits || p == eol || *p != ':')
+      continue;
+    p = skip_spaces(p + 1, eol);
+
+    // The privilege level of a commit log line
+    bool commit = eol - p > 2 && *p >= '0' && *p <= '9' && p[1] == ' ';
+    if (commit)
+      p += 2;
+
+    uint64_t pc, insn;
+    if (!(p = parse_hex(p, eol, &pc)))
+      continue;
+    p = skip_spaces(p, eol);
+    if (eol - p < 2 || *p++ != '(')
+      continue;
+    if (!(p = parse_hex(p, eol, &insn)) || p == eol || *p != ')')
+      continue;
+
+    insn_class_t cls = memo.get(insn);
+    if (commit && (cls == LOAD_REMOTE || cls == STORE_REMOTE)) {
+      const char* mem = (const char*)memmem(p, eol - p, " mem ", 5);
+      uint64_t addr;
+      if (mem && parse_hex(mem + 5, eol, &addr)) {
+        reg_t bank = config->bank(addr);
+        if (bank < config->num_banks() &&
+            config->bank_tile(bank) == hart / config->cores_per_tile)
+          cls = insn_class_t(cls - 1);
+      }
+    }
+    mix->count(commit, hart, cls);
+  }
+}
+
+static void help()
+{
+  fprintf(stderr, "usage: spike-insn-mix [--isa=<name>] [--extension=<name>]\n"
+                  "                      [--timing=<k=v,...>] [--threads=<n>] [trace]\n");
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  const char* isa = DEFAULT_ISA;
+  const char* timing = "default";
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::function<extension_t*()> extension;
+  option_parser_t parser;
+  parser.option(0, "extension", 1, [&](const char* s){extension = find_extension(s);});
+  parser.option(0, "isa", 1, [&](const char* s){isa = s;});
+  parser.option(0, "timing", 1, [&](const char* s){timing = s;});
+  parser.option(0, "threads", 1, [&](const char* s){threads = std::max(1, atoi(s));});
+  parser.help(&help);
+  const char* const* args = parser.parse(argv);
+  const char* path = args[0] && strcmp(args[0], "-") ? args[0] : NULL;
+
+  processor_t p(isa, DEFAULT_PRIV, DEFAULT_VARCH, 0, 0, false, nullptr);
+  if (extension) {
+    p.register_extension(extension());
+  }
+  timing_config_t config(timing);
+
+  // Map the trace, or read it from stdin
+  std::string input;
+  const char* trace;
+  size_t size;
+  if (path) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+      perror(path);
+      return 1;
+    }
+    size = st.st_size;
+    trace = size ? (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                 : "";
+    if (trace == MAP_FAILED) {
+      perror(path);
+      return 1;
+    }
+    close(fd);
+    madvise((void*)trace, size, MADV_SEQUENTIAL);
+  } else {
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), stdin)) > 0)
+      input.append(buf, n);
+    trace = input.data();
+    size = input.size();
+  }
+
+  // Each thread counts the lines that start in its share of the trace, of
+  // at least 1 MiB
+  auto line_start = [&](size_t offset) {
+    if (offset == 0)
+      return trace;
+    const char* nl = (const char*)memchr(trace + offset - 1, '\n',
+                                         size - offset + 1);
+    return nl ? nl + 1 : trace + size;
+  };
+  threads = std::min(threads, std::max<size_t>(1, size >> 20));
+  std::vector<mix_t> mixes(threads);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < threads; i++) {
+    workers.emplace_back(scan, line_start(size * i / threads),
+                         line_start(size * (i + 1) / threads),
+                         trace + size, p.get_disassembler(), &config,
+                         &mixes[i]);
+  }
+  for (auto& worker : workers)
+    worker.join();
+
+  mix_t mix;
+  for (auto& m : mixes)
+    mix.add(m);
+  const std::vector<insn_counts_t>& harts =
+    mix.harts[1].empty() ? mix.harts[0] : mix.harts[1];
+
+  printf("hart");
+  for (const char* name : class_names)
+    printf(",%s", name);
+  printf(",total\n");
+
+  insn_counts_t total = insn_counts_t();
+  auto print = [&](const std::string& name, const insn_counts_t& counts) {
+    uint64_t sum = 0;
+    printf("%s", name.c_str());
+    for (uint64_t count : counts) {
+      printf(",%" PRIu64, count);
+      sum += count;
+    }
+    printf(",%" PRIu64 "\n", sum);
+  };
+  for (size_t hart = 0; hart < harts.size(); hart++) {
+    uint64_t sum = 0;
+    for (int cls = 0; cls < NUM_CLASSES; cls++) {
+      total[cls] += harts[hart][cls];
+      sum += harts[hart][cls];
+    }
+    if (sum)
+      print(std::to_string(hart), harts[hart]);
+  }
+  print("total", total);
+
+  return 0;
+}
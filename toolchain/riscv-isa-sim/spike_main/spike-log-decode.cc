@@ -0,0 +1,30 @@
+// See LICENSE for license details.
+
+// This little program prints a binary commit log, written by
+//   spike --log-commits-bin=<path>
+// in the text format of spike --log-commits.
+
+#include <cstdio>
+#include "commit_log.h"
+
+int main(int argc, char** argv)
+{
+  if (argc > 2) {
+    fprintf(stderr, "usage: %s [binary commit log]\n", argv[0]);
+    return 1;
+  }
+
+  FILE* in = argc == 2 ? fopen(argv[1], "rb") : stdin;
+  if (!in) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  if (!commit_log_decode(in, stdout)) {
+    fprintf(stderr, "%s: not a binary commit log, or truncated\n",
+            argc == 2 ? argv[1] : "stdin");
+    return 1;
+  }
+
+  return 0;
+}
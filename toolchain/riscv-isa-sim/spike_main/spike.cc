@@ -4,11 +4,15 @@
 #include "mmu.h"
 #include "remote_bitbang.h"
 #include "cachesim.h"
+#include "timing.h"
+#include "commit_log.h"
 #include "extension.h"
 #include <dlfcn.h>
 #include <fesvr/option_parser.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <vector>
 #include <string>
 #include <memory>
@@ -25,8 +29,13 @@ static void help(int exit_code = 1)
   fprintf(stderr, "  -m<a:m,b:n,...>       Provide memory regions of size m and n bytes\n");
   fprintf(stderr, "                          at base addresses a and b (with 4 KiB alignment)\n");
   fprintf(stderr, "  -d                    Interactive debug mode\n");
-  fprintf(stderr, "  -g                    Track histogram of PCs\n");
+  fprintf(stderr, "  -g                    Track histogram of PCs, print the instructions\n");
+  fprintf(stderr, "                          of each function at exit\n");
   fprintf(stderr, "  -l                    Generate a log of execution\n");
+  fprintf(stderr, "  --log-commits-bin=<path>\n");
+  fprintf(stderr, "                        Log the commits in binary to <path>, written by\n");
+  fprintf(stderr, "                          a thread; spike-log-decode prints them as text.\n");
+  fprintf(stderr, "                          Not with --batch\n");
   fprintf(stderr, "  -h, --help            Print this help message\n");
   fprintf(stderr, "  -H                    Start halted, allowing a debugger to connect\n");
   fprintf(stderr, "  --isa=<name>          RISC-V ISA string [default %s]\n", DEFAULT_ISA);
@@ -44,6 +53,27 @@ static void help(int exit_code = 1)
   fprintf(stderr, "                          This flag can be used multiple times.\n");
   fprintf(stderr, "                          The extlib flag for the library must come first.\n");
   fprintf(stderr, "  --log-cache-miss      Generate a log of cache miss\n");
+  fprintf(stderr, "  --mempool-cache=<k=v,...>\n");
+  fprintf(stderr, "                        Model MemPool's instruction caches shared per tile\n");
+  fprintf(stderr, "                          and read-only caches in front of L2 shared per\n");
+  fprintf(stderr, "                          group, with the geometry k=v, or \"default\"\n");
+  fprintf(stderr, "                          [see --mempool-cache=help]\n");
+  fprintf(stderr, "  --histogram-folded=<path>\n");
+  fprintf(stderr, "                        Write the histogram of PCs as folded stacks\n");
+  fprintf(stderr, "                          hart;function, for flame graphs [implies -g]\n");
+  fprintf(stderr, "  --timing=<k=v,...>    Estimate mcycle with a timing model of MemPool's\n");
+  fprintf(stderr, "                          Snitch cores, with the latencies and memory map\n");
+  fprintf(stderr, "                          k=v, or \"default\" [see --timing=help]\n");
+  fprintf(stderr, "  --snapshot=<path>     Save the simulation to <path> at the first non-zero\n");
+  fprintf(stderr, "                          write to the snapshot CSR\n");
+  fprintf(stderr, "  --snapshot-csr=<csr>  Name or number of the snapshot CSR [default trace]\n");
+  fprintf(stderr, "  --restore=<path>      Start from the snapshot at <path>, taken with the\n");
+  fprintf(stderr, "                          same program, harts and memories\n");
+  fprintf(stderr, "  --batch=<list>        Run the programs of <list>, one per line with its\n");
+  fprintf(stderr, "                          arguments, each in a fork of the simulator\n");
+  fprintf(stderr, "  --batch-csv=<path>    Write the exit code, instructions and wall time of\n");
+  fprintf(stderr, "                          each program to <path> [default stdout]\n");
+  fprintf(stderr, "  --batch-jobs=<n>      Run <n> programs in parallel [default host cores]\n");
   fprintf(stderr, "  --extension=<name>    Specify RoCC Extension\n");
   fprintf(stderr, "  --extlib=<name>       Shared library to load\n");
   fprintf(stderr, "                        This flag can be used multiple times.\n");
@@ -70,6 +100,21 @@ static void help(int exit_code = 1)
   exit(exit_code);
 }
 
+static int parse_csr(const char* s)
+{
+  #define DECLARE_CSR(name, num) if (strcmp(s, #name) == 0) return num;
+  #include "encoding.h"
+  #undef DECLARE_CSR
+
+  char* end;
+  long csr = strtol(s, &end, 0);
+  if (*s == 0 || *end != 0 || csr < 0 || csr >= 4096) {
+    fprintf(stderr, "unknown CSR %s\n", s);
+    exit(1);
+  }
+  return csr;
+}
+
 static void suggest_help()
 {
   fprintf(stderr, "Try 'spike --help' for more information.\n");
@@ -203,8 +248,21 @@ int main(int argc, char** argv)
   std::unique_ptr<icache_sim_t> ic;
   std::unique_ptr<dcache_sim_t> dc;
   std::unique_ptr<cache_sim_t> l2;
+  std::unique_ptr<mempool_cache_sim_t> mempool_cache;
+  std::unique_ptr<timing_config_t> timing_config;
+  std::unique_ptr<bank_arbiter_t> bank_arbiter;
+  std::vector<std::unique_ptr<timing_model_t>> timing;
+  const char* snapshot = NULL;
+  int snapshot_csr = CSR_TRACE;
+  const char* restore = NULL;
+  const char* histogram_folded = NULL;
+  const char* batch = NULL;
+  const char* batch_csv = "-";
+  size_t batch_jobs = sysconf(_SC_NPROCESSORS_ONLN);
   bool log_cache = false;
   bool log_commits = false;
+  const char* log_commits_bin = NULL;
+  std::unique_ptr<commit_log_writer_t> commit_log;
   const char *log_path = nullptr;
   std::function<extension_t*()> extension;
   const char* initrd = NULL;
@@ -299,6 +357,15 @@ int main(int argc, char** argv)
   parser.option(0, "dc", 1, [&](const char* s){dc.reset(new dcache_sim_t(s));});
   parser.option(0, "l2", 1, [&](const char* s){l2.reset(cache_sim_t::construct(s, "L2$"));});
   parser.option(0, "log-cache-miss", 0, [&](const char* s){log_cache = true;});
+  parser.option(0, "mempool-cache", 1, [&](const char* s){mempool_cache.reset(new mempool_cache_sim_t(mempool_cache_config_t(s)));});
+  parser.option(0, "histogram-folded", 1, [&](const char* s){histogram = true; histogram_folded = s;});
+  parser.option(0, "timing", 1, [&](const char* s){timing_config.reset(new timing_config_t(s));});
+  parser.option(0, "snapshot", 1, [&](const char* s){snapshot = s;});
+  parser.option(0, "snapshot-csr", 1, [&](const char* s){snapshot_csr = parse_csr(s);});
+  parser.option(0, "restore", 1, [&](const char* s){restore = s;});
+  parser.option(0, "batch", 1, [&](const char* s){batch = s;});
+  parser.option(0, "batch-csv", 1, [&](const char* s){batch_csv = s;});
+  parser.option(0, "batch-jobs", 1, [&](const char* s){batch_jobs = std::max(atoi(s), 1);});
   parser.option(0, "isa", 1, [&](const char* s){isa = s;});
   parser.option(0, "priv", 1, [&](const char* s){priv = s;});
   parser.option(0, "varch", 1, [&](const char* s){varch = s;});
@@ -338,6 +405,8 @@ int main(int argc, char** argv)
       [&](const char* s){dm_config.support_haltgroups = false;});
   parser.option(0, "log-commits", 0,
                 [&](const char* s){log_commits = true;});
+  parser.option(0, "log-commits-bin", 1,
+                [&](const char* s){log_commits_bin = s;});
   parser.option(0, "log", 1,
                 [&](const char* s){log_path = s;});
 
@@ -346,8 +415,16 @@ int main(int argc, char** argv)
   if (mems.empty())
     mems = make_mems("2048");
 
-  if (!*argv1)
+  // The programs of a batch come from its list
+  if (batch && !*argv1)
+    htif_args.push_back("none");
+  else if (!*argv1 || batch)
     help();
+  // The forks of a batch would write their records to the same file
+  if (batch && log_commits_bin) {
+    fprintf(stderr, "--log-commits-bin cannot be used with --batch\n");
+    suggest_help();
+  }
 
   if (kernel && check_file_exists(kernel)) {
     kernel_size = get_file_size(kernel);
@@ -391,6 +468,8 @@ int main(int argc, char** argv)
     return 0;
   }
 
+  if (timing_config)
+    bank_arbiter.reset(new bank_arbiter_t(timing_config->num_banks()));
   if (ic && l2) ic->set_miss_handler(&*l2);
   if (dc && l2) dc->set_miss_handler(&*l2);
   if (ic) ic->set_log(log_cache);
@@ -399,14 +478,39 @@ int main(int argc, char** argv)
   {
     if (ic) s.get_core(i)->get_mmu()->register_memtracer(&*ic);
     if (dc) s.get_core(i)->get_mmu()->register_memtracer(&*dc);
+    if (mempool_cache) {
+      processor_t* core = s.get_core(i);
+      core->get_mmu()->register_memtracer(
+          mempool_cache->tracer(core->get_csr(CSR_MHARTID)));
+    }
+    if (timing_config) {
+      processor_t* core = s.get_core(i);
+      timing.emplace_back(new timing_model_t(*timing_config, &*bank_arbiter,
+                                             core->get_csr(CSR_MHARTID)));
+      core->get_mmu()->register_memtracer(&*timing.back());
+      core->set_timing(&*timing.back());
+    }
     if (extension) s.get_core(i)->register_extension(extension());
   }
 
   s.set_debug(debug);
-  s.configure_log(log, log_commits);
+  if (log_commits_bin) {
+    commit_log.reset(new commit_log_writer_t(log_commits_bin));
+    for (size_t i = 0; i < nprocs; i++) {
+      processor_t* core = s.get_core(i);
+      core->set_commit_log(commit_log->add_hart(core->get_csr(CSR_MHARTID)));
+    }
+  }
+  s.configure_log(log, log_commits || log_commits_bin);
   s.set_histogram(histogram);
-
-  auto return_code = s.run();
+  if (histogram_folded)
+    s.set_histogram_folded(histogram_folded);
+  if (snapshot)
+    s.set_snapshot(snapshot, snapshot_csr);
+  if (restore)
+    s.set_restore(restore);
+
+  auto return_code = batch ? s.run_batch(batch, batch_csv, batch_jobs) : s.run();
 
   for (auto& mem : mems)
     delete mem.second;
@@ -0,0 +1,21 @@
+#!/usr/bin/python
+
+import subprocess
+import testlib
+import unittest
+
+class FlatTest(unittest.TestCase):
+    def setUp(self):
+        self.binary = testlib.compile("flat.s", "-nostdlib", "-nostartfiles",
+                                      "-Wl,-Ttext=0x80000000")
+
+    def test_region_edges(self):
+        """Make sure that the direct loads and stores of M-mode stay inside
+        their memory region."""
+        result = subprocess.call(["timeout", "10", testlib.find_file("spike"),
+                                  "-m0x80000000:0x10000,0x80020000:0x10000",
+                                  self.binary])
+        self.assertEqual(result, 0)
+
+if __name__ == '__main__':
+    unittest.main()
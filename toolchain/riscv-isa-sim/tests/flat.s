@@ -0,0 +1,111 @@
+        # Bare M-mode loads and stores at the edges of two memory regions,
+        #   -m0x80000000:0x10000,0x80020000:0x10000
+        # The words inside must read back, those outside must fault, also
+        # once both regions are accessed directly by the MMU. The mret of
+        # each trap drops the regions of the direct path with the TLB, so
+        # both are accessed again before each access that must fault.
+        # Writes 1 to tohost if it passes, or the number of the failed
+        # check shifted left by one, plus one.
+
+        .option norvc
+        .text
+        .global _start
+_start:
+        la      t0, trap
+        csrw    mtvec, t0
+        li      s2, 1
+
+        # Last word and doubleword of each region
+        li      s0, 0x8000fff8
+        li      s3, 0x8002fff8
+        li      t1, 0x0123456789abcdef
+        sd      t1, 0(s0)
+        sd      t1, 0(s3)
+        ld      t2, 0(s0)
+        bne     t1, t2, fail
+        addi    s2, s2, 1
+        ld      t2, 0(s3)
+        bne     t1, t2, fail
+        addi    s2, s2, 1
+        li      t1, 0x5a5a5a5a
+        sw      t1, 4(s0)
+        sw      t1, 4(s3)
+        lw      t2, 4(s0)
+        bne     t1, t2, fail
+        addi    s2, s2, 1
+        lw      t2, 4(s3)
+        bne     t1, t2, fail
+
+        # Word and doubleword just below the base of each region, and just
+        # past the end of the second one
+        li      s0, 0x7ffffff8
+        jal     ra, check_fault
+        li      s0, 0x8001fff8
+        jal     ra, check_fault
+        li      s0, 0x80030000
+        jal     ra, check_fault
+
+        li      t0, 1
+        j       done
+
+        # Loads and stores of the word at s0 + 4 and of the doubleword at s0
+        # must fault
+check_fault:
+        li      t0, 5
+        addi    s2, s2, 1
+        li      s1, 0
+        jal     t4, fill
+        lw      t2, 4(s0)
+        bne     s1, t0, fail
+        addi    s2, s2, 1
+        li      s1, 0
+        jal     t4, fill
+        ld      t2, 0(s0)
+        bne     s1, t0, fail
+        li      t0, 7
+        addi    s2, s2, 1
+        li      s1, 0
+        jal     t4, fill
+        sw      t2, 4(s0)
+        bne     s1, t0, fail
+        addi    s2, s2, 1
+        li      s1, 0
+        jal     t4, fill
+        sd      t2, 0(s0)
+        bne     s1, t0, fail
+        ret
+
+        # Load and store back the last doubleword of each region, so that
+        # both are in the table of the direct path
+fill:
+        li      t5, 0x8000fff8
+        ld      t6, 0(t5)
+        sd      t6, 0(t5)
+        li      t5, 0x8002fff8
+        ld      t6, 0(t5)
+        sd      t6, 0(t5)
+        jr      t4
+
+fail:
+        slli    t0, s2, 1
+        addi    t0, t0, 1
+done:
+        la      t1, tohost
+        sd      t0, 0(t1)
+1:      j       1b
+
+        # Skip the faulting access
+trap:
+        csrr    s1, mcause
+        csrr    t3, mepc
+        addi    t3, t3, 4
+        csrw    mepc, t3
+        mret
+
+        .data
+        .align  6
+        .global tohost
+tohost: .dword  0
+        .align  6
+        .global fromhost
+fromhost: .dword 0